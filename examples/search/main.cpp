@@ -14,7 +14,12 @@
 /*
  * 迷路ライブラリの読み込み
  */
+#include "MazeLib/ExplorationPlanner.h"
+#include "MazeLib/IncrementalStepMap.h"
 #include "MazeLib/Maze.h"
+#include "MazeLib/MazeRenderer.h"
+#include "MazeLib/MotionPrimitive.h"
+#include "MazeLib/OptimalityCertificate.h"
 #include "MazeLib/StepMap.h"
 
 /*
@@ -44,6 +49,7 @@ void MoveRobot(const Direction relativeDir) {
 
 /**
  * @brief アニメーション状に迷路を表示する関数
+ * @details 前回の表示から変化した行のみを再描画する
  * @param stepMap 表示するステップマップ
  * @param maze 表示する迷路
  * @param pos 迷路上の位置
@@ -52,9 +58,11 @@ void MoveRobot(const Direction relativeDir) {
 void ShowAnimation(const StepMap& stepMap, const Maze& maze,
                    const Position& pos, const Direction& dir,
                    const std::string& msg) {
-  std::cout << "\e[0;0H";  //< カーソルを左上に移動
-  stepMap.print(maze, pos, dir);
-  std::cout << "\e[J";  //< カーソル以下を消去
+  static MazeRenderer renderer;  //< 描画バッファを使い回す
+  renderer.setPath({dir}, pos.next(dir + Direction::Back));
+  renderer.renderStepMap(maze, stepMap);
+  renderer.writeChanged(std::cout);  //< 変化した行のみを出力
+  std::cout << "\e[J";               //< カーソル以下を消去
   std::cout << msg << std::endl;
   std::this_thread::sleep_for(std::chrono::milliseconds(10));
 }
@@ -64,7 +72,12 @@ void ShowAnimation(const StepMap& stepMap, const Maze& maze,
  */
 int SearchRun(Maze& maze, const Maze& mazeTarget) {
   /* 探索テスト */
-  StepMap stepMap;  //< 経路導出に使用するステップマップ
+  StepMap stepMap;                    //< 経路導出に使用するステップマップ
+  ExplorationPlanner planner;         //< 追加探索の目的地の選択に使用
+  OptimalityCertificate certificate;  //< 最短経路の最短性の証明に使用
+  IncrementalStepMap returnMap;       //< スタートへ戻る経路の導出に使用
+  /* 経路導出では、現在区画のステップが確定したら展開を打ち切る */
+  stepMap.setEarlyExitMargin(0);
   /* 現在方向は、現在区画に向かう方向を表す。
    * 現在区画から出る方向ではないことに注意する。
    * +---+---+---+ 例
@@ -90,6 +103,8 @@ int SearchRun(Maze& maze, const Maze& mazeTarget) {
     maze.updateWall(currentPos, currentDir + Direction::Front, wall_front);
     maze.updateWall(currentPos, currentDir + Direction::Left, wall_left);
     maze.updateWall(currentPos, currentDir + Direction::Right, wall_right);
+    /* スタートへのステップマップに新たな壁の差分のみを反映 */
+    returnMap.update(maze);
     /* 現在地のゴール判定 */
     const auto& goals = maze.getGoals();
     if (std::find(goals.cbegin(), goals.cend(), currentPos) != goals.cend())
@@ -130,20 +145,18 @@ int SearchRun(Maze& maze, const Maze& mazeTarget) {
     maze.updateWall(currentPos, currentDir + Direction::Front, wall_front);
     maze.updateWall(currentPos, currentDir + Direction::Left, wall_left);
     maze.updateWall(currentPos, currentDir + Direction::Right, wall_right);
-    /* 最短経路上の未知区画を洗い出し */
-    const auto shortestDirs = stepMap.calcShortestDirections(
-        maze, maze.getStart(), maze.getGoals(), false, false);
-    Positions shortestCandidates;
-    auto pos = maze.getStart();
-    for (const auto nextDir : shortestDirs) {
-      pos = pos.next(nextDir);
-      if (maze.unknownCount(pos)) shortestCandidates.push_back(pos);
-    }
-    /* 最短経路上に未知区画がなければ次へ */
-    if (shortestCandidates.empty()) break;
-    /* 現在地から最短候補への移動経路を未知壁はないものとして導出 */
+    /* スタートへのステップマップに新たな壁の差分のみを反映 */
+    returnMap.update(maze);
+    /* 既知壁のみの最短経路が最短であると証明できたら次へ */
+    if (certificate.certify(maze).status == OptimalityCertificate::Optimal)
+      break;
+    /* 最短経路の改善が見込める区画のうち、移動コストあたりの効果が最大の区画
+     * を目的地とする。改善の見込める区画がなければ次へ */
+    Position target;
+    if (!planner.selectTarget(maze, currentPos, target)) break;
+    /* 現在地から目的地への移動経路を未知壁はないものとして導出 */
     const auto moveDirs = stepMap.calcShortestDirections(
-        maze, currentPos, shortestCandidates, false, true);
+        maze, currentPos, {target}, false, true);
     /* エラー処理 */
     if (moveDirs.empty()) {
       MAZE_LOGE << "Failed to Find a path to goal!" << std::endl;
@@ -169,8 +182,8 @@ int SearchRun(Maze& maze, const Maze& mazeTarget) {
     /* 現在地のスタート区画判定 */
     if (currentPos == maze.getStart()) break;
     /* 現在地からスタートへの最短経路を既知壁のみの経路で導出 */
-    const auto moveDirs = stepMap.calcShortestDirections(
-        maze, currentPos, {maze.getStart()}, true, true);
+    /* 探索中に更新し続けたステップマップを下るだけで求まる */
+    const auto moveDirs = returnMap.calcShortestDirections(maze, currentPos);
     /* エラー処理 */
     if (moveDirs.empty()) {
       MAZE_LOGE << "Failed to Find a path to goal!" << std::endl;
@@ -185,7 +198,7 @@ int SearchRun(Maze& maze, const Maze& mazeTarget) {
       currentPos = currentPos.next(nextDir);
       currentDir = nextDir;
       /* アニメーション表示 */
-      ShowAnimation(stepMap, maze, currentPos, currentDir,
+      ShowAnimation(returnMap.getStepMap(), maze, currentPos, currentDir,
                     "Going Back to Start");
     }
   }
@@ -197,8 +210,11 @@ int SearchRun(Maze& maze, const Maze& mazeTarget) {
  * @brief 最短走行のアルゴリズム
  */
 int ShortestRun(const Maze& maze) {
-  /* スタートからゴールまでの最短経路導出 */
+  /* スタートからゴールまでの最短経路導出 (ゴール区画内で減速して停止) */
   StepMap stepMap;
+  stepMap.setGoalBraking(true);
+  /* 同じコストの経路が複数あれば、曲がる回数の少ないものを選ぶ */
+  stepMap.setTieBreak(StepMap::FewerTurns);
   const auto shortestDirs = stepMap.calcShortestDirections(
       maze, maze.getStart(), maze.getGoals(), true, false);
   if (shortestDirs.empty()) {
@@ -220,6 +236,12 @@ int ShortestRun(const Maze& maze) {
   }
   /* 最短経路の表示 */
   maze.print(shortestDirs);
+  /* 走行動作の列と推定時間の表示 (斜めあり) */
+  const MotionCompiler compiler;
+  const auto motions = compiler.compile(shortestDirs, true);
+  std::cout << motions << std::endl;
+  std::cout << "Estimated Time: " << MotionCompiler::calcTotalTime(motions)
+            << " [ms]" << std::endl;
   /* 終了 */
   return 0;
 }
@@ -0,0 +1,30 @@
+/**
+ * @file FuzzCheck.h
+ * @brief ファジング対象で共通に用いる定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-19
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>  //< for std::abort
+#include <iostream>
+
+/**
+ * @brief 性質の確認。NDEBUG によらず、満たさなければ異常終了する
+ */
+#define FUZZ_CHECK(cond)                                                   \
+  do {                                                                     \
+    if (!(cond)) {                                                         \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": FUZZ_CHECK(" #cond    \
+                << ") failed" << std::endl;                                \
+      std::abort();                                                        \
+    }                                                                      \
+  } while (0)
+
+/**
+ * @brief ファジング対象の入口 (libFuzzer の規約)
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
@@ -0,0 +1,74 @@
+/**
+ * @file StandaloneFuzzMain.cpp
+ * @brief libFuzzer のないコンパイラ向けのファジングの駆動部
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-19
+ * @details
+ * 引数のファイル (ディレクトリなら中のファイルすべて) を入力として
+ * ファジング対象を呼び、さらに入力ごとに -runs で指定した回数だけ
+ * バイトの反転、挿入、削除、切り詰めを加えた入力で呼ぶ。
+ * 変異の乱数列は固定なので、失敗は同じ引数で再現する。
+ *
+ * 使い方: fuzz_xxx [-runs=N] [file or directory]...
+ */
+#include <cstring>  //< for std::strncmp
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "FuzzCheck.h"
+
+int main(int argc, char* argv[]) {
+  /* 引数の解析 */
+  long runs = 0;
+  std::vector<std::filesystem::path> paths;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strncmp(argv[i], "-runs=", 6)) {
+      runs = std::atol(argv[i] + 6);
+      continue;
+    }
+    if (argv[i][0] == '-') continue;  //< libFuzzer の他のオプションは無視
+    std::error_code ec;
+    if (std::filesystem::is_directory(argv[i], ec)) {
+      for (const auto& entry : std::filesystem::directory_iterator(argv[i]))
+        if (entry.is_regular_file()) paths.push_back(entry.path());
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  /* 入力ごとに、そのままと変異を加えたものを試す */
+  uint64_t state = 88172645463325252ull;
+  const auto random = [&](const size_t n) {
+    state ^= state << 13, state ^= state >> 7, state ^= state << 17;
+    return n ? static_cast<size_t>(state % n) : 0;
+  };
+  for (const auto& path : paths) {
+    std::ifstream ifs(path, std::ios::binary);
+    const std::vector<uint8_t> input((std::istreambuf_iterator<char>(ifs)),
+                                     std::istreambuf_iterator<char>());
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+    auto data = input;
+    for (long r = 0; r < runs; ++r) {
+      if (r % 16 == 0) data = input;  //< 変異が積み重なりすぎないように戻す
+      switch (random(4)) {
+        case 0:
+          if (!data.empty()) data[random(data.size())] ^= 1 << random(8);
+          break;
+        case 1:
+          data.insert(data.begin() + random(data.size() + 1), random(256));
+          break;
+        case 2:
+          if (!data.empty()) data.erase(data.begin() + random(data.size()));
+          break;
+        case 3:
+          data.resize(random(data.size() + 1));
+          break;
+      }
+      LLVMFuzzerTestOneInput(data.data(), data.size());
+    }
+  }
+  std::cout << "# " << paths.size() << " inputs, " << runs
+            << " mutations each" << std::endl;
+  return 0;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file fuzz_parse_array.cpp
+ * @brief Maze::parse(const std::vector<std::string>&, int) のファジング対象
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-19
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @details 先頭の1バイトを迷路の大きさ、残りを改行区切りの行とする
+ */
+#include "FuzzCheck.h"
+#include "MazeLib/Maze.h"
+
+using namespace MazeLib;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  if (size < 1) return 0;
+  const int mazeSize = static_cast<int8_t>(data[0]);
+  std::vector<std::string> lines(1);
+  for (size_t i = 1; i < size; ++i) {
+    if (data[i] == '\n')
+      lines.emplace_back();
+    else
+      lines.back().push_back(static_cast<char>(data[i]));
+  }
+  Maze maze;
+  if (!maze.parse(lines, mazeSize)) return 0;
+  FUZZ_CHECK(mazeSize >= 1 && mazeSize <= MAZE_SIZE);
+  FUZZ_CHECK(maze.isWall(0, 0, Direction::East));
+  FUZZ_CHECK(!maze.isWall(0, 0, Direction::North));
+  FUZZ_CHECK(maze.getHash() == maze.calcHash());
+  return 0;
+}
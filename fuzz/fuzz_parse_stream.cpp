@@ -0,0 +1,33 @@
+/**
+ * @file fuzz_parse_stream.cpp
+ * @brief Maze::parse(std::istream&) のファジング対象
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-19
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <sstream>
+
+#include "FuzzCheck.h"
+#include "MazeLib/Maze.h"
+
+using namespace MazeLib;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  std::istringstream is(
+      std::string(reinterpret_cast<const char*>(data), size));
+  Maze maze;
+  if (!maze.parse(is)) return 0;
+  /* 読み込めた迷路は迷路内に収まっている */
+  FUZZ_CHECK(maze.getStart().isInsideOfField());
+  for (const auto p : maze.getGoals()) FUZZ_CHECK(p.isInsideOfField());
+  FUZZ_CHECK(maze.getHash() == maze.calcHash());
+  /* 表示したものを2つ連結しても、順に再び読み込める */
+  std::stringstream ss;
+  maze.print(ss);
+  maze.print(ss);
+  Maze reparsed;
+  FUZZ_CHECK(reparsed.parse(ss));
+  FUZZ_CHECK(reparsed.parse(ss));
+  FUZZ_CHECK(!reparsed.parse(ss));
+  return 0;
+}
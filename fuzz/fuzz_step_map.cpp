@@ -0,0 +1,43 @@
+/**
+ * @file fuzz_step_map.cpp
+ * @brief StepMap の経路導出のファジング対象
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-19
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @details
+ * 先頭の2バイトをゴール区画、以降のビットを壁の有無と既知未知として
+ * 迷路を作り、全区画の展開、A* 探索、最短経路の導出が整合するか確認する。
+ */
+#include "FuzzCheck.h"
+#include "MazeLib/StepMap.h"
+
+using namespace MazeLib;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  if (size < 2) return 0;
+  const auto goal = Position(data[0] % MAZE_SIZE, data[1] % MAZE_SIZE);
+  Maze maze({goal});
+  /* 2ビットずつ壁の有無と既知未知に割り当てる */
+  for (size_t i = 0; i < (size - 2) * 4 && i < WallIndex::SIZE; ++i) {
+    const uint8_t bits = data[2 + i / 4] >> (2 * (i % 4));
+    const WallIndex wi(static_cast<uint16_t>(i));
+    if (!wi.isInsideOfField() || !(bits & 2)) continue;
+    maze.updateWall(wi.getPosition(), wi.getDirection(), bits & 1);
+  }
+  StepMap stepMap;
+  for (const bool knownOnly : {true, false}) {
+    for (const bool simple : {true, false}) {
+      const auto dirs = stepMap.calcShortestDirections(maze, knownOnly, simple);
+      const auto step = stepMap.getStep(maze.getStart());
+      FUZZ_CHECK(dirs.empty() == (step == StepMap::STEP_MAX));
+      if (dirs.empty()) continue;
+      /* 導出した経路のコストは始点のステップに等しい */
+      FUZZ_CHECK(stepMap.calcDirectionsCost(dirs, simple) == step);
+      /* A* 探索でも同じコスト */
+      const auto astar = stepMap.calcShortestDirectionsAstar(
+          maze, maze.getStart(), maze.getGoals(), knownOnly, simple);
+      FUZZ_CHECK(stepMap.calcDirectionsCost(astar, simple) == step);
+    }
+  }
+  return 0;
+}
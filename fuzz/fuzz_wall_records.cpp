@@ -0,0 +1,31 @@
+/**
+ * @file fuzz_wall_records.cpp
+ * @brief Maze::restoreWallRecords() (壁ログの読み込み) のファジング対象
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-19
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <sstream>
+
+#include "FuzzCheck.h"
+#include "MazeLib/Maze.h"
+
+using namespace MazeLib;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  std::istringstream is(
+      std::string(reinterpret_cast<const char*>(data), size));
+  Maze maze;
+  const bool valid = maze.restoreWallRecords(is);
+  FUZZ_CHECK(!valid || size % sizeof(WallRecord) == 0);
+  FUZZ_CHECK(maze.getHash() == maze.calcHash());
+  /* 復元した記録はすべて迷路内の壁沿い方向 */
+  for (const auto& wr : maze.getWallRecords()) {
+    FUZZ_CHECK(wr.getPosition().isInsideOfField());
+    FUZZ_CHECK(wr.getDirection().isAlong());
+  }
+  /* 直近の壁を捨てて再構築しても整合している */
+  maze.resetLastWalls(size ? data[0] : 0);
+  FUZZ_CHECK(maze.getHash() == maze.calcHash());
+  return 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file AllPairsIndex.h
+ * @brief 既知の迷路の全区画間の最短経路を引くための索引を定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-24
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include <vector>
+
+#include "MazeLib/StepMap.h"
+
+namespace MazeLib {
+
+/**
+ * @brief 探索を終えた迷路で、任意の区画間の最短経路を繰り返し引くための索引
+ * @details
+ * 既知壁のみの迷路について、全区画を目的地とするステップマップ
+ * (StepMap::update() の結果) を前もって計算しておく。
+ * 区画数の2乗のステップ (16x16 迷路で 128 KiB) を保持する代わりに、
+ * 問い合わせは展開をせずにステップを下るだけで済む。
+ *
+ * save() で迷路と並べて保存でき、load() では保存したときの迷路の
+ * 壁情報のハッシュ (Maze::getHash()) と一致する場合のみ復元する。
+ */
+class AllPairsIndex {
+ public:
+  using step_t = StepMap::step_t; /**< @brief ステップの型 */
+
+ public:
+  /**
+   * @brief 索引を作る
+   * @param[in] maze 使用する迷路 (既知壁のみを使用する)
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   */
+  void build(const Maze& maze, const bool simple = false);
+  /** @brief 索引を空にする */
+  void clear() { steps.clear(); }
+  /** @brief 索引が空でなく、迷路の壁情報が作ったときと同じかどうか */
+  bool isValidFor(const Maze& maze) const {
+    return !steps.empty() && hash == maze.getHash();
+  }
+  /**
+   * @brief 区画 from から区画 to への最短経路のコスト
+   * @return 経路がないか、迷路外の区画なら `STEP_MAX`
+   */
+  step_t getStep(const Position from, const Position to) const {
+    if (steps.empty() || !from.isInsideOfField() || !to.isInsideOfField())
+      return StepMap::STEP_MAX;
+    return steps[to.getIndex() * Position::SIZE + from.getIndex()];
+  }
+  /**
+   * @brief 区画 from から区画 to への最短経路を導出する
+   * @return 最短経路の方向列。経路がない場合は空配列となる。
+   */
+  Directions calcShortestDirections(const Position from,
+                                    const Position to) const;
+  /**
+   * @brief 索引をバイト列として保存する
+   * @param os 保存先の output-stream (バイナリモード)
+   * @return true: 成功、false: 索引が空または書き込み失敗
+   */
+  bool save(std::ostream& os) const;
+  /**
+   * @brief save() で保存したバイト列から索引を復元する
+   * @details 形式が異なるか、迷路の壁情報のハッシュが一致しない場合は
+   * 索引を空にして false を返す
+   * @param is 復元元の input-stream (バイナリモード)
+   * @param maze 索引を使う迷路
+   * @return true: 成功、false: 失敗
+   */
+  bool load(std::istream& is, const Maze& maze);
+
+ protected:
+  bool simple = false; /**< @brief 隣接区画のコストを1にする */
+  uint64_t hash = 0;   /**< @brief 作ったときの迷路の壁情報のハッシュ */
+  /** @brief 直線のコストテーブル (StepMap と同じ) */
+  std::array<step_t, MAZE_SIZE> stepTable;
+  /** @brief 区画ごとの通過可能な方向 (bit0-3: East, North, West, South) */
+  std::array<uint8_t, Position::SIZE> open;
+  /** @brief 目的地ごとのステップマップを並べたもの */
+  std::vector<step_t> steps;
+};
+
+}  // namespace MazeLib
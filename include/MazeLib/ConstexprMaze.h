@@ -0,0 +1,302 @@
+/**
+ * @file ConstexprMaze.h
+ * @brief コンパイル時に評価できる迷路とステップマップを定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-11
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include <string_view>
+
+#include "MazeLib/StepMap.h"
+
+namespace MazeLib {
+
+/**
+ * @brief コンパイル時に評価できる、壁情報が既知の迷路
+ * @details
+ * 壁情報を行ごとのビット列で保持し、すべての操作を constexpr で行う。
+ * 回帰試験用の迷路を定数として埋め込み、static_assert で検査できる。
+ * @tparam N 迷路の1辺の区画数 (1 以上 32 以下)
+ *
+ * ```cpp
+ * constexpr ConstexprMaze<4> maze(R"(
+ * +---+---+---+---+
+ * |               |
+ * ...
+ * )");
+ * static_assert(maze.isValid());
+ * ```
+ */
+template <int N>
+class ConstexprMaze {
+  static_assert(0 < N && N <= 32, "N is out of range");
+
+ public:
+  static constexpr int SIZE = N; /**< @brief 迷路の1辺の区画数 */
+
+ public:
+  /**
+   * @brief デフォルトコンストラクタ。壁のない迷路
+   */
+  constexpr ConstexprMaze() = default;
+  /**
+   * @brief 迷路の文字列 (*.maze ファイルの形式) から生成するコンストラクタ
+   * @details パースに失敗した場合 isValid() が false となる
+   */
+  constexpr explicit ConstexprMaze(const std::string_view text) {
+    valid = parse(text);
+  }
+  /**
+   * @brief 迷路の文字列 (*.maze ファイルの形式) から壁をパースする
+   * @details 先頭の空行は読み飛ばす。改行は LF と CRLF に対応。
+   * @param[in] text 迷路の文字列
+   * @return true: 成功, false: 失敗
+   */
+  constexpr bool parse(const std::string_view text) {
+    *this = ConstexprMaze();
+    std::size_t pos = 0;
+    int line = 0;
+    while (line < 2 * N + 1 && pos <= text.size()) {
+      auto end = text.find('\n', pos);
+      if (end == std::string_view::npos) end = text.size();
+      auto l = text.substr(pos, end - pos);
+      pos = end + 1;
+      if (!l.empty() && l.back() == '\r') l.remove_suffix(1);
+      /* 迷路の開始行まで読み飛ばす */
+      if (line == 0 && (l.empty() || (l[0] != '+' && l[0] != 'o'))) continue;
+      if (l.size() < 4 * N + 1) return false;
+      const int y = N - 1 - line / 2;
+      if (line % 2 == 0) {
+        /* horizontal walls: 行 y の北側の壁 */
+        if (y < N - 1 && y >= 0)
+          for (int x = 0; x < N; ++x)
+            if (l.substr(4 * x + 1, 3) == "---") north[y] |= 1u << x;
+      } else {
+        /* vertical walls and cells */
+        for (int x = 0; x < N; ++x) {
+          const char c = l[4 * x + 2];
+          if (c == 'S') start_x = x, start_y = y;
+          if (c == 'G') goal[y] |= 1u << x;
+          if (x < N - 1 && l[4 * x + 4] == '|') east[y] |= 1u << x;
+        }
+      }
+      ++line;
+    }
+    return line == 2 * N + 1;
+  }
+  /**
+   * @brief パースに成功したかどうか
+   */
+  constexpr bool isValid() const { return valid; }
+  /**
+   * @brief 区画が迷路内かどうか
+   */
+  static constexpr bool isInside(const int x, const int y) {
+    return 0 <= x && x < N && 0 <= y && y < N;
+  }
+  /**
+   * @brief 壁の有無を返す。迷路外の区画や外周は壁ありとする
+   * @param[in] x,y 区画の座標
+   * @param[in] d 壁の方向 (4方位)
+   */
+  constexpr bool isWall(const int x, const int y, const Direction d) const {
+    if (!isInside(x, y)) return true;
+    switch (d) {
+      case Direction::East:
+        return x == N - 1 || ((east[y] >> x) & 1);
+      case Direction::North:
+        return y == N - 1 || ((north[y] >> x) & 1);
+      case Direction::West:
+        return x == 0 || ((east[y] >> (x - 1)) & 1);
+      case Direction::South:
+        return y == 0 || ((north[y - 1] >> x) & 1);
+      default:
+        return true;
+    }
+  }
+  /**
+   * @brief 区画がゴールかどうか
+   */
+  constexpr bool isGoal(const int x, const int y) const {
+    return isInside(x, y) && ((goal[y] >> x) & 1);
+  }
+  /**
+   * @brief スタート区画の取得
+   */
+  constexpr Position getStart() const { return Position(start_x, start_y); }
+  /**
+   * @brief 実行時の迷路に変換する
+   */
+  Maze toMaze() const {
+    Maze maze;
+    maze.reset(false);
+    Positions goals;
+    for (int8_t x = 0; x < N; ++x) {
+      for (int8_t y = 0; y < N; ++y) {
+        const auto p = Position(x, y);
+        for (const auto d : Direction::Along4())
+          maze.updateWall(p, d, isWall(x, y, d), false);
+        if (isGoal(x, y)) goals.push_back(p);
+      }
+    }
+    maze.setStart(getStart());
+    maze.setGoals(goals);
+    return maze;
+  }
+
+ protected:
+  std::array<uint32_t, N> east{};  /**< @brief 行ごとの東側の壁 */
+  std::array<uint32_t, N> north{}; /**< @brief 行ごとの北側の壁 */
+  std::array<uint32_t, N> goal{};  /**< @brief 行ごとのゴール区画 */
+  int8_t start_x = 0;              /**< @brief スタート区画の x 座標 */
+  int8_t start_y = 0;              /**< @brief スタート区画の y 座標 */
+  bool valid = false;              /**< @brief パースに成功したかどうか */
+};
+
+/**
+ * @brief コンパイル時に評価できるステップマップ
+ * @details
+ * 優先度付きキューの代わりに未確定区画の線形探索による Dijkstra 法を用いる。
+ * 展開は直線の先まで打ち切らずに行うので、ステップは厳密な最小コストとなる。
+ * constexpr 変数として定義すれば、ステップマップを読み出し専用領域に配置できる。
+ * @tparam N 迷路の1辺の区画数
+ *
+ * ```cpp
+ * static constexpr ConstexprStepMap<16> stepMap(maze, false);
+ * static_assert(stepMap.getStep(maze.getStart()) == 1234);
+ * ```
+ */
+template <int N>
+class ConstexprStepMap {
+ public:
+  using step_t = StepMap::step_t; /**< @brief ステップの型 */
+  static constexpr step_t STEP_MAX = StepMap::STEP_MAX; /**< @brief 最大値 */
+  /**
+   * @brief 直線のコストテーブルの型。添字の区画数だけ直進するコスト
+   */
+  using StepTable = std::array<step_t, N>;
+  /**
+   * @brief 固定長の経路
+   */
+  struct Route {
+    std::array<Direction, N * N> directions{}; /**< @brief 方向列 */
+    int size = 0;                              /**< @brief 方向列の長さ */
+    step_t cost = STEP_MAX;                    /**< @brief 経路のコスト */
+  };
+
+ public:
+  /**
+   * @brief デフォルトコンストラクタ。全区画のステップを最大値とする
+   */
+  constexpr ConstexprStepMap() {
+    for (auto& step : steps) step = STEP_MAX;
+  }
+  /**
+   * @brief ゴールからのステップマップを計算するコンストラクタ
+   * @param[in] maze 迷路
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   */
+  constexpr ConstexprStepMap(const ConstexprMaze<N>& maze, const bool simple)
+      : stepTable(calcStepTable()) {
+    update(maze, simple);
+  }
+  /**
+   * @brief StepMap と同じ台形加速のコストテーブルを計算する
+   */
+  static constexpr StepTable calcStepTable() {
+    StepTable table{};
+    for (int i = 1; i < N; ++i)
+      table[i] = StepMap::TrapezoidProfile::calcStep(i);
+    return table;
+  }
+  /**
+   * @brief ゴールからのステップマップを計算する
+   */
+  constexpr void update(const ConstexprMaze<N>& maze, const bool simple) {
+    std::array<bool, N * N> settled{};
+    for (auto& step : steps) step = STEP_MAX;  //< std::array::fill は C++20
+    for (int x = 0; x < N; ++x)
+      for (int y = 0; y < N; ++y)
+        if (maze.isGoal(x, y)) steps[index(x, y)] = 0;
+    while (1) {
+      /* 未確定の区画のうちステップが最小の区画を確定 */
+      int focus = -1;
+      for (int i = 0; i < N * N; ++i)
+        if (!settled[i] && steps[i] != STEP_MAX &&
+            (focus < 0 || steps[i] < steps[focus]))
+          focus = i;
+      if (focus < 0) break;
+      settled[focus] = true;
+      /* 直線で行けるところまで更新する */
+      for (const auto d : along4) {
+        int x = focus / N, y = focus % N;
+        for (int i = 1; !maze.isWall(x, y, d); ++i) {
+          x += dx(d), y += dy(d);
+          const int next_step = steps[focus] + (simple ? i : stepTable[i]);
+          if (next_step >= STEP_MAX) break;
+          auto& step = steps[index(x, y)];
+          if (step > next_step) step = next_step;
+        }
+      }
+    }
+    this->simple = simple;
+  }
+  /**
+   * @brief ステップの取得。迷路外なら `STEP_MAX` を返す
+   */
+  constexpr step_t getStep(const int x, const int y) const {
+    return ConstexprMaze<N>::isInside(x, y) ? steps[index(x, y)] : STEP_MAX;
+  }
+  /**
+   * @brief ステップの取得。迷路外なら `STEP_MAX` を返す
+   */
+  constexpr step_t getStep(const Position p) const { return getStep(p.x, p.y); }
+  /**
+   * @brief ステップを下る方向に進んでゴールまでの最短経路を導出する
+   * @param[in] maze ステップマップの計算に使用した迷路
+   * @param[in] start 始点区画
+   * @return 最短経路。経路がなければ長さ0で、コストは `STEP_MAX`
+   */
+  constexpr Route calcShortestRoute(const ConstexprMaze<N>& maze,
+                                    const Position start) const {
+    Route route;
+    int x = start.x, y = start.y;
+    if (getStep(x, y) == STEP_MAX) return route;
+    route.cost = getStep(x, y);
+    while (getStep(x, y) != 0) {
+      bool found = false;
+      for (const auto d : along4) {
+        int nx = x, ny = y;
+        for (int i = 1; !found && !maze.isWall(nx, ny, d); ++i) {
+          nx += dx(d), ny += dy(d);
+          const int cost = simple ? i : stepTable[i];
+          if (getStep(nx, ny) + cost != getStep(x, y)) continue;
+          for (int j = 0; j < i; ++j) route.directions[route.size++] = d;
+          x = nx, y = ny, found = true;
+        }
+        if (found) break;
+      }
+      if (!found) return Route();  //< ステップマップが迷路と一致しない
+    }
+    return route;
+  }
+
+ protected:
+  StepTable stepTable{};                 /**< @brief 直線のコストテーブル */
+  std::array<step_t, N * N> steps{};     /**< @brief 区画ごとのステップ */
+  bool simple = true;                    /**< @brief 計算時のコストの種類 */
+  static constexpr Direction along4[4] = {
+      Direction::East, Direction::North, Direction::West, Direction::South};
+
+  static constexpr int index(const int x, const int y) { return x * N + y; }
+  static constexpr int dx(const Direction d) {
+    return d == Direction::East ? 1 : d == Direction::West ? -1 : 0;
+  }
+  static constexpr int dy(const Direction d) {
+    return d == Direction::North ? 1 : d == Direction::South ? -1 : 0;
+  }
+};
+
+}  // namespace MazeLib
@@ -0,0 +1,81 @@
+/**
+ * @file ExplorationPlanner.h
+ * @brief 最短経路の改善効果にもとづく探索目的地の選択を行うクラスを定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-08
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include "MazeLib/StepMap.h"
+
+namespace MazeLib {
+
+/**
+ * @brief 最短経路を見つけるための追加探索の目的地を選ぶクラス
+ * @details
+ * 未知壁を壁なしとみなした楽観的なステップマップ (下限) と、
+ * 未知壁を壁ありとみなした悲観的なステップマップ (上限) を用いて、
+ * 未知壁を含む各区画を訪れたときの最短経路の改善量の期待値を見積もる。
+ * 改善量を現在地からの移動コストで割った値が最大の区画を目的地とする。
+ * 改善の見込める区画がなくなれば、既知壁のみの最短経路が最短である。
+ */
+class ExplorationPlanner {
+ public:
+  using step_t = StepMap::step_t; /**< @brief ステップの型 */
+  /**
+   * @brief 探索目的地の候補
+   */
+  struct Candidate {
+    Position p;   /**< @brief 候補区画 */
+    float gain;   /**< @brief 最短経路の改善量の期待値 [step] */
+    step_t cost;  /**< @brief 現在地からの移動コスト [区画] */
+    float score;  /**< @brief 移動コストあたりの改善量 */
+  };
+  /**
+   * @brief Candidate 構造体の動的配列
+   */
+  using Candidates = std::vector<Candidate>;
+
+ public:
+  /**
+   * @brief 探索目的地の候補を評価する
+   * @param[in] maze 探索中の迷路。スタートとゴールを参照する
+   * @param[in] current 現在区画
+   * @return スコアの降順に並んだ候補の配列。空なら探索の必要はない
+   */
+  const Candidates& evaluate(const Maze& maze, const Position current);
+  /**
+   * @brief 次の探索目的地を選ぶ
+   * @param[in] maze 探索中の迷路。スタートとゴールを参照する
+   * @param[in] current 現在区画
+   * @param[out] target スコアが最大の候補区画
+   * @return true: 目的地あり、false: 改善の見込める区画がない
+   */
+  bool selectTarget(const Maze& maze, const Position current,
+                    Position& target) {
+    const auto& candidates = evaluate(maze, current);
+    if (candidates.empty()) return false;
+    target = candidates.front().p;
+    return true;
+  }
+  /**
+   * @brief 直前の評価における最短経路コストの下限 (未知壁は壁なし)
+   */
+  step_t getLowerStep() const { return lowerStep; }
+  /**
+   * @brief 直前の評価における最短経路コストの上限 (既知壁のみ)
+   */
+  step_t getUpperStep() const { return upperStep; }
+
+ protected:
+  StepMap stepMapGoal;    /**< @brief ゴールからの楽観的なステップマップ */
+  StepMap stepMapStart;   /**< @brief スタートからの楽観的なステップマップ */
+  StepMap stepMapKnown;   /**< @brief ゴールからの既知壁のみのステップマップ */
+  StepMap stepMapCurrent; /**< @brief 現在地からの移動用のステップマップ */
+  Candidates candidates;  /**< @brief 直前の評価結果 */
+  step_t lowerStep = StepMap::STEP_MAX; /**< @brief 最短経路コストの下限 */
+  step_t upperStep = StepMap::STEP_MAX; /**< @brief 最短経路コストの上限 */
+};
+
+}  // namespace MazeLib
@@ -0,0 +1,78 @@
+/**
+ * @file IncrementalStepMap.h
+ * @brief 壁ログの差分のみでスタートへのステップマップを更新するクラスを定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-22
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include "MazeLib/StepMap.h"
+
+namespace MazeLib {
+
+/**
+ * @brief スタート区画を目的地とする既知壁のみのステップマップを、
+ * 探索中に見つけた壁の差分のみで更新し続けるクラス
+ * @details
+ * 既知壁のみの経路では、未知壁が壁なしと確定すると辺が増えるだけなので、
+ * ステップは減ることはあっても増えることはない。
+ * そこで迷路の壁ログ (Maze::getWallRecords()) の未反映分のうち、
+ * 新たに通過可能となった壁をまたぐ直線の始点となり得る区画のみを起点に
+ * ステップを緩和する。スタートへ戻る経路はステップマップを下るだけで求まる。
+ *
+ * 次の場合は全区画を計算し直す。
+ * - 初回、スタート区画が変わった場合
+ * - 壁ログが短くなった場合 (Maze::resetLastWalls() など)
+ * - 通過可能だった壁が矛盾により未知壁に戻った場合
+ *
+ * 壁ログに残さない壁の更新 (Maze::setWall() など) は検出しないので、
+ * その場合は reset() を呼ぶ。
+ */
+class IncrementalStepMap {
+ public:
+  /**
+   * @brief コンストラクタ
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   */
+  explicit IncrementalStepMap(const bool simple = true) : simple(simple) {}
+  /**
+   * @brief 次の update() で全区画を計算し直すようにする
+   */
+  void reset() { wallRecordsSize = 0, start = Position(-1, -1); }
+  /**
+   * @brief 壁ログの未反映分をステップマップに反映する
+   * @param[in] maze 使用する迷路。探索中の迷路と同じものを渡し続ける
+   */
+  void update(const Maze& maze);
+  /**
+   * @brief 壁ログを反映し、区画 p からスタート区画への最短経路を導出する
+   * @param[in] maze 使用する迷路
+   * @param[in] p 始点区画
+   * @return 既知壁のみの最短経路の方向列。経路がない場合は空配列となる。
+   */
+  Directions calcShortestDirections(const Maze& maze, const Position p);
+  /** @brief 内部のステップマップ (読み取り専用) */
+  const StepMap& getStepMap() const { return stepMap; }
+  /** @brief 全区画を計算し直した回数 */
+  int getRebuilds() const { return rebuilds; }
+  /** @brief 差分の緩和の起点とした区画の延べ数 */
+  int getRelaxedSeeds() const { return relaxedSeeds; }
+
+ protected:
+  StepMap stepMap;                   /**< @brief スタートへのステップマップ */
+  bool simple;                       /**< @brief 隣接区画のコストを1にする */
+  Position start = Position(-1, -1); /**< @brief 目的地のスタート区画 */
+  size_t wallRecordsSize = 0;        /**< @brief 反映済みの壁ログの数 */
+  /** @brief 反映済みの、既知壁のみで通過可能な壁 */
+  std::bitset<WallIndex::SIZE> open;
+  int rebuilds = 0;     /**< @brief 全区画を計算し直した回数 */
+  int relaxedSeeds = 0; /**< @brief 緩和の起点とした区画の延べ数 */
+
+  /**
+   * @brief 全区画を計算し直す
+   */
+  void rebuild(const Maze& maze);
+};
+
+}  // namespace MazeLib
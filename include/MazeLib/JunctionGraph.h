@@ -0,0 +1,144 @@
+/**
+ * @file JunctionGraph.h
+ * @brief 通路を縮約した分岐点のグラフによる最短経路の導出を定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-23
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include "MazeLib/StepMap.h"
+
+namespace MazeLib {
+
+/**
+ * @brief 迷路の通路を縮約した分岐点のグラフで最短経路を導出するクラス
+ * @details
+ * StepMap と同じコストの模型 (直線ごとに stepTable のコスト) のもとで、
+ * 経路が曲がり得ない区画を展開の対象から除く。
+ * - 直進区画 (向かい合う2方向のみ通過可能): 直線は通り抜けるだけなので除く
+ * - 曲がり角 (直交する2方向のみ通過可能) が直線でつながる連なり:
+ *   内側の曲がり角を除き、両端の曲がり角の間を固定コストの辺で結ぶ
+ * - それ以外 (分岐点、行き止まり、スタート、ゴール): 節点とする
+ *
+ * 節点からは直線上のすべての節点に辺を張る (途中の節点も通り抜けられる)。
+ * 導出した経路のコストは StepMap::calcShortestDirections() と等しい。
+ *
+ * 迷路の壁ログ (Maze::getWallRecords()) の未反映分は、変化した壁の周辺の
+ * 区画の分類と、それにつながる曲がり角の連なりのみを作り直して反映する。
+ * 初回、スタートまたはゴールが変わった場合、壁ログが短くなった場合は
+ * 全体を作り直す。壁ログに残さない壁の更新の後は reset() を呼ぶ。
+ */
+class JunctionGraph {
+ public:
+  using step_t = StepMap::step_t; /**< @brief ステップの型 */
+
+ public:
+  /**
+   * @brief コンストラクタ
+   * @param[in] knownOnly 未知壁は壁ありとみなし、既知壁のみを使用する
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   */
+  explicit JunctionGraph(const bool knownOnly = true,
+                         const bool simple = false);
+  /**
+   * @brief 次の update() で全体を作り直すようにする
+   */
+  void reset() { wallRecordsSize = 0, start = Position(-1, -1); }
+  /**
+   * @brief 壁ログの未反映分をグラフに反映する
+   * @param[in] maze 使用する迷路。同じ迷路を渡し続ける
+   */
+  void update(const Maze& maze);
+  /**
+   * @brief 壁ログを反映し、スタートからゴールまでの最短経路を導出する
+   * @param[in] maze 使用する迷路
+   * @return 最短経路の方向列。経路がない場合は空配列となる。
+   */
+  Directions calcShortestDirections(const Maze& maze);
+  /** @brief 区画が節点かどうか */
+  bool isNode(const Position p) const {
+    return p.isInsideOfField() && nodes[p.getIndex()];
+  }
+  /** @brief 節点の数 */
+  int getNodeCount() const { return nodes.count(); }
+  /**
+   * @brief 曲がり角の連なりの端から、もう一方の端への辺の行き先
+   * @return 辺がなければ迷路外の区画
+   */
+  Position getShortcut(const Position p) const {
+    return p.isInsideOfField() ? shortcuts[p.getIndex()] : Position(-1, -1);
+  }
+  /**
+   * @brief 直前の導出のステップ (節点のみ有効)
+   * @details 盤面外なら `STEP_MAX` を返す
+   */
+  step_t getStep(const Position p) const {
+    return p.isInsideOfField() ? steps[p.getIndex()] : StepMap::STEP_MAX;
+  }
+  /** @brief 直前の導出でキューに積んだ回数 */
+  int getQueuePushes() const { return queuePushes; }
+  /** @brief 全体を作り直した回数 */
+  int getRebuilds() const { return rebuilds; }
+
+ protected:
+  bool knownOnly;                    /**< @brief 既知壁のみを使用する */
+  bool simple;                       /**< @brief 隣接区画のコストを1にする */
+  Position start = Position(-1, -1); /**< @brief スタート区画 */
+  Positions goals;                   /**< @brief ゴール区画 */
+  size_t wallRecordsSize = 0;        /**< @brief 反映済みの壁ログの数 */
+  int queuePushes = 0;               /**< @brief キューに積んだ回数 */
+  int rebuilds = 0;                  /**< @brief 全体を作り直した回数 */
+  /** @brief 直線のコストテーブル (StepMap と同じ) */
+  std::array<step_t, MAZE_SIZE> stepTable;
+  /** @brief 区画ごとの通過可能な方向 (bit0-3: East, North, West, South) */
+  std::array<uint8_t, Position::SIZE> open;
+  std::bitset<Position::SIZE> fixed; /**< @brief スタートとゴールの区画 */
+  std::bitset<Position::SIZE> nodes; /**< @brief 節点の区画 */
+  /** @brief 曲がり角の連なりの端から、もう一方の端への辺の行き先 */
+  std::array<Position, Position::SIZE> shortcuts;
+  /** @brief 曲がり角の連なりの端から、もう一方の端への辺のコスト */
+  std::array<step_t, Position::SIZE> shortcutCosts;
+  /** @brief 直前の導出の節点のステップ */
+  std::array<step_t, Position::SIZE> steps;
+
+  /** @brief 全体を作り直す */
+  void rebuild(const Maze& maze);
+  /**
+   * @brief 壁の両側の区画の通過可能な方向を更新する
+   * @param[out] changed 通過可能な方向が変わった区画を追記する
+   */
+  void updateWall(const Maze& maze, const WallIndex i, Positions& changed);
+  /** @brief 区画を分類し直す。曲がり角なら連なり全体を作り直す */
+  void classify(const Position p);
+  /** @brief 曲がり角の連なりを作り直す */
+  Positions rechain(const Position p);
+  /** @brief 区画 p から方向 d に通過可能か */
+  bool isOpen(const Position p, const Direction d) const {
+    return open[p.getIndex()] >> (d >> 1) & 1;
+  }
+  /** @brief 直進区画かどうか */
+  bool isStraight(const Position p) const;
+  /** @brief 曲がり角かどうか */
+  bool isCorner(const Position p) const;
+  /** @brief 方向 d から入った曲がり角 p を出る方向 */
+  Direction turnCorner(const Position p, const Direction d) const;
+  /**
+   * @brief 区画 p から方向 d に直進区画を通り抜け、最初の直進区画でない区画
+   * @param[out] length 進んだ区画数
+   */
+  Position walk(Position p, const Direction d, int& length) const;
+  /**
+   * @brief 曲がり角の連なりの端から、もう一方の端までたどる
+   * @param[out] dirs nullptr でなければ方向列を追記する
+   * @return 辺のコスト
+   */
+  step_t walkChain(const Position from, const Position to,
+                   Directions* dirs) const;
+  /** @brief 直線のコスト */
+  step_t getEdgeCost(const int length) const {
+    return simple ? length : stepTable[length];
+  }
+};
+
+}  // namespace MazeLib
@@ -44,6 +44,31 @@ static int microseconds() __attribute__((unused));
 #define MAZE_DEBUG_PROFILING_END(id)
 #endif
 
+/**
+ * @brief 壁情報の保持形式の選択
+ * @details
+ * - 0: 壁ごとに1bit (WallIndex の通し番号の bitset)。共有する壁は1か所に保持
+ * - 1: 区画ごとに1byte (下位4bit: 壁の有無、上位4bit: 既知未知)。
+ *   共有する壁は隣接する2区画に重複して保持し、区画の4方向の壁を1回の読み出しで得る
+ */
+#ifndef MAZE_CELL_STORAGE
+#define MAZE_CELL_STORAGE 0
+#endif
+
+/**
+ * @brief 動的配列のアロケータの選択
+ * @details
+ * - 0: std::vector (既定のアロケータ)
+ * - 1: std::pmr::vector。既定のメモリリソースから確保するので、
+ *   MazeArena::Scope の間は MazeArena から確保する
+ */
+#ifndef MAZE_PMR
+#define MAZE_PMR 0
+#endif
+#if MAZE_PMR
+#include <memory_resource>
+#endif
+
 /*
  * 迷路のカラー表示切替
  */
@@ -113,6 +138,17 @@ static constexpr int MAZE_SIZE_BIT = std::ceil(std::log2(MAZE_SIZE));
  */
 static constexpr int MAZE_SIZE_MAX = std::pow(2, MAZE_SIZE_BIT);
 
+/**
+ * @brief ライブラリの動的配列の型 (MAZE_PMR 参照)
+ */
+#if MAZE_PMR
+template <typename T>
+using Vector = std::pmr::vector<T>;
+#else
+template <typename T>
+using Vector = std::vector<T>;
+#endif
+
 /**
  * @brief 迷路上の方向を表す。
  * @details 実体は 8bit の整数。
@@ -245,7 +281,7 @@ static_assert(sizeof(Direction) == 1, "size error");
 /**
  *  @brief Direction 構造体の動的配列、集合
  */
-using Directions = std::vector<Direction>;
+using Directions = Vector<Direction>;
 /**
  * @brief Directions の stream 表示
  * @details >^<v の形式
@@ -372,7 +408,7 @@ static_assert(sizeof(Position) == 2, "size error");
 /**
  * @brief Position 構造体の動的配列、集合
  */
-using Positions = std::vector<Position>;
+using Positions = Vector<Position>;
 
 /**
  * @brief Position と Direction をまとめた型。位置姿勢。
@@ -589,7 +625,7 @@ static_assert(sizeof(WallIndex) == 2, "size error");
 /**
  * @brief WallIndex の動的配列、集合
  */
-using WallIndexes = std::vector<WallIndex>;
+using WallIndexes = Vector<WallIndex>;
 
 /**
  * @brief 区画位置、方向、壁の有無を保持する構造体。
@@ -632,7 +668,9 @@ static_assert(sizeof(WallRecord) == 2, "size error");
 /**
  * @brief WallRecord 構造体の動的配列の定義
  */
-using WallRecords = std::vector<WallRecord>;
+using WallRecords = Vector<WallRecord>;
+
+class MazeRenderer;
 
 /**
  * @brief 迷路の壁情報を管理するクラス
@@ -666,12 +704,12 @@ class Maze {
    * @brief 壁の有無を返す
    * @return true: 壁あり、false: 壁なし
    */
-  bool isWall(const WallIndex i) const { return isWallBase(wall, i); }
+  bool isWall(const WallIndex i) const { return isWallBase(i, false); }
   bool isWall(const Position p, const Direction d) const {
-    return isWallBase(wall, WallIndex(p, d));
+    return isWallBase(p, d, false);
   }
   bool isWall(const int8_t x, const int8_t y, const Direction d) const {
-    return isWallBase(wall, WallIndex(Position(x, y), d));
+    return isWallBase(Position(x, y), d, false);
   }
   /**
    * @brief 壁を更新をする
@@ -679,25 +717,25 @@ class Maze {
    * @param b 壁の有無 true:壁あり、false:壁なし
    */
   void setWall(const WallIndex i, const bool b) {
-    return setWallBase(wall, i, b);
+    return setWallBase(i, false, b);
   }
   void setWall(const Position p, const Direction d, const bool b) {
-    return setWallBase(wall, WallIndex(p, d), b);
+    return setWallBase(WallIndex(p, d), false, b);
   }
   void setWall(const int8_t x, const int8_t y, const Direction d,
                const bool b) {
-    return setWallBase(wall, WallIndex(Position(x, y), d), b);
+    return setWallBase(WallIndex(Position(x, y), d), false, b);
   }
   /**
    * @brief 壁が探索済みかを返す
    * @return true: 探索済み、false: 未探索
    */
-  bool isKnown(const WallIndex i) const { return isWallBase(known, i); }
+  bool isKnown(const WallIndex i) const { return isWallBase(i, true); }
   bool isKnown(const Position p, const Direction d) const {
-    return isWallBase(known, WallIndex(p, d));
+    return isWallBase(p, d, true);
   }
   bool isKnown(const int8_t x, const int8_t y, const Direction d) const {
-    return isWallBase(known, WallIndex(Position(x, y), d));
+    return isWallBase(Position(x, y), d, true);
   }
   /**
    * @brief 壁の既知を更新する
@@ -705,14 +743,14 @@ class Maze {
    * @param b 壁の未知既知 true:既知、false:未知
    */
   void setKnown(const WallIndex i, const bool b) {
-    return setWallBase(known, i, b);
+    return setWallBase(i, true, b);
   }
   void setKnown(const Position p, const Direction d, const bool b) {
-    return setWallBase(known, WallIndex(p, d), b);
+    return setWallBase(WallIndex(p, d), true, b);
   }
   void setKnown(const int8_t x, const int8_t y, const Direction d,
                 const bool b) {
-    return setWallBase(known, WallIndex(Position(x, y), d), b);
+    return setWallBase(WallIndex(Position(x, y), d), true, b);
   }
   /**
    * @brief 通過可能かどうかを返す
@@ -758,11 +796,14 @@ class Maze {
   int8_t unknownCount(const Position p) const;
   /**
    * @brief 迷路の表示
+   * @details 呼ぶたびに MazeRenderer のバッファを確保する。
+   * 繰り返し表示する場合は MazeRenderer を渡す版を使うこと。
    */
   void print(std::ostream& os = std::cout,
              const int mazeSize = MAZE_SIZE) const;
   /**
    * @brief パス付きの迷路の表示
+   * @details 呼ぶたびに MazeRenderer のバッファを確保する。
    * @param start パスのスタート座標
    * @param dirs 移動方向の配列
    * @param os output-stream
@@ -773,12 +814,28 @@ class Maze {
              const int mazeSize = MAZE_SIZE) const;
   /**
    * @brief 位置のハイライト付きの迷路の表示
+   * @details 呼ぶたびに MazeRenderer のバッファを確保する。
    * @param positions ハイライトする位置の集合
    * @param os output-stream
    * @param mazeSize 迷路の1辺の区画数（正方形のみ対応）
    */
   void print(const Positions& positions, std::ostream& os = std::cout,
              const int mazeSize = MAZE_SIZE) const;
+  /**
+   * @brief 呼び出し側の MazeRenderer を使い回す迷路の表示
+   * @details renderer のバッファを再利用するので、2回目以降はメモリの確保が
+   * 発生しない。renderer に設定された経路とハイライトは消去される。
+   * @param renderer 描画に使う MazeRenderer
+   */
+  void print(MazeRenderer& renderer, std::ostream& os = std::cout,
+             const int mazeSize = MAZE_SIZE) const;
+  void print(MazeRenderer& renderer, const Directions& dirs,
+             const Position start = Position(0, 0),
+             std::ostream& os = std::cout,
+             const int mazeSize = MAZE_SIZE) const;
+  void print(MazeRenderer& renderer, const Positions& positions,
+             std::ostream& os = std::cout,
+             const int mazeSize = MAZE_SIZE) const;
   /**
    * @brief 特定の迷路の文字列(*.maze ファイル)から壁をパースする
    * @details テキスト形式。S: スタート区画(単数)、G: ゴール区画(複数可)
@@ -791,7 +848,14 @@ class Maze {
    * +---+---+
    * ```
    *
+   * 柱 ('+' または 'o') で始まる上端の行の幅から迷路の大きさを決め、
+   * 1行ずつ先頭から読むので、シークできないパイプや標準入力にも使える。
+   * 迷路の前の空行や文字列は読み飛ばし、読み終えた迷路の直後で止まるため、
+   * 複数の迷路を連結したストリームは繰り返し呼ぶことで順に読める。
+   * 行末の CR (CRLF 改行) は無視する。
+   *
    * @param is *.maze 形式のファイルの input-stream
+   * @return 迷路を読めなかった場合 (ストリームの終端を含む) false
    */
   bool parse(std::istream& is);
   bool parse(const std::string& filepath) {
@@ -803,10 +867,12 @@ class Maze {
    * @details 使用例: Maze maze; maze << std::cin;
    * @param is テキスト形式の迷路データを含む入力ストリーム
    * @param maze パース結果を書き出す迷路の参照
+   * @details 読めなかった場合は failbit を立てるので、連結された迷路を
+   * while (is >> maze) で順に読める。
    * @return std::istream& 引数の is をそのまま返す
    */
   friend std::istream& operator>>(std::istream& is, Maze& maze) {
-    maze.parse(is);
+    if (!maze.parse(is)) is.setstate(std::ios::failbit);
     return is;
   }
   /**
@@ -814,6 +880,8 @@ class Maze {
    * @param data 各区画16進表記の文字列配列
    * 例：{"abaf", "1234", "abab", "aaff"}
    * @param mazeSize 迷路の1辺の区画数（正方形のみ対応）
+   * @return 行数や文字数が mazeSize に満たない場合や、mazeSize が MAZE_SIZE
+   * を超える場合は false
    */
   bool parse(const std::vector<std::string>& data, const int mazeSize);
   /**
@@ -843,6 +911,17 @@ class Maze {
   int8_t getMinY() const { return min_y; }
   int8_t getMaxX() const { return max_x; }
   int8_t getMaxY() const { return max_y; }
+  /**
+   * @brief 壁情報 (壁の有無と既知未知) の Zobrist ハッシュを取得
+   * @details 壁の更新のたびに差分更新されるので O(1)。
+   * 同じ壁情報をもつ迷路は同じ値となる。スタートやゴールは含まない。
+   */
+  uint64_t getHash() const { return hash; }
+  /**
+   * @brief 壁情報の Zobrist ハッシュを全体から計算する (検証用)
+   * @return getHash() と同じ値
+   */
+  uint64_t calcHash() const;
   /**
    * @brief 壁ログをファイルに追記保存する関数
    */
@@ -852,10 +931,27 @@ class Maze {
    * @brief 壁ログファイルから壁情報を復元する関数
    */
   bool restoreWallRecordsFromFile(const std::string& filepath);
+  /**
+   * @brief 壁ログのバイト列から壁情報を復元する関数
+   * @details 迷路外の区画や斜め方向の記録、末尾の半端なバイト列があれば
+   * 破損とみなし、それより前の記録までを復元して false を返す
+   * @param is backupWallRecordsToFile() で保存した形式の input-stream
+   * @return true: 正常に復元した、false: 破損していた
+   */
+  bool restoreWallRecords(std::istream& is);
 
  protected:
+#if MAZE_CELL_STORAGE
+  /**
+   * @brief 区画ごとの壁情報
+   * @details bit0-3: East, North, West, South の壁の有無、bit4-7: 既知未知。
+   * 外周の壁は常に既知の壁とする。
+   */
+  std::array<uint8_t, Position::SIZE> cells;
+#else
   std::bitset<WallIndex::SIZE> wall;  /**< @brief 壁情報 */
   std::bitset<WallIndex::SIZE> known; /**< @brief 壁の既知未知情報 */
+#endif
   Positions goals;                    /**< @brief ゴール区画の集合 */
   Position start;                     /**< @brief スタート区画 */
   WallRecords wallRecords;            /**< @brief 更新した壁のログ */
@@ -864,21 +960,64 @@ class Maze {
   int8_t max_x;                       /**< @brief 既知壁の最大区画 */
   int8_t max_y;                       /**< @brief 既知壁の最大区画 */
   int wallRecordsBackupCounter; /**< @brief 壁ログバックアップのカウンタ */
+  uint64_t hash = 0; /**< @brief 壁情報の Zobrist ハッシュ */
 
   /**
    * @brief 壁の確認のベース関数。迷路外を参照すると壁ありと返す。
+   * @param isKnown 既知未知情報なら true、壁の有無なら false
    */
-  bool isWallBase(const std::bitset<WallIndex::SIZE>& wall,
-                  const WallIndex i) const {
-    return !i.isInsideOfField() || wall[i.getIndex()];  //< 範囲外は壁ありに
+  bool isWallBase(const WallIndex i, const bool isKnown) const {
+    if (!i.isInsideOfField()) return true;  //< 範囲外は壁ありに
+#if MAZE_CELL_STORAGE
+    return (cells[i.getPosition().getIndex()] >> (i.z + 4 * isKnown)) & 1;
+#else
+    return (isKnown ? known : wall)[i.getIndex()];
+#endif
+  }
+  /**
+   * @brief 区画と方向による壁の確認のベース関数
+   */
+  bool isWallBase(const Position p, const Direction d,
+                  const bool isKnown) const {
+#if MAZE_CELL_STORAGE
+    /* 区画内なら1回の読み出しで済む。外周は壁ありとして保持している */
+    if (!p.isInsideOfField() || !d.isAlong())
+      return isWallBase(WallIndex(p, d), isKnown);
+    return (cells[p.getIndex()] >> ((d >> 1) + 4 * isKnown)) & 1;
+#else
+    return isWallBase(WallIndex(p, d), isKnown);
+#endif
   }
   /**
    * @brief 壁の更新のベース関数。迷路外を参照すると無視される。
+   * @details 値が変わった場合は Zobrist ハッシュを差分更新する
+   * @param isKnown 既知未知情報なら true、壁の有無なら false
+   */
+  void setWallBase(const WallIndex i, const bool isKnown, const bool b) {
+    if (!i.isInsideOfField()) return;  //< 範囲外アクセスの防止
+    if (isWallBase(i, isKnown) == b) return;
+#if MAZE_CELL_STORAGE
+    /* 共有する壁を両側の区画に反映する */
+    const auto p = i.getPosition();
+    const auto q = i.z ? Position(p.x, p.y + 1) : Position(p.x + 1, p.y);
+    cells[p.getIndex()] ^= 1 << (i.z + 4 * isKnown);
+    cells[q.getIndex()] ^= 1 << (i.z + 2 + 4 * isKnown);
+#else
+    (isKnown ? known : wall)[i.getIndex()] = b;
+#endif
+    hash ^= getZobristKey(i.getIndex(), isKnown);
+  }
+  /**
+   * @brief Zobrist ハッシュの乱数表の代わりに splitmix64 で鍵を生成する
+   * @param index 壁の通し番号
+   * @param isKnown 既知未知情報の鍵なら true、壁の有無の鍵なら false
    */
-  void setWallBase(std::bitset<WallIndex::SIZE>& wall, const WallIndex i,
-                   const bool b) const {
-    if (i.isInsideOfField())  //< 範囲外アクセスの防止
-      wall[i.getIndex()] = b;
+  static constexpr uint64_t getZobristKey(const int index, const bool isKnown) {
+    uint64_t z = (static_cast<uint64_t>(index) << 1 | isKnown) + 1;
+    z *= 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
   }
 };
 
@@ -0,0 +1,75 @@
+/**
+ * @file MazeArena.h
+ * @brief 計画の1周期ごとにまとめて解放するメモリ領域を定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-25
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include "MazeLib/Maze.h"
+
+#if MAZE_PMR
+
+#include <memory>  //< for std::unique_ptr
+
+namespace MazeLib {
+
+/**
+ * @brief 計画の1周期ごとにまとめて解放する単調増加のメモリ領域
+ * @details
+ * 最初に確保したバッファから先頭から順に切り出し、個別には解放しない。
+ * reset() でバッファの先頭に戻す。
+ * Scope の間は既定のメモリリソースとなるので、その間に作った Directions
+ * などの動的配列や StepMap の更新のキューはここから確保される。
+ * バッファが足りなくなると、上位のメモリリソースから追加で確保する。
+ *
+ * reset() の後も使い続けるオブジェクト (Maze など) は Scope の外で作ること。
+ * MAZE_PMR が有効な場合のみ使用できる。
+ */
+class MazeArena {
+ public:
+  /** @brief 既定のバッファの大きさ [byte] */
+  static constexpr size_t DEFAULT_SIZE = 16 * 1024;
+
+ public:
+  /**
+   * @brief コンストラクタ。バッファはここで1回だけ確保する
+   * @param[in] size バッファの大きさ [byte]
+   * @param[in] upstream バッファが足りない場合の確保先
+   */
+  explicit MazeArena(
+      const size_t size = DEFAULT_SIZE,
+      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+      : buffer(new std::byte[size]), resource(buffer.get(), size, upstream) {}
+  /**
+   * @brief 切り出した領域をすべて解放し、バッファの先頭に戻す
+   * @details ここから確保した動的配列は、すべて破棄してから呼ぶこと
+   */
+  void reset() { resource.release(); }
+  /** @brief メモリリソースの取得 */
+  std::pmr::memory_resource* getResource() { return &resource; }
+
+  /**
+   * @brief 生存期間の間、既定のメモリリソースを MazeArena に切り替える
+   */
+  class Scope {
+   public:
+    explicit Scope(MazeArena& arena)
+        : previous(std::pmr::set_default_resource(arena.getResource())) {}
+    ~Scope() { std::pmr::set_default_resource(previous); }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    std::pmr::memory_resource* previous; /**< @brief 元に戻すリソース */
+  };
+
+ protected:
+  std::unique_ptr<std::byte[]> buffer;          /**< @brief バッファ */
+  std::pmr::monotonic_buffer_resource resource; /**< @brief 切り出し */
+};
+
+}  // namespace MazeLib
+
+#endif
@@ -0,0 +1,117 @@
+/**
+ * @file MazeBatch.h
+ * @brief 多数の迷路に同じ問い合わせをまとめて行うクラスを定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-20
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include "MazeLib/StepMap.h"
+
+namespace MazeLib {
+
+/**
+ * @brief 多数の迷路の壁情報を構造体配列ではなく配列構造体で保持し、
+ * 最短経路の導出をまとめて行うクラス
+ * @details
+ * 迷路を LANES 個ずつのグループに分け、壁ごとに「グループ内の各迷路で
+ * 壁があるか」をビット列 (レーン) にまとめて保持する。ステップも区画ごとに
+ * レーン分を連続して並べるので、内側のループはレーン方向の単純な繰り返しと
+ * なり、コンパイラの自動ベクトル化が効く。
+ * - simple: レーンのビット列による幅優先探索 (1回の展開で全レーンが進む)
+ * - 台形加速: 直線ごとの緩和を収束するまで繰り返す (Bellman-Ford)
+ *
+ * コストテーブルは StepMap のものを使い、ステップと経路は迷路ごとに
+ * StepMap::update() と StepMap::getStepDownDirections() で求めたものと一致する。
+ */
+class MazeBatch {
+ public:
+  using step_t = StepMap::step_t;   /**< @brief ステップの型 */
+  using Mask = uint16_t;           /**< @brief レーンのビット列の型 */
+  static constexpr int LANES = 16; /**< @brief 1グループの迷路の数 */
+  static_assert(sizeof(Mask) * 8 == LANES, "Mask must have LANES bits");
+  /**
+   * @brief 迷路 LANES 個分の壁情報
+   * @details 外周と迷路の外の壁、および空きレーンはすべて壁ありとする
+   */
+  struct Group {
+    std::array<Mask, WallIndex::SIZE> wall;  /**< @brief 壁の有無 */
+    std::array<Mask, WallIndex::SIZE> known; /**< @brief 壁の既知未知 */
+  };
+  /** @brief 区画ごとに LANES 個並べたステップ */
+  using Steps = std::array<std::array<step_t, LANES>, Position::SIZE>;
+
+ public:
+  /**
+   * @brief 迷路を追加する
+   * @details 壁情報、スタート、ゴールを複製する。壁ログは保持しない。
+   * @return 追加した迷路の通し番号
+   */
+  size_t add(const Maze& maze);
+  /** @brief すべての迷路を削除する */
+  void clear();
+  /** @brief 迷路の数 */
+  size_t size() const { return starts.size(); }
+  /** @brief グループの数 */
+  size_t getGroupCount() const { return groups.size(); }
+  /**
+   * @brief 1グループ分のステップを更新する
+   * @details 結果は getStep() で取得する
+   * @param[in] group グループの番号
+   * @param[in] stepMap コストテーブルの参照元
+   * @param[in] knownOnly true:未知壁は通過不可能、false:未知壁は通過可能とする
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   */
+  void update(const size_t group, const StepMap& stepMap, const bool knownOnly,
+              const bool simple);
+  /**
+   * @brief 直前に update() したグループのステップを取得する
+   * @param lane グループ内の迷路の番号
+   * @param p 区画の位置。盤面外なら `STEP_MAX` を返す
+   */
+  step_t getStep(const int lane, const Position p) const {
+    return p.isInsideOfField() ? steps[p.getIndex()][lane] : StepMap::STEP_MAX;
+  }
+  /**
+   * @brief すべての迷路のスタートからゴールまでの最短経路を導出する
+   * @param[in] stepMap コストテーブルの参照元
+   * @param[in] knownOnly 未知壁は壁ありとみなし、既知壁のみを使用する
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   * @return 迷路ごとの経路と推定コスト (追加した順)。
+   *         経路がない場合は方向列が空でコストは `STEP_MAX` となる。
+   */
+  StepMap::Routes calcShortestDirections(const StepMap& stepMap,
+                                         const bool knownOnly,
+                                         const bool simple);
+
+ protected:
+  std::vector<Group> groups;    /**< @brief 迷路 LANES 個ごとの壁情報 */
+  std::vector<Position> starts; /**< @brief 迷路ごとのスタート区画 */
+  std::vector<Positions> goals; /**< @brief 迷路ごとのゴール区画 */
+  Steps steps;                  /**< @brief 直前に更新したステップ */
+  /** @brief 直前に更新したグループの区画ごと、4方位ごとの通過可能なレーン */
+  std::array<std::array<Mask, Position::SIZE>, 4> open;
+
+  /**
+   * @brief レーンのビット列による幅優先探索 (simple)
+   * @param[inout] frontier 目的地のレーン。作業領域として使う
+   */
+  void updateSimple(std::array<Mask, Position::SIZE>& frontier);
+  /**
+   * @brief ステップが減ったレーンのみを緩和元とする直線ごとの緩和を、
+   * 変化がなくなるまで繰り返す (台形加速)
+   * @param[inout] dirty 目的地のレーン。作業領域として使う
+   */
+  void updateWeighted(std::array<Mask, Position::SIZE>& dirty,
+                      const StepMap& stepMap);
+  /**
+   * @brief 1つの迷路のステップマップを下って方向列を求める
+   * @details StepMap::getStepDownDirections() と同じ規則で方向を選ぶ
+   */
+  Directions getStepDownDirections(const int lane, const Position start,
+                                   const StepMap& stepMap,
+                                   const bool simple) const;
+};
+
+}  // namespace MazeLib
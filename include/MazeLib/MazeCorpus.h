@@ -0,0 +1,91 @@
+/**
+ * @file MazeCorpus.h
+ * @brief 対称な重複を除いて迷路の集合を管理するクラスを定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-17
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include <unordered_map>
+
+#include "MazeLib/MazeSymmetry.h"
+
+namespace MazeLib {
+
+/**
+ * @brief 対称な重複を除いて迷路の集合を管理するクラス
+ * @details
+ * 追加された迷路を正準形 (CanonicalMaze) に変換し、同じ正準形の迷路は
+ * 1つだけ保持する。元の迷路は名前と正準形への変換の組として記録するので、
+ * restore() で復元できる。生成した迷路や過去の大会の迷路から、回転や
+ * 鏡映による重複を除くために使用する。
+ */
+class MazeCorpus {
+ public:
+  /**
+   * @brief 追加された元の迷路
+   */
+  struct Member {
+    std::string name;        /**< @brief 迷路の名前 (ファイル名など) */
+    MazeTransform transform; /**< @brief 元の迷路から正準形への変換 */
+  };
+  /**
+   * @brief 正準形ごとの要素
+   */
+  struct Entry {
+    CanonicalMaze canonical;     /**< @brief 正準形の迷路 */
+    std::vector<Member> members; /**< @brief 正準形が同じ元の迷路 */
+  };
+
+ public:
+  /**
+   * @brief 迷路を追加する
+   * @param name 迷路の名前
+   * @param maze 迷路
+   * @param mazeSize 迷路の1辺の区画数
+   * @return 要素の番号と、新しい正準形なら true の組
+   */
+  std::pair<size_t, bool> add(const std::string& name, const Maze& maze,
+                              const int mazeSize = MAZE_SIZE);
+  /**
+   * @brief 対称な迷路を検索する
+   * @return 要素の番号。見つからなければ size()
+   */
+  size_t find(const Maze& maze, const int mazeSize = MAZE_SIZE) const;
+  /**
+   * @brief 元の迷路を復元する
+   * @param entry 要素の番号
+   * @param member 要素内の元の迷路の番号
+   */
+  Maze restore(const size_t entry, const size_t member) const;
+  /**
+   * @brief 正準形ごとの要素を取得
+   */
+  const std::vector<Entry>& getEntries() const { return entries; }
+  /**
+   * @brief 正準形の数
+   */
+  size_t size() const { return entries.size(); }
+  /**
+   * @brief 追加された迷路の数 (重複を含む)
+   */
+  size_t getMemberCount() const { return members; }
+  /**
+   * @brief すべて削除する
+   */
+  void clear() { entries.clear(), index.clear(), members = 0; }
+
+ private:
+  std::vector<Entry> entries; /**< @brief 正準形ごとの要素 */
+  /** @brief 正準形のハッシュ値から要素の番号への索引 */
+  std::unordered_multimap<uint64_t, size_t> index;
+  size_t members = 0; /**< @brief 追加された迷路の数 */
+
+  /**
+   * @brief 正準形の要素を検索する
+   */
+  size_t find(const CanonicalMaze& canonical, const uint64_t hash) const;
+};
+
+}  // namespace MazeLib
@@ -0,0 +1,149 @@
+/**
+ * @file MazeGenerator.h
+ * @brief 乱数により迷路を生成するクラスを定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-18
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include "MazeLib/Maze.h"
+
+namespace MazeLib {
+
+/**
+ * @brief 乱数により迷路を生成するクラス
+ * @details
+ * 全域木 (深さ優先の穴掘り法、またはクラスカル法) で全区画がつながった
+ * 迷路を作り、行き止まりの除去 (braid) と壁の除去でループを加える。
+ * 競技規則にあわせて次の性質を保証する。
+ * - スタート区画 (0, 0) は East に壁があり North が開いている
+ * - ゴール区画は正方形の部屋で、内部の壁はない
+ * - すべての区画がスタートからたどり着ける
+ * - ゴール区画の内部以外のすべての柱に少なくとも1枚の壁が接する
+ *
+ * 壁は Maze::setWall() と Maze::setKnown() で設定し、すべて既知とする。
+ * 乱数は xorshift で、同じ種と設定なら環境によらず同じ迷路を生成する。
+ * 迷路の大きさは MAZE_SIZE 以下の任意の値 (32区画は MAZE_SIZE = 32 が必要)。
+ */
+class MazeGenerator {
+ public:
+  /**
+   * @brief 全域木の生成手法
+   */
+  enum Algorithm : uint8_t {
+    DepthFirst, /**< @brief 深さ優先の穴掘り法。長い通路が多い */
+    Kruskal,    /**< @brief クラスカル法。短い枝分かれが多い */
+  };
+  /**
+   * @brief 生成の設定
+   */
+  struct Option {
+    int mazeSize = MAZE_SIZE;         /**< @brief 迷路の1辺の区画数 */
+    Algorithm algorithm = DepthFirst; /**< @brief 全域木の生成手法 */
+    /** @brief 行き止まりを除去する確率 */
+    float braid = 0;
+    /** @brief 全域木の後に残った壁をさらに除去する確率 */
+    float loops = 0;
+    /** @brief ゴール区画の1辺の区画数 (0 でゴールなし) */
+    int goalSize = 2;
+    /** @brief ゴール区画の左下。範囲外なら中央に配置する */
+    Position goal = Position(-1, -1);
+  };
+
+ public:
+  /**
+   * @brief コンストラクタ
+   * @param seed 乱数の種
+   */
+  explicit MazeGenerator(const uint64_t seed = 1) { setSeed(seed); }
+  /**
+   * @brief 乱数の種を設定する
+   */
+  void setSeed(const uint64_t seed);
+  /**
+   * @brief 迷路を生成する
+   * @param[out] maze 生成先の迷路。壁情報、スタート、ゴールは上書きされる
+   * @param[in] option 生成の設定
+   * @return 設定が不正な場合 false
+   */
+  bool generate(Maze& maze, const Option& option);
+  /**
+   * @brief 迷路を生成する
+   */
+  Maze generate(const Option& option) {
+    Maze maze;
+    generate(maze, option);
+    return maze;
+  }
+  /**
+   * @brief 柱に接する壁の数
+   * @param maze 迷路
+   * @param p 柱の位置。区画 p の左下の角
+   */
+  static int pillarWallCount(const Maze& maze, const Position p);
+
+ private:
+  uint64_t state;             /**< @brief xorshift の状態 */
+  Option option;              /**< @brief 生成中の設定 */
+  Position goal;              /**< @brief 生成中のゴール区画の左下 */
+  std::vector<uint16_t> work; /**< @brief 作業領域 (探索の stack など) */
+
+  /** @brief 64bit の乱数 */
+  uint64_t next() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+  /** @brief [0, n) の一様乱数 */
+  int uniform(const int n) {
+    return static_cast<int>(((next() >> 32) * static_cast<uint64_t>(n)) >> 32);
+  }
+  /** @brief 確率 p で true */
+  bool chance(const float p) {
+    return p > 0 && (next() >> 40) < p * static_cast<float>(1 << 24);
+  }
+  /**
+   * @brief 隣接区画 (Position::next() のインライン版)
+   * @param d 4方位
+   */
+  static Position neighbor(const Position p, const Direction d) {
+    constexpr int8_t dx[4] = {1, 0, -1, 0};
+    constexpr int8_t dy[4] = {0, 1, 0, -1};
+    return Position(p.x + dx[d >> 1], p.y + dy[d >> 1]);
+  }
+  /** @brief 区画が迷路内か */
+  bool isInside(const Position p) const {
+    return static_cast<uint8_t>(p.x) < option.mazeSize &&
+           static_cast<uint8_t>(p.y) < option.mazeSize;
+  }
+  /** @brief 区画がゴール区画か */
+  bool isGoal(const Position p) const {
+    return static_cast<uint8_t>(p.x - goal.x) < option.goalSize &&
+           static_cast<uint8_t>(p.y - goal.y) < option.goalSize;
+  }
+  /** @brief 除去してはいけない壁か (外周とスタート区画の East) */
+  bool isFixed(const Position p, const Direction d) const {
+    const auto q = neighbor(p, d);
+    return !isInside(q) || (p == Position(0, 0) && d == Direction::East) ||
+           (q == Position(0, 0) && d == Direction::West);
+  }
+  /** @brief 柱がゴール区画の内部にあるか */
+  bool isGoalPillar(const Position p) const {
+    return option.goalSize >= 2 && isGoal(p) &&
+           isGoal(p + Position(-1, -1));
+  }
+  /**
+   * @brief 柱の規則を守って壁を除去できるか
+   */
+  bool canRemove(const Maze& maze, const Position p, const Direction d) const;
+  /** @brief 深さ優先の穴掘り法 */
+  void carveDepthFirst(Maze& maze);
+  /** @brief クラスカル法 */
+  void carveKruskal(Maze& maze);
+  /** @brief 行き止まりの除去と壁の除去 */
+  void addLoops(Maze& maze);
+};
+
+}  // namespace MazeLib
@@ -0,0 +1,119 @@
+/**
+ * @file MazeRenderer.h
+ * @brief 迷路とステップマップを文字列として描画するクラスを定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-10
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include "MazeLib/Maze.h"
+
+namespace MazeLib {
+
+class StepMap;
+
+/**
+ * @brief 迷路とステップマップを1枚の文字列バッファに描画するクラス
+ * @details
+ * 経路が通る壁はビットセットと壁ごとの方向の配列で保持し、壁ごとの描画を
+ * 定数時間で行う。描画先のバッファは再利用されるので、同じインスタンスで
+ * 繰り返し描画すれば、初回以降はメモリの確保が発生しない。
+ * アニメーション表示では、前回から変化した行のみを出力できる。
+ */
+class MazeRenderer {
+ public:
+  /**
+   * @brief コンストラクタ。最大の迷路を描画できるバッファを確保する
+   */
+  MazeRenderer();
+  /**
+   * @brief ハイライトする経路を設定する
+   * @param[in] dirs 移動方向の配列
+   * @param[in] start 経路の始点
+   */
+  void setPath(const Directions& dirs, const Position start);
+  /**
+   * @brief ハイライトする区画の集合を設定する
+   */
+  void setHighlights(const Positions& positions);
+  /**
+   * @brief 経路とハイライトを消去する
+   */
+  void clear();
+  /**
+   * @brief 迷路を装飾なしで描画する。迷路ファイルとして読み込める形式
+   * @param[in] maze 描画する迷路
+   * @param[in] mazeSize 迷路の1辺の区画数（正方形のみ対応）
+   */
+  void renderMaze(const Maze& maze, const int mazeSize = MAZE_SIZE);
+  /**
+   * @brief 迷路を経路とハイライト付きで描画する
+   * @param[in] maze 描画する迷路
+   * @param[in] mazeSize 迷路の1辺の区画数（正方形のみ対応）
+   */
+  void renderMazeColored(const Maze& maze, const int mazeSize = MAZE_SIZE);
+  /**
+   * @brief ステップマップを経路付きで描画する
+   * @param[in] maze 描画する迷路
+   * @param[in] stepMap 描画するステップマップ
+   * @param[in] full ステップをスケーリングせずに5桁で描画する
+   */
+  void renderStepMap(const Maze& maze, const StepMap& stepMap,
+                     const bool full = false);
+  /**
+   * @brief 描画結果の取得
+   */
+  const std::string& getBuffer() const { return buffer; }
+  /**
+   * @brief 描画結果をすべて出力する
+   */
+  void write(std::ostream& os) const { os.write(buffer.data(), buffer.size()); }
+  /**
+   * @brief 前回の出力から変化した行のみを、カーソルを移動して出力する
+   * @details 描画結果の先頭行を端末の row 行目に表示している前提。
+   * 出力後、カーソルは描画結果の次の行の先頭に移動する。
+   * @param[inout] os output-stream
+   * @param[in] row 描画結果の先頭行を表示する端末の行番号 (1始まり)
+   * @return 出力した行数
+   */
+  int writeChanged(std::ostream& os, const int row = 1);
+
+ protected:
+  std::string buffer; /**< @brief 描画結果 */
+  /** @brief 各行の終端の位置 */
+  std::vector<uint32_t> lineEnds;
+  /** @brief 前回出力した各行のハッシュ値 */
+  std::vector<uint32_t> lineHashes;
+  /** @brief 経路が通る壁 */
+  std::bitset<WallIndex::SIZE> pathWalls;
+  /** @brief 経路が壁を通るときの方向 */
+  std::array<Direction, WallIndex::SIZE> pathDirs;
+  /** @brief ハイライトする区画 */
+  std::bitset<Position::SIZE> highlights;
+  /** @brief 描画中の迷路のゴール区画 */
+  std::bitset<Position::SIZE> goals;
+
+  /**
+   * @brief 描画を始める。バッファを空にしてゴール区画を取得する
+   */
+  void begin(const Maze& maze, const int mazeSize, const int lineLength);
+  /**
+   * @brief 1行を終える
+   */
+  void endLine(const char* suffix = "");
+  /**
+   * @brief 経路が通る壁ならその方向を取得する
+   */
+  bool findPath(const WallIndex& i, Direction& d) const {
+    if (!i.isInsideOfField() || !pathWalls[i.getIndex()]) return false;
+    d = pathDirs[i.getIndex()];
+    return true;
+  }
+  /**
+   * @brief 整数を右寄せで追加する
+   */
+  void appendNumber(const int value, const int width);
+};
+
+}  // namespace MazeLib
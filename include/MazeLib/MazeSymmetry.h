@@ -0,0 +1,186 @@
+/**
+ * @file MazeSymmetry.h
+ * @brief 迷路の対称変換と正準形を定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-17
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include <tuple>  //< for std::tie
+
+#include "MazeLib/Maze.h"
+
+namespace MazeLib {
+
+/**
+ * @brief 正方形の迷路の対称変換 (回転と鏡映からなる8通り)
+ * @details
+ * 転置 (x と y の入れ替え)、x 方向の反転、y 方向の反転をこの順に適用する。
+ * 3ビットの組み合わせで二面体群 D4 の8要素すべてを表す。
+ * 例えば 90度回転 (反時計回り) は転置と x 方向の反転の組み合わせ。
+ */
+struct MazeTransform {
+  static constexpr int SIZE = 8; /**< @brief 変換の総数 */
+  uint8_t value = 0; /**< @brief bit0: 転置, bit1: x反転, bit2: y反転 */
+
+  /** @brief デフォルトコンストラクタ。恒等変換 */
+  constexpr MazeTransform() {}
+  /** @brief 通し番号から生成する */
+  constexpr explicit MazeTransform(const uint8_t value) : value(value & 7) {}
+  /** @brief 成分から生成する */
+  constexpr MazeTransform(const bool transpose, const bool mirrorX,
+                          const bool mirrorY)
+      : value(transpose | mirrorX << 1 | mirrorY << 2) {}
+  /** @brief 転置を含むか */
+  constexpr bool isTransposed() const { return value & 1; }
+  /** @brief x 方向の反転を含むか */
+  constexpr bool isMirroredX() const { return value & 2; }
+  /** @brief y 方向の反転を含むか */
+  constexpr bool isMirroredY() const { return value & 4; }
+  /** @brief 等号 */
+  constexpr bool operator==(const MazeTransform t) const {
+    return value == t.value;
+  }
+  /** @brief 等号否定 */
+  constexpr bool operator!=(const MazeTransform t) const {
+    return value != t.value;
+  }
+  /**
+   * @brief 逆変換
+   * @details 転置を含む場合は反転の軸が入れ替わる
+   */
+  constexpr MazeTransform inverse() const {
+    return isTransposed() ? MazeTransform(true, isMirroredY(), isMirroredX())
+                          : *this;
+  }
+  /**
+   * @brief 区画位置を変換する
+   * @param p 区画位置
+   * @param mazeSize 迷路の1辺の区画数
+   */
+  Position apply(const Position p, const int mazeSize) const;
+  /**
+   * @brief 方向を変換する
+   * @param d 絶対方向 (8方位)
+   */
+  Direction apply(const Direction d) const;
+  /**
+   * @brief 迷路を変換する
+   * @details 壁情報、スタート、ゴールを変換する。壁ログは引き継がない。
+   * @param maze 変換元の迷路
+   * @param mazeSize 迷路の1辺の区画数
+   */
+  Maze apply(const Maze& maze, const int mazeSize = MAZE_SIZE) const;
+  /**
+   * @brief 表示用演算子のオーバーロード。例: "T-Y" (転置と y 反転)
+   */
+  friend std::ostream& operator<<(std::ostream& os, const MazeTransform t);
+};
+
+/**
+ * @brief 迷路の壁情報を行ごとのビット列で表したもの
+ * @details
+ * 行 y のビット x に区画 (x, y) の East 壁、North 壁、およびそれらの既知未知を
+ * 格納する。迷路内部の壁のみを保持し、外周の壁は含まない。
+ * 対称変換は行単位のビット反転、行の並べ替え、ビット行列の転置で行う。
+ */
+struct MazeBitPlanes {
+  using Row = uint64_t; /**< @brief 1行分のビット列 */
+  static_assert(MAZE_SIZE_MAX <= 64, "MAZE_SIZE is too large!");
+  using Plane = std::array<Row, MAZE_SIZE_MAX>; /**< @brief 1面分 */
+  Plane east{};       /**< @brief East 壁の有無 */
+  Plane north{};      /**< @brief North 壁の有無 */
+  Plane eastKnown{};  /**< @brief East 壁の既知未知 */
+  Plane northKnown{}; /**< @brief North 壁の既知未知 */
+
+  /**
+   * @brief 迷路の壁情報から生成する
+   * @param maze 迷路
+   * @param mazeSize 迷路の1辺の区画数
+   */
+  static MazeBitPlanes fromMaze(const Maze& maze, const int mazeSize);
+  /**
+   * @brief 壁情報を迷路に書き出す
+   * @details 迷路の壁情報は初期化される。mazeSize が MAZE_SIZE より小さい場合は
+   * 外周の壁を既知の壁として設定する。
+   * @param maze 書き出し先の迷路
+   * @param mazeSize 迷路の1辺の区画数
+   */
+  void toMaze(Maze& maze, const int mazeSize) const;
+  /**
+   * @brief 対称変換した壁情報を返す
+   * @param t 対称変換
+   * @param mazeSize 迷路の1辺の区画数
+   */
+  MazeBitPlanes transformed(const MazeTransform t, const int mazeSize) const;
+  /**
+   * @brief 全体の 64bit ハッシュ値
+   */
+  uint64_t hash() const;
+  /** @brief 等号 */
+  bool operator==(const MazeBitPlanes& obj) const {
+    return east == obj.east && north == obj.north &&
+           eastKnown == obj.eastKnown && northKnown == obj.northKnown;
+  }
+  /** @brief 辞書式順序の比較 */
+  bool operator<(const MazeBitPlanes& obj) const {
+    return std::tie(east, north, eastKnown, northKnown) <
+           std::tie(obj.east, obj.north, obj.eastKnown, obj.northKnown);
+  }
+
+  /**
+   * @brief 正方ビット行列の転置 (行 i のビット j と行 j のビット i の交換)
+   * @details ブロックの交換を log2(MAZE_SIZE_MAX) 段で行う
+   */
+  static void transpose(Plane& plane);
+  /**
+   * @brief 下位 n ビットの並びを反転する
+   */
+  static Row reverse(Row row, const int n);
+};
+
+/**
+ * @brief 対称変換に関する正準形の迷路
+ * @details
+ * 8通りの対称変換のうち、壁情報、スタート、ゴールの組が辞書式順序で
+ * 最小となるものを正準形とする。対称な迷路どうしは同じ正準形となる。
+ */
+struct CanonicalMaze {
+  MazeBitPlanes planes;    /**< @brief 正準形の壁情報 */
+  Position start;          /**< @brief 正準形のスタート区画 */
+  Positions goals;         /**< @brief 正準形のゴール区画 (昇順) */
+  int mazeSize = 0;        /**< @brief 迷路の1辺の区画数 */
+  MazeTransform transform; /**< @brief 元の迷路から正準形への変換 */
+
+  /**
+   * @brief 迷路の正準形を求める
+   * @param maze 迷路
+   * @param mazeSize 迷路の1辺の区画数
+   */
+  static CanonicalMaze fromMaze(const Maze& maze,
+                                const int mazeSize = MAZE_SIZE);
+  /**
+   * @brief 正準形の迷路を生成する
+   */
+  Maze toMaze() const;
+  /**
+   * @brief 正準形の 64bit ハッシュ値 (変換の種類は含まない)
+   */
+  uint64_t hash() const;
+  /** @brief 等号 (変換の種類は比較しない) */
+  bool operator==(const CanonicalMaze& obj) const {
+    return mazeSize == obj.mazeSize && start == obj.start &&
+           goals == obj.goals && planes == obj.planes;
+  }
+  /** @brief 等号否定 */
+  bool operator!=(const CanonicalMaze& obj) const { return !(*this == obj); }
+
+  /**
+   * @brief 読み込んだ迷路の1辺の区画数を既知壁の範囲から推定する
+   * @details Maze::parse() で読み込んだ迷路は外周の壁も既知となることを用いる
+   */
+  static int estimateMazeSize(const Maze& maze);
+};
+
+}  // namespace MazeLib
@@ -0,0 +1,155 @@
+/**
+ * @file MotionPrimitive.h
+ * @brief 移動方向列を走行動作の列に変換するクラスを定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-15
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include "MazeLib/StepMap.h"
+
+namespace MazeLib {
+
+/**
+ * @brief 走行動作の単位 (モーションプリミティブ)
+ */
+struct MotionPrimitive {
+  /**
+   * @brief 走行動作の種類
+   */
+  enum Type : uint8_t {
+    Straight, /**< @brief 壁沿いの直線 */
+    Diagonal, /**< @brief 斜めの直線 */
+    S90,      /**< @brief 小回り90度ターン (探索用) */
+    F45,      /**< @brief 45度ターン (壁沿い <-> 斜め) */
+    F90,      /**< @brief 大回り90度ターン */
+    F135,     /**< @brief 135度ターン (壁沿い <-> 斜め) */
+    F180,     /**< @brief 180度ターン */
+    FV90,     /**< @brief 斜めから斜めへの90度ターン */
+    TypeMax,  /**< @brief 種類の数 */
+  };
+  Type type;      /**< @brief 走行動作の種類 */
+  Direction turn; /**< @brief ターンの向き (Left or Right)。直線では Front */
+  /**
+   * @brief 直線の長さ。ターンでは 0
+   * @details Straight は半区画 (区画の中心と境界の間)、
+   * Diagonal は斜めの半区画 (隣り合う区画の境界の中点の間) の数
+   */
+  uint8_t length;
+  float time; /**< @brief 推定所要時間 [ms] */
+
+  /**
+   * @brief 表示用の文字列。例: "S8", "D3", "F90R", "FV90L"
+   */
+  std::string toString() const;
+  /**
+   * @brief stream 表示
+   */
+  friend std::ostream& operator<<(std::ostream& os, const MotionPrimitive& m) {
+    return os << m.toString();
+  }
+};
+/**
+ * @brief MotionPrimitive 構造体の動的配列
+ */
+using MotionPrimitives = std::vector<MotionPrimitive>;
+/**
+ * @brief MotionPrimitives の stream 表示
+ * @details 空白区切りで表示
+ */
+std::ostream& operator<<(std::ostream& os, const MotionPrimitives& obj);
+
+/**
+ * @brief 移動方向列を走行動作の列に変換するクラス
+ * @details
+ * 移動方向列を、区画の境界の中点どうしを結ぶ線分 (壁沿いは1区画、
+ * 曲がる区画では斜めの半区画) に分解し、同じ向きの線分をまとめてから
+ * ターンのパターンにあてはめる。StepMap::appendStraightDirections() で
+ * 斜めに延長した方向列もそのまま変換できる。
+ *
+ * 斜めなしでは、曲がる区画ごとに小回り90度ターンとなる。
+ * 斜めありでは、壁沿いの直線に挟まれた斜めの線分の並びを次のように変換する。
+ * - 斜め1本: 大回り90度ターン
+ * - 90度向きの異なる斜め1本ずつ: 180度ターン
+ * - それ以外: 先頭の斜めが1本だけなら135度ターン、そうでなければ45度ターンで
+ *   斜めに入り、末尾も同様に抜ける。途中で向きが変わる所は V90 ターン。
+ *
+ * 所要時間は StepMap のコストテーブルと同じ台形加速の模型で見積もる。
+ * 直線の長さは区画の境界の中点を基準とした近似であり、ターンによる
+ * 直線の短縮は考慮しない。
+ */
+class MotionCompiler {
+ public:
+  /**
+   * @brief 所要時間の見積もりに用いる走行パラメータ
+   * @details
+   * 直線と小回り90度ターンの既定値は StepMap::TrapezoidProfile から取るので、
+   * StepMap のコストテーブルと常に同じ模型となる。
+   */
+  struct Parameter {
+    using Profile = StepMap::TrapezoidProfile;
+    float vs = Profile::vs;   /**< @brief 基本速度 (ターン速度) [mm/s] */
+    float am = Profile::am;   /**< @brief 最大加速度 [mm/s/s] */
+    float vm = Profile::vm;   /**< @brief 飽和速度 [mm/s] */
+    float seg = Profile::seg; /**< @brief 区画の長さ [mm] */
+    float turnTime[MotionPrimitive::TypeMax] = {
+        0, 0, Profile::t_turn, 180.0f, 360.0f, 430.0f, 520.0f, 300.0f,
+    }; /**< @brief ターンごとの所要時間 [ms] (直線の要素は未使用) */
+  };
+
+ public:
+  /**
+   * @brief デフォルトコンストラクタ
+   */
+  MotionCompiler() {}
+  /**
+   * @brief コンストラクタ
+   * @param[in] parameter 所要時間の見積もりに用いる走行パラメータ
+   */
+  explicit MotionCompiler(const Parameter& parameter) : parameter(parameter) {}
+  /**
+   * @brief 移動方向列を走行動作の列に変換する
+   * @param[in] dirs 始点区画からの移動方向列 (壁沿い方向のみ)
+   * @param[in] diagEnabled 斜め走行を使用する
+   * @return 走行動作の列。180度向きを変える移動を含む場合は空
+   */
+  MotionPrimitives compile(const Directions& dirs,
+                           const bool diagEnabled) const;
+  /**
+   * @brief 直線を台形加速で走行する時間を見積もる
+   * @param[in] distance 走行距離 [mm]
+   * @return 所要時間 [ms]
+   */
+  float calcStraightTime(const float distance) const;
+  /**
+   * @brief 走行動作の列の所要時間の合計
+   * @param[in] motions 走行動作の列
+   * @return 所要時間 [ms]
+   */
+  static float calcTotalTime(const MotionPrimitives& motions);
+  /**
+   * @brief 走行パラメータの取得
+   */
+  const Parameter& getParameter() const { return parameter; }
+
+ protected:
+  Parameter parameter; /**< @brief 走行パラメータ */
+
+  /**
+   * @brief 直線の走行動作を生成する
+   * @param[in] type Straight or Diagonal
+   * @param[in] length 半区画の数
+   */
+  MotionPrimitive makeStraight(const MotionPrimitive::Type type,
+                               const int length) const;
+  /**
+   * @brief ターンの走行動作を生成する
+   * @param[in] type ターンの種類
+   * @param[in] rel 曲がる方向 (相対方向)。符号により左右を決める
+   */
+  MotionPrimitive makeTurn(const MotionPrimitive::Type type,
+                           const Direction rel) const;
+};
+
+}  // namespace MazeLib
@@ -0,0 +1,149 @@
+/**
+ * @file OptimalityCertificate.h
+ * @brief 既知壁のみの最短経路が最短であることの証明を扱うクラスを定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-09
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include <queue>  //< for std::priority_queue
+
+#include "MazeLib/StepMap.h"
+
+namespace MazeLib {
+
+/**
+ * @brief 既知壁のみの最短経路が最短であることを証明するクラス
+ * @details
+ * ゴールからのステップを、未知壁を壁なしとみなす楽観的なチャンネル (下限) と
+ * 未知壁を壁ありとみなす悲観的なチャンネル (上限) の2つで同時に管理する。
+ * 2つのチャンネルは同じ配列と同じ優先度付きキューを共有し、1回の展開で
+ * 両方を求める。スタートにおける上限が下限に一致すれば、既知壁のみの最短経路
+ * は未知壁がどうであっても最短である。
+ *
+ * 探索により壁が判明するたびに、迷路の壁ログの差分を取り込んで更新する。
+ * - 壁なしが判明した場合、上限が減るだけなので、その壁を通る直線上の区画から
+ *   展開を再開する。
+ * - 壁ありが判明した場合、下限が増える可能性がある。その壁を横切る直線の
+ *   うち最短経路木の辺になり得るものがあれば、下限を次の証明時に再計算する。
+ * - 壁ログの削除や既知壁との食い違い、展開範囲の拡大があれば全体を再計算する。
+ *
+ * 展開範囲は StepMap と同様に既知壁の範囲に制限する。壁ログに記録されない
+ * 壁の変更は検出できないので、迷路を差し替えた場合は reset() を呼ぶこと。
+ */
+class OptimalityCertificate {
+ public:
+  using step_t = StepMap::step_t; /**< @brief ステップの型 */
+  /**
+   * @brief 証明の状態
+   */
+  enum Status : uint8_t {
+    NoPath,          /**< @brief ゴールへの経路が存在しない */
+    Unproven,        /**< @brief 既知壁のみの経路が最短である保証はない */
+    WithinTolerance, /**< @brief 既知壁のみの経路が許容範囲内で最短 */
+    Optimal,         /**< @brief 既知壁のみの経路が最短 */
+  };
+  /**
+   * @brief 証明の結果
+   */
+  struct Result {
+    Status status; /**< @brief 証明の状態 */
+    step_t lower;  /**< @brief 最短経路コストの下限 (未知壁は壁なし) */
+    step_t upper;  /**< @brief 最短経路コストの上限 (既知壁のみ) */
+  };
+
+ public:
+  /**
+   * @brief コンストラクタ
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   */
+  explicit OptimalityCertificate(const bool simple = false);
+  /**
+   * @brief 管理している状態を破棄する。次回の更新で全体を再計算する
+   */
+  void reset();
+  /**
+   * @brief 迷路の壁ログの差分を取り込んでステップを更新する
+   * @details 下限の再計算が必要な場合は、次の証明時まで保留する
+   * @param[in] maze 探索中の迷路。ゴールを展開の起点とする
+   */
+  void update(const Maze& maze);
+  /**
+   * @brief 既知壁のみの最短経路の最短性を証明する
+   * @param[in] maze 探索中の迷路。スタートにおけるステップを比較する
+   * @param[in] tolerance 上限が下限の (1 + tolerance) 倍以下なら許容する
+   * @return 証明の結果
+   */
+  Result certify(const Maze& maze, const float tolerance = 0);
+  /**
+   * @brief 下限のステップの取得。盤面外なら `STEP_MAX` を返す
+   * @details 再計算が保留されている場合があるので、certify() の後に参照する
+   */
+  step_t getLowerStep(const Position p) const {
+    return p.isInsideOfField() ? steps[p.getIndex()][Lower] : STEP_MAX;
+  }
+  /**
+   * @brief 上限のステップの取得。盤面外なら `STEP_MAX` を返す
+   */
+  step_t getUpperStep(const Position p) const {
+    return p.isInsideOfField() ? steps[p.getIndex()][Upper] : STEP_MAX;
+  }
+
+ protected:
+  static constexpr step_t STEP_MAX = StepMap::STEP_MAX; /**< @brief 最大値 */
+  /** @brief チャンネルの添字 */
+  enum Channel : uint8_t { Lower, Upper, ChannelMax };
+  /** @brief ステップの更新予約のキューの要素 */
+  struct Element {
+    Position p;
+    Channel ch;
+    step_t s;
+    bool operator<(const Element& e) const { return s > e.s; }
+  };
+
+  const bool simple; /**< @brief 台形加速を考慮しない */
+  /** @brief 台形加速を考慮した直線のコストテーブル */
+  std::array<step_t, MAZE_SIZE> stepTable;
+  /** @brief 区画ごとの下限と上限のステップ */
+  std::array<std::array<step_t, ChannelMax>, Position::SIZE> steps;
+  /** @brief ステップの更新予約のキュー (2チャンネル共有) */
+  std::priority_queue<Element> q;
+  /** @brief 展開の起点としたゴール */
+  Positions dest;
+  /** @brief 取り込み済みの壁ログの数。負なら全体の再計算が必要 */
+  int recordCount = -1;
+  /** @brief 取り込み済みの壁ログに含まれる壁 */
+  std::bitset<WallIndex::SIZE> recorded;
+  /** @brief 下限の再計算が必要かどうか */
+  bool lowerDirty = false;
+  /** @brief 展開範囲 */
+  int8_t min_x, min_y, max_x, max_y;
+
+  /**
+   * @brief 直進のコストを返す関数
+   */
+  step_t getEdgeStep(const int i) const { return simple ? i : stepTable[i]; }
+  /**
+   * @brief 迷路から展開範囲を求める。変化したら true を返す
+   */
+  bool updateRange(const Maze& maze);
+  /**
+   * @brief 指定したチャンネルのステップを初期化して、ゴールをキューに追加
+   */
+  void seed(const Channel ch);
+  /**
+   * @brief キューが空になるまでステップを展開する
+   */
+  void flood(const Maze& maze);
+  /**
+   * @brief 壁を横切る直線が下限の最短経路木の辺になり得るか
+   */
+  bool isTightWall(const WallIndex& i) const;
+  /**
+   * @brief 壁を通る直線上の区画を上限チャンネルの展開の起点に追加する
+   */
+  void pushUpperLine(const WallIndex& i);
+};
+
+}  // namespace MazeLib
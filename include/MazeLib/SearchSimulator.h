@@ -0,0 +1,170 @@
+/**
+ * @file SearchSimulator.h
+ * @brief 正解の迷路を用いて探索走行を模擬するクラスを定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-12
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include <algorithm>  //< for std::find
+#include <random>     //< for std::mt19937
+
+#include "MazeLib/ExplorationPlanner.h"
+#include "MazeLib/OptimalityCertificate.h"
+#include "MazeLib/StepMap.h"
+#include "MazeLib/StepMapCache.h"
+
+namespace MazeLib {
+
+/**
+ * @brief 正解の迷路を用いて探索走行を模擬するクラス
+ * @details
+ * 探索走行の例 (examples/search) と同じ手順で、ゴールへの探索、最短経路を
+ * 見つける追加探索、スタートへの帰還を行い、最後に最短経路を導出する。
+ * 壁の確認は正解の迷路を参照する。表示は行わないので、多数の迷路を並列に
+ * 評価するツールなどから利用できる。スレッド間で共有しない限り、
+ * 各インスタンスは独立に使用できる。
+ * 探索走行の方針 (Strategy) を変えて、探索手法どうしを比較することもできる。
+ * 壁の読み違いや位置ずれ (Noise) を加えると、Maze::updateWall() の矛盾検出に
+ * よる復帰を含めた探索走行を模擬できる。壁がないと思った方向に壁があった
+ * 場合は、その壁に当たって壁ありを確認したものとして移動を中断する。
+ * 読み違えた壁で経路が見つからなくなったら Maze::resetLastWalls() で
+ * 直近の壁情報を捨てて探索を続ける。
+ */
+class SearchSimulator {
+ public:
+  using step_t = StepMap::step_t; /**< @brief ステップの型 */
+  /** @brief 経路が見つからないときに捨てる直近の壁情報の数の単位 */
+  static constexpr int RESET_WALLS_ON_DEADLOCK = 12;
+  /**
+   * @brief 探索走行の結果
+   */
+  struct Result {
+    bool success = false; /**< @brief 探索と最短経路の導出に成功したか */
+    int moves = 0;        /**< @brief 探索走行で移動した区画数 */
+    int recomputes = 0;   /**< @brief 探索走行中の経路導出の回数 */
+    Directions shortestDirections; /**< @brief 探索後の最短経路 */
+    step_t shortestCost = StepMap::STEP_MAX; /**< @brief 最短経路のコスト */
+    int misreads = 0;   /**< @brief 壁を読み違えた回数 */
+    int slips = 0;      /**< @brief 位置ずれで隣接区画の壁を読んだ回数 */
+    int collisions = 0; /**< @brief 壁がないと思って壁に当たった回数 */
+    int resets = 0; /**< @brief 閉じ込められて直近の壁情報を捨てた回数 */
+  };
+  /**
+   * @brief 探索走行の方針
+   * @details 既定値は examples/search と同じ方針
+   */
+  struct Strategy {
+    /** @brief 未知区画に到達したときの進行方向の候補の並べ替えの方針 */
+    StepMap::CandidateOrder candidateOrder = StepMap::StraightFirst;
+    /** @brief 探索中の経路導出で台形加速を考慮しない */
+    bool simple = true;
+    /** @brief スタートへの帰還で既知壁のみを使用する */
+    bool knownOnly = true;
+  };
+  /**
+   * @brief 壁の確認に加える雑音
+   * @details 既定値は雑音なし
+   */
+  struct Noise {
+    float misread = 0; /**< @brief 壁1枚を読み違える確率 */
+    float slip = 0; /**< @brief 位置ずれで前後の区画の壁を読んでしまう確率 */
+    uint32_t seed = 0; /**< @brief 乱数の種。run() のたびに初期化する */
+  };
+
+ public:
+  /**
+   * @brief デフォルトコンストラクタ
+   */
+  SearchSimulator() {}
+  /**
+   * @brief コンストラクタ
+   * @param[in] strategy 探索走行の方針
+   */
+  explicit SearchSimulator(const Strategy& strategy) : strategy(strategy) {}
+
+ public:
+  /**
+   * @brief 探索走行を模擬する
+   * @param[in] mazeTarget 正解の迷路。スタートとゴールも参照する
+   * @return 探索走行の結果
+   */
+  Result run(const Maze& mazeTarget);
+  /**
+   * @brief 直前の探索走行で得られた迷路を取得する
+   */
+  const Maze& getMaze() const { return maze; }
+  /**
+   * @brief 直前の探索走行で用いたステップマップを取得する
+   */
+  const StepMap& getStepMap() const { return stepMap; }
+  /**
+   * @brief 探索走行の方針を設定する
+   */
+  void setStrategy(const Strategy& strategy) { this->strategy = strategy; }
+  /**
+   * @brief 探索走行の方針を取得する
+   */
+  const Strategy& getStrategy() const { return strategy; }
+  /**
+   * @brief 壁の確認に加える雑音を設定する
+   */
+  void setNoise(const Noise& noise) { this->noise = noise; }
+  /**
+   * @brief 壁の確認に加える雑音を取得する
+   */
+  const Noise& getNoise() const { return noise; }
+
+ protected:
+  Strategy strategy;                 /**< @brief 探索走行の方針 */
+  Noise noise;                       /**< @brief 壁の確認に加える雑音 */
+  std::mt19937 rng;                  /**< @brief 雑音用の乱数生成器 */
+  Maze maze;                         /**< @brief 探索中の迷路 */
+  StepMap stepMap;                   /**< @brief 経路導出用 */
+  StepMapCache cache;                /**< @brief ステップマップの再利用 */
+  ExplorationPlanner planner;        /**< @brief 追加探索の目的地の選択用 */
+  OptimalityCertificate certificate; /**< @brief 最短性の証明用 */
+  const Maze* mazeTarget = nullptr;  /**< @brief 正解の迷路 */
+  Pose pose;                         /**< @brief 現在の位置姿勢 */
+  Result result;                     /**< @brief 探索走行の結果 */
+
+  /**
+   * @brief 現在区画の前と左右の壁を確認して迷路を更新する
+   */
+  void senseWalls();
+  /**
+   * @brief 経路が見つからないときに直近の壁情報を捨てる
+   * @details 捨てる数は閉じ込められた回数に比例して増やす
+   */
+  void resetLastWalls();
+  /**
+   * @brief 移動方向列にしたがって進み、到着した区画ごとに壁を確認する
+   * @param[in] dirs 移動方向列
+   * @param[in] breakUnknown 新たな壁情報を得たら止まる
+   */
+  void move(const Directions& dirs, const bool breakUnknown);
+  /**
+   * @brief 確率 probability で true を返す
+   * @details 確率が 0 のときは乱数を消費しない
+   */
+  bool chance(const float probability) {
+    return probability > 0 &&
+           std::uniform_real_distribution<float>(0, 1)(rng) < probability;
+  }
+  /**
+   * @brief 現在区画がゴール区画かどうか
+   */
+  bool isGoal() const {
+    const auto& goals = maze.getGoals();
+    return std::find(goals.cbegin(), goals.cend(), pose.p) != goals.cend();
+  }
+  /**
+   * @brief 移動区画数と経路導出の回数が上限を超えたか (無限ループ対策)
+   */
+  bool isLimitExceeded() const {
+    return result.moves + result.recomputes > 16 * Position::SIZE;
+  }
+};
+
+}  // namespace MazeLib
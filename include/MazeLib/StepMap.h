@@ -13,6 +13,8 @@
 
 namespace MazeLib {
 
+class MazeRenderer;
+
 /**
  * @brief 区画ベースのステップマップを管理するクラス
  */
@@ -21,6 +23,101 @@ class StepMap {
   using step_t = uint16_t; /**< @brief ステップの型 */
   static constexpr step_t STEP_MAX =
       std::numeric_limits<step_t>::max(); /**< @brief 最大ステップ値 */
+  /**
+   * @brief 経路とその推定コストの組
+   */
+  struct Route {
+    Directions directions; /**< @brief 始点からの方向列 */
+    step_t cost;           /**< @brief 経路の推定コスト */
+  };
+  /**
+   * @brief Route 構造体の動的配列
+   */
+  using Routes = std::vector<Route>;
+  /**
+   * @brief 進行方向の候補 (最大4方向) の固定長配列
+   * @details 動的確保を避けるため、優先順位の高い順に先頭から詰めて格納する
+   */
+  struct Candidates {
+    std::array<Direction, 4> dirs; /**< @brief 方向の配列 */
+    uint8_t count = 0;             /**< @brief 有効な方向の数 */
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    Direction operator[](const size_t i) const { return dirs[i]; }
+    const Direction* begin() const { return dirs.data(); }
+    const Direction* end() const { return dirs.data() + count; }
+    const Direction* cbegin() const { return begin(); }
+    const Direction* cend() const { return end(); }
+  };
+  /**
+   * @brief 進行方向の候補の並べ替えの方針
+   * @details 後の方針ほど前の方針の並べ替えを含む
+   */
+  enum CandidateOrder : uint8_t {
+    CostOnly,      /**< @brief コストの低い順 */
+    UnknownFirst,  /**< @brief 未知壁を含む区画を優先 */
+    StraightFirst, /**< @brief 未知壁優先に加えて直進を優先 (既定) */
+  };
+  /**
+   * @brief ステップを下るときに同じステップの候補が複数ある場合の選び方
+   * @details いずれもステップマップを変えず、経路のコストも変わらない
+   */
+  enum TieBreak : uint8_t {
+    FirstFound,     /**< @brief Along4() の順で最初の候補 (既定) */
+    PreferStraight, /**< @brief 直進を優先 */
+    FewerTurns,     /**< @brief 1本の直線で遠くまで下れる候補を優先 */
+    PreferKnown,    /**< @brief 未知壁を含まない区画を優先 */
+    PreferZigzag,   /**< @brief 直前の曲がる前の方向を優先 (斜め走行向け) */
+  };
+  /**
+   * @brief コストテーブルの元になる台形加速の走行パラメータ
+   * @details
+   * StepMap と ConstexprStepMap のコストテーブル、MotionCompiler の
+   * 所要時間の見積もりの既定値は、すべてこの値から計算する。
+   * 実行時とコンパイル時で結果が一致するよう、平方根も constexpr で求める。
+   */
+  struct TrapezoidProfile {
+    static constexpr float vs = 420.0f;     /**< @brief 基本速度 [mm/s] */
+    static constexpr float am = 4200.0f;    /**< @brief 最大加速度 [mm/s/s] */
+    static constexpr float vm = 1500.0f;    /**< @brief 飽和速度 [mm/s] */
+    static constexpr float seg = 90.0f;     /**< @brief 区画の長さ [mm] */
+    static constexpr float t_turn = 287.0f; /**< @brief 小回り90度 [ms] */
+    /** @brief コストが最大値を超えないようにスケーリングする係数 */
+    static constexpr float scalingFactor = 2;
+
+    /**
+     * @brief constexpr の平方根 (ニュートン法)
+     */
+    static constexpr float sqrt(const float x) {
+      if (x <= 0) return 0;
+      const double v = x;
+      double r = v;
+      for (int i = 0; i < 64; ++i) r = (r + v / r) / 2;
+      return r;
+    }
+    /**
+     * @brief 基本速度で始まり基本速度で終わる直線の所要時間 [ms]
+     * @param i 直線の区画数
+     */
+    static constexpr step_t calcStraightTime(const int i) {
+      const float d = seg * i;  //< i 区画分の走行距離
+      /* グラフの面積から時間を求める */
+      const float d_thr = (vm * vm - vs * vs) / am;  //< 最大速度に達する距離
+      if (d < d_thr)
+        return 2 * (sqrt(vs * vs + am * d) - vs) / am * 1000;  //< 三角加速
+      return (am * d + (vm - vs) * (vm - vs)) / (am * vm) * 1000;  //< 台形加速
+    }
+    /**
+     * @brief コストテーブルの値
+     * @details 1歩目は90度ターンとみなし、スケーリングしたステップを返す
+     * @param i 直線の区画数 (1 以上)
+     */
+    static constexpr step_t calcStep(const int i) {
+      const step_t step = t_turn + calcStraightTime(i - 1);
+      return step / scalingFactor;
+    }
+  };
 
  public:
   /**
@@ -32,7 +129,10 @@ class StepMap {
    * @brief ステップマップを初期化する関数
    * @param[in] step この値で全マップを初期化する
    */
-  void reset(const step_t step = STEP_MAX) { stepMap.fill(step); }
+  void reset(const step_t step = STEP_MAX) {
+    stepMap.fill(step);
+    settledStep = STEP_MAX;
+  }
   /**
    * @brief ステップの取得
    * @details 盤面外なら `STEP_MAX` を返す
@@ -65,13 +165,81 @@ class StepMap {
    * @brief ステップマップの生配列への参照を取得 (読み取り専用)
    */
   const auto& getMapArray() const { return stepMap; }
+  /**
+   * @brief ステップマップの生配列を上書きする
+   * @details 全区画確定したものとして扱う (StepMapCache からの復元用)
+   */
+  void setMapArray(const std::array<step_t, Position::SIZE>& map) {
+    stepMap = map;
+    settledStep = STEP_MAX;
+  }
   /**
    * @brief ステップのスケーリング係数を取得
    * @details ステップにこの数をかけるとミリ秒に変換できる
    */
   const auto getScalingFactor() const { return scalingFactor; }
+  /**
+   * @brief 台形加速を考慮した直線のコストテーブルを取得 (読み取り専用)
+   * @details 添字の区画数だけ直進して1回ターンするときのステップ
+   */
+  const auto& getStepTable() const { return stepTable; }
+  /**
+   * @brief ステップマップが全区画について確定しているかどうか
+   * @details 展開を途中で打ち切った場合 false となる
+   */
+  bool isComplete() const { return settledStep == STEP_MAX; }
+  /**
+   * @brief 確定済みのステップの上限を取得
+   * @details この値以下のステップをもつ区画は確定している。
+   * これより大きい区画のステップは暫定値 (または `STEP_MAX`) である。
+   */
+  step_t getSettledStep() const { return settledStep; }
+  /**
+   * @brief 区画のステップが確定しているかどうか
+   */
+  bool isSettled(const Position p) const { return getStep(p) <= settledStep; }
+  /**
+   * @brief 最短経路導出時の展開打ち切りのマージンを設定
+   * @details calcShortestDirections() は、始点区画のステップが確定してから
+   * このマージン分だけ展開を続けて終了する。
+   * 既定値の `STEP_MAX` では、従来どおり常に全区画を展開する。
+   * 探索走行中の経路導出など、ステップマップ全体を参照しない場合に設定する。
+   */
+  void setEarlyExitMargin(const step_t margin) { earlyExitMargin = margin; }
+  /**
+   * @brief 最短経路導出時の展開打ち切りのマージンを取得
+   */
+  step_t getEarlyExitMargin() const { return earlyExitMargin; }
+  /**
+   * @brief ゴール区画内での減速を考慮するかを設定
+   * @details
+   * 有効にすると、目的地区画の集合をゴール領域とみなし、
+   * 領域に進入するまでの時間を最小化する (台形加速のみ、simple では無視)。
+   * 進入した区画から同じ向きに目的地区画が続く場合、その区画数を減速の余地とし、
+   * 余地に応じて速度を落とさずに進入する直線のコストを用いる。
+   * 導出した方向列の末尾には減速に使う区画が追加され、領域内で停止する。
+   * calcKShortestDirections() では考慮しない。
+   */
+  void setGoalBraking(const bool enabled) { goalBraking = enabled; }
+  /**
+   * @brief ゴール区画内での減速を考慮するかを取得
+   */
+  bool isGoalBraking() const { return goalBraking; }
+  /**
+   * @brief ステップを下るときの同じステップの候補の選び方を設定
+   * @details getStepDownDirections() で、方向ごとに最初に一致した区画
+   * (FewerTurns では最も遠い区画) を候補とし、1回の走査で方針に従って選ぶ。
+   * 優先する性質が同じ候補の間では、直進、Along4() の順で選ぶ。
+   */
+  void setTieBreak(const TieBreak tieBreak) { this->tieBreak = tieBreak; }
+  /**
+   * @brief ステップを下るときの同じステップの候補の選び方を取得
+   */
+  TieBreak getTieBreak() const { return tieBreak; }
   /**
    * @brief ステップの表示
+   * @details 呼ぶたびに MazeRenderer のバッファを確保する。
+   * 繰り返し表示する場合は MazeRenderer を渡す版を使うこと。
    * @param[in] maze 表示する迷路
    * @param[in] p ハイライト区画
    * @param[in] d ハイライト方向
@@ -89,17 +257,101 @@ class StepMap {
   void printFull(const Maze& maze, const Directions& dirs,
                  const Position start = Position(0, 0),
                  std::ostream& os = std::cout) const;
+  /**
+   * @brief 呼び出し側の MazeRenderer を使い回すステップの表示
+   * @details renderer のバッファを再利用するので、2回目以降はメモリの確保が
+   * 発生しない。renderer に設定された経路とハイライトは置き換えられる。
+   * @param[inout] renderer 描画に使う MazeRenderer
+   */
+  void print(MazeRenderer& renderer, const Maze& maze, const Directions& dirs,
+             const Position start = Position(0, 0),
+             std::ostream& os = std::cout) const;
+  void printFull(MazeRenderer& renderer, const Maze& maze,
+                 const Directions& dirs, const Position start = Position(0, 0),
+                 std::ostream& os = std::cout) const;
   /**
    * @brief ステップマップの更新
    * @param[in] maze 更新に使用する迷路情報
    * @param[in] dest ステップを0とする目的地の区画の集合(順不同)
    * @param[in] knownOnly true:未知壁は通過不可能、false:未知壁は通過可能とする
    * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   * @param[in] start 展開を打ち切る基準の始点区画。迷路外なら全区画を展開する
+   * @param[in] margin 始点区画のステップ確定後に展開を続けるステップ数
    */
   void update(const Maze& maze, const Positions& dest, const bool knownOnly,
-              const bool simple);
+              const bool simple, const Position start = Position(-1, -1),
+              const step_t margin = 0);
+  /**
+   * @brief 始点区画に向けてステップマップを部分的に更新する (A*)
+   * @details 始点区画までのマンハッタン距離に相当するコストを
+   * 許容的なヒューリスティックとして展開順を決め、
+   * 始点区画のステップが確定した時点で終了する。
+   * 始点区画に至る最短経路上の区画のステップは正しく求まるが、
+   * それ以外の区画のステップは暫定値 (または `STEP_MAX`) のままとなる。
+   * 途中で終了した場合、確定済みとみなすのは目的地区画のみとなる。
+   * @param[in] maze 更新に使用する迷路情報
+   * @param[in] dest ステップを0とする目的地の区画の集合(順不同)
+   * @param[in] start ステップを確定させたい始点区画
+   * @param[in] knownOnly true:未知壁は通過不可能、false:未知壁は通過可能とする
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   */
+  void updateAstar(const Maze& maze, const Positions& dest,
+                   const Position start, const bool knownOnly,
+                   const bool simple);
+  /**
+   * @brief 現在のステップを初期値として、起点の区画からステップを緩和する
+   * @details
+   * 壁がなくなる (通過可能な壁が増える) 変化のみであれば、その壁をまたぐ
+   * 直線の始点となり得る区画を起点とすることで、update() で全区画を
+   * 計算し直すのと同じ結果となる。
+   * @param[in] maze 使用する迷路
+   * @param[in] seeds 緩和の起点とする区画の集合
+   * @param[in] knownOnly true:未知壁は通過不可能、false:未知壁は通過可能とする
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   * @return 起点とした区画の数 (ステップが `STEP_MAX` の区画は除く)
+   */
+  int relax(const Maze& maze, const Positions& seeds, const bool knownOnly,
+            const bool simple);
+  /**
+   * @brief 区画から4方向の直線で行ける区画のステップを緩和する
+   * @details
+   * ステップマップの展開で共通の処理。壁に当たるまで直進し、途中の区画が
+   * 更新不要でも、より遠くの区画は更新し得るので直線の先まで調べる。
+   * @param[in] maze 使用する迷路
+   * @param[in] focus 起点の区画
+   * @param[in] focusStep 起点の区画のステップ
+   * @param[in] knownOnly 未知壁は壁ありとみなす
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   * @param[in] table 方向 d の直線のコストテーブルを返す関数 table(d)
+   * @param[in] relax 直線上の区画とステップを受け取る関数 relax(p, step)
+   */
+  template <typename Table, typename Relax>
+  static void relaxStraights(const Maze& maze, const Position focus,
+                             const step_t focusStep, const bool knownOnly,
+                             const bool simple, Table table, Relax relax) {
+    for (const auto d : Direction::Along4()) {
+      const auto& t = table(d);
+      /* 直線で行けるところまで更新する */
+      auto next = focus;
+      for (int8_t i = 1;; ++i) {
+        /* 壁あり or 既知壁のみで未知壁 ならば次へ */
+        const auto next_wi = WallIndex(next, d);
+        if (maze.isWall(next_wi) || (knownOnly && !maze.isKnown(next_wi)))
+          break;
+        next = next.next(d);  //< 移動
+        /* 直線加速を考慮したステップを算出 */
+        const int next_step = focusStep + (simple ? i : t[i]);
+        if (next_step >= STEP_MAX) break;
+        relax(next, static_cast<step_t>(next_step));
+      }
+    }
+  }
   /**
    * @brief 与えられた区画間の最短経路を導出する関数
+   * @details setEarlyExitMargin() でマージンを設定した場合は、始点区画の
+   * ステップが確定してからマージン分だけ展開して終了する。
+   * このとき終了後のステップマップは部分的なものとなり得る
+   * (isComplete() で確認)。既定では全区画を展開する。
    * @param[in] maze 使用する迷路
    * @param[in] start 始点区画
    * @param[in] dest 目的地区画の集合(順不同)
@@ -124,6 +376,52 @@ class StepMap {
     return calcShortestDirections(maze, maze.getStart(), maze.getGoals(),
                                   knownOnly, simple);
   }
+  /**
+   * @brief 与えられた区画間の最短経路を A* により導出する関数
+   * @details 1本の経路のみが必要な場合 (スタートへ戻る走行など) に使う。
+   * 全区画を展開しないため、終了後のステップマップは部分的なものとなる。
+   * @param[in] maze 使用する迷路
+   * @param[in] start 始点区画
+   * @param[in] dest 目的地区画の集合(順不同)
+   * @param[in] knownOnly 未知壁は壁ありとみなし、既知壁のみを使用する
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   * @return 始点区画から目的地区画への最短経路の方向列。
+   *         経路がない場合は空配列となる。
+   */
+  Directions calcShortestDirectionsAstar(const Maze& maze,
+                                         const Position start,
+                                         const Positions& dest,
+                                         const bool knownOnly,
+                                         const bool simple);
+  /**
+   * @brief 与えられた区画間の経路をコストの小さい順に最大 k 本導出する関数
+   * @details Yen's algorithm による。
+   * 最初に求めたステップマップを下限コストの目安として使い、
+   * 候補になり得ない分岐点の計算を省略する。
+   * 終了後のステップマップは最短経路を求めたときのものとなる。
+   * @param[in] maze 使用する迷路
+   * @param[in] start 始点区画
+   * @param[in] dest 目的地区画の集合(順不同)
+   * @param[in] k 導出する経路の最大数
+   * @param[in] knownOnly 未知壁は壁ありとみなし、既知壁のみを使用する
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   * @return コストの昇順に並んだ互いに異なる経路の配列。
+   *         経路がない場合は空配列となる。
+   */
+  Routes calcKShortestDirections(const Maze& maze, const Position start,
+                                 const Positions& dest, const int k,
+                                 const bool knownOnly, const bool simple);
+  /**
+   * @brief 方向列の推定コストを算出する関数
+   * @details 同じ方向の連続を1本の直線とみなし、コストテーブルの値を合計する
+   * @param[in] dirs 始点からの方向列
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   * @param[in] brakeCells 末尾の減速に使う区画の数 (setGoalBraking() 参照)。
+   * 最後の直線をこの区画数を残して進入する直線とみなす。
+   * @return 推定コスト。最大値を超える場合は `STEP_MAX`
+   */
+  step_t calcDirectionsCost(const Directions& dirs, const bool simple,
+                            const int brakeCells = 0) const;
   /**
    * @brief ステップマップから次に行くべき方向を計算する関数
    * @param[in] maze 使用する迷路
@@ -152,12 +450,32 @@ class StepMap {
    * @brief 引数区画の周囲の未知壁の確認優先順位を生成する関数
    * @param[in] maze 使用する迷路
    * @param[in] focus 注目する区画の位置姿勢
+   * @param[in] order 並べ替えの方針
    * @return 行くべき方向の優先順位
+   * @details
+   * 方向ごとに (直進でない, 未知壁を含まない, ステップ, 前左右後の順番) を
+   * この優先度で詰めた整数を並べ替えのキーとし、4要素のソーティング
+   * ネットワークで並べ替える。キーはすべて異なるので順序は一意に決まる。
+   */
+  Candidates getNextDirectionCandidates(
+      const Maze& maze, const Pose& focus,
+      const CandidateOrder order = StraightFirst) const;
+  /**
+   * @brief 最短経路の末尾に、ゴール区画内で減速して停止する方向列を追加する
+   * @details setGoalBraking() が無効、または simple のときは何もしない。
+   * 直前の update() のステップマップの目的地区画を使う。
+   * @param[in] maze 使用する迷路
+   * @param[in] end 最短経路の終点 (getStepDownDirections() の出力)
+   * @param[inout] dirs 最短経路の方向列。これ自体に追記される。
+   * @param[in] knownOnly 未知壁は壁ありとみなし、既知壁のみを使用する
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
    */
-  Directions getNextDirectionCandidates(const Maze& maze,
-                                        const Pose& focus) const;
+  void appendGoalBraking(const Maze& maze, const Pose& end, Directions& dirs,
+                         const bool knownOnly, const bool simple) const;
   /**
    * @brief ゴール区画内を行けるところまで直進させる方向列を追加する関数
+   * @details setGoalBraking() を有効にすると経路の導出時に減速の区画が
+   * 追加されるので、この延長は不要となる (斜めの延長が必要な場合を除く)。
    * @param[in] maze 使用する迷路
    * @param[inout] shortestDirections 追記元の方向列。これ自体に追記される。
    * @param[in] knownOnly 未知壁は壁ありとみなし、既知壁のみを使用する
@@ -178,14 +496,73 @@ class StepMap {
   /** @brief コストテーブルのサイズ */
   static constexpr int stepTableSize = MAZE_SIZE;
   /** @brief コストが最大値を超えないようにスケーリングする係数 */
-  static constexpr float scalingFactor = 2;
+  static constexpr float scalingFactor = TrapezoidProfile::scalingFactor;
   /** @brief 台形加速を考慮した移動コストテーブル (壁沿い方向) */
   std::array<step_t, MAZE_SIZE> stepTable;
+  /** @brief 減速の余地として数えるゴール区画の数の上限 + 1 */
+  static constexpr int goalRoomSize = 4;
+  /**
+   * @brief ゴール領域に進入する直線のコストテーブル
+   * @details [減速の余地の区画数][直線の区画数]。[0] は stepTable と同じ
+   */
+  std::array<std::array<step_t, MAZE_SIZE>, goalRoomSize> goalStepTable;
+  /** @brief ゴール区画内での減速を考慮するか */
+  bool goalBraking = false;
+  /** @brief ステップを下るときの同じステップの候補の選び方 */
+  TieBreak tieBreak = FirstFound;
+  /** @brief 確定済みのステップの上限。全区画確定なら `STEP_MAX` */
+  step_t settledStep = STEP_MAX;
+  /** @brief 最短経路導出時の展開打ち切りのマージン (既定は打ち切らない) */
+  step_t earlyExitMargin = STEP_MAX;
+
+  /**
+   * @brief ステップを展開する範囲
+   * @details 計算を高速化するため、既知壁と目的地の範囲に外周を加えた範囲
+   */
+  struct Range {
+    int8_t min_x, min_y, max_x, max_y;
+
+    bool contains(const Position p) const {
+      return min_x <= p.x && p.x <= max_x && min_y <= p.y && p.y <= max_y;
+    }
+  };
 
   /**
    * @brief 計算の高速化のために予め直進のコストテーブルを計算する関数
    */
   void calcStraightCostTable();
+  /**
+   * @brief 既知壁と区画の集合を含む範囲に、外周を加えた展開範囲を求める
+   */
+  static Range calcRange(const Maze& maze, const Positions& positions);
+  /**
+   * @brief 起点の区画から、優先度付きキューでステップを展開する
+   * @details update(), updateAstar(), relax() で共通の処理
+   * @param[in] seeds 起点の区画の集合。ステップは設定済みとする
+   * @param[in] range 展開範囲
+   * @param[in] key 区画とステップからキューの優先度 (小さいほど先) を返す関数
+   * key(p, step)
+   * @param[in] stop キューの先頭を見て展開を打ち切るなら true を返す関数
+   * stop(step, key)
+   * @param[in] settle 区画のステップが確定するたびに呼ぶ関数 settle(p, step)
+   * @return 起点とした区画の数 (ステップが `STEP_MAX` の区画は除く)
+   */
+  template <typename Key, typename Stop, typename Settle>
+  int flood(const Maze& maze, const Positions& seeds, const bool knownOnly,
+            const bool simple, const Range& range, Key key, Stop stop,
+            Settle settle);
+  /**
+   * @brief 区画間の移動コストの下限を返す関数 (A* のヒューリスティック)
+   * @details 縦横それぞれの距離を1本の直線で移動するとみなしたコスト
+   */
+  step_t calcHeuristicStep(const Position p1, const Position p2,
+                           const bool simple) const;
+  /**
+   * @brief ゴール区画に進入したときの減速の余地を数える関数
+   * @details 区画 p から方向 d に、ステップが0の区画が続く数 (上限あり)
+   */
+  int calcGoalRoom(const Maze& maze, const Position p, const Direction d,
+                   const bool knownOnly) const;
 };
 
 }  // namespace MazeLib
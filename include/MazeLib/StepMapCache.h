@@ -0,0 +1,126 @@
+/**
+ * @file StepMapCache.h
+ * @brief 迷路の状態をキーとしてステップマップを再利用するキャッシュを定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-16
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include "MazeLib/StepMap.h"
+
+namespace MazeLib {
+
+/**
+ * @brief 迷路の状態をキーとしてステップマップを再利用する LRU キャッシュ
+ * @details
+ * キーは (壁情報の Zobrist ハッシュ, 既知壁の範囲, 目的地の集合, knownOnly,
+ * simple, コストテーブル) であり、同じキーなら StepMap::update() の結果は
+ * 同じになる。新たな壁が見つかっていない間の再計算や、フェーズをまたいだ
+ * 同じ目的地への再計算をキャッシュから復元する。
+ * メモリ使用量が予算を超えないように、最も長く使われていないものから捨てる。
+ * ハッシュの衝突は検出しないが、64ビットなので実用上は問題にならない。
+ */
+class StepMapCache {
+ public:
+  /** @brief 既定のメモリ予算 [byte] */
+  static constexpr size_t DEFAULT_BUDGET = 64 * 1024;
+
+ public:
+  /**
+   * @brief コンストラクタ
+   * @param[in] budget メモリ予算 [byte]。少なくとも1つは保持する
+   */
+  explicit StepMapCache(const size_t budget = DEFAULT_BUDGET);
+  /**
+   * @brief ステップマップを更新する。キャッシュにあれば復元する
+   * @details 引数は StepMap::update() と同じ (全区画を展開する)
+   * @param[out] stepMap 更新するステップマップ
+   * @param[in] maze 使用する迷路
+   * @param[in] dest 目的地区画の集合(順不同)
+   * @param[in] knownOnly 未知壁は壁ありとみなし、既知壁のみを使用する
+   * @param[in] simple 台形加速を考慮せず、隣接区画のコストをすべて1にする
+   * @return キャッシュにあった場合 true
+   */
+  bool update(StepMap& stepMap, const Maze& maze, const Positions& dest,
+              const bool knownOnly, const bool simple);
+  /**
+   * @brief 与えられた区画間の最短経路を導出する
+   * @details StepMap::calcShortestDirections() と同じ経路を返す。
+   * ステップマップは全区画を展開したものとなる。
+   */
+  Directions calcShortestDirections(StepMap& stepMap, const Maze& maze,
+                                    const Position start,
+                                    const Positions& dest,
+                                    const bool knownOnly, const bool simple);
+  /**
+   * @brief スタートからゴールまでの最短経路を導出する
+   */
+  Directions calcShortestDirections(StepMap& stepMap, const Maze& maze,
+                                    const bool knownOnly, const bool simple) {
+    return calcShortestDirections(stepMap, maze, maze.getStart(),
+                                  maze.getGoals(), knownOnly, simple);
+  }
+  /**
+   * @brief キャッシュを空にする
+   */
+  void clear();
+  /** @brief 保持しているステップマップの数 */
+  size_t size() const { return entries.size(); }
+  /** @brief 保持できるステップマップの数 */
+  size_t getCapacity() const { return capacity; }
+  /** @brief キャッシュにあった回数 */
+  int getHits() const { return hits; }
+  /** @brief キャッシュになかった回数 */
+  int getMisses() const { return misses; }
+
+ protected:
+  /**
+   * @brief キャッシュのキー
+   */
+  struct Key {
+    uint64_t maze;    /**< @brief 壁情報の Zobrist ハッシュ */
+    uint64_t dest;    /**< @brief 目的地の集合のハッシュ (順不同) */
+    uint64_t option;  /**< @brief 既知壁の範囲、knownOnly, simple, 減速 */
+    uint32_t profile; /**< @brief コストテーブルのハッシュ */
+
+    bool operator==(const Key& k) const {
+      return maze == k.maze && dest == k.dest && option == k.option &&
+             profile == k.profile;
+    }
+  };
+  /**
+   * @brief キーのハッシュ関数
+   */
+  struct KeyHash {
+    size_t operator()(const Key& k) const {
+      return k.maze ^ (k.dest * 31) ^ (k.option * 131) ^ k.profile;
+    }
+  };
+  /**
+   * @brief キャッシュの要素
+   */
+  struct Entry {
+    Key key;                                        /**< @brief キー */
+    std::array<StepMap::step_t, Position::SIZE> map; /**< @brief ステップ */
+  };
+  using Entries = std::list<Entry>; /**< @brief 新しく使った順の要素 */
+
+  size_t capacity; /**< @brief 保持できる要素数 */
+  Entries entries; /**< @brief 要素の実体。先頭が最近使ったもの */
+  std::unordered_map<Key, Entries::iterator, KeyHash> index; /**< @brief 索引 */
+  int hits = 0;   /**< @brief キャッシュにあった回数 */
+  int misses = 0; /**< @brief キャッシュになかった回数 */
+
+  /**
+   * @brief キーを生成する
+   */
+  static Key makeKey(const StepMap& stepMap, const Maze& maze,
+                     const Positions& dest, const bool knownOnly,
+                     const bool simple);
+};
+
+}  // namespace MazeLib
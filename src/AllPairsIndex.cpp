@@ -0,0 +1,101 @@
+/**
+ * @file AllPairsIndex.cpp
+ * @brief 既知の迷路の全区画間の最短経路を引くための索引
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-24
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include "MazeLib/AllPairsIndex.h"
+
+#include <algorithm>  //< for std::copy
+#include <utility>    //< for std::move
+
+namespace MazeLib {
+
+/** @brief 保存形式の識別子 */
+static constexpr uint32_t MAGIC = 0x50414c4d;  //< "MLAP"
+
+/** @brief 保存形式の先頭 */
+struct Header {
+  uint32_t magic;    /**< @brief 識別子 */
+  uint8_t mazeSize;  /**< @brief MAZE_SIZE */
+  uint8_t simple;    /**< @brief 隣接区画のコストを1にしたか */
+  uint16_t reserved; /**< @brief 予約 */
+  uint64_t hash;     /**< @brief 迷路の壁情報のハッシュ */
+};
+
+void AllPairsIndex::build(const Maze& maze, const bool simple) {
+  this->simple = simple;
+  hash = maze.getHash();
+  StepMap stepMap;
+  stepTable = stepMap.getStepTable();
+  /* 既知壁のみで通過可能な方向 */
+  for (int i = 0; i < Position::SIZE; ++i) {
+    const auto p = Position::getPositionFromIndex(i);
+    open[i] = 0;
+    for (const auto d : Direction::Along4()) {
+      const auto wi = WallIndex(p, d);
+      if (wi.isInsideOfField() && maze.canGo(wi)) open[i] |= 1 << (d >> 1);
+    }
+  }
+  /* 全区画を目的地としたステップマップを並べる */
+  steps.resize(Position::SIZE * Position::SIZE);
+  for (int t = 0; t < Position::SIZE; ++t) {
+    stepMap.update(maze, {Position::getPositionFromIndex(t)}, true, simple);
+    const auto& map = stepMap.getMapArray();
+    std::copy(map.begin(), map.end(), steps.begin() + t * Position::SIZE);
+  }
+}
+Directions AllPairsIndex::calcShortestDirections(const Position from,
+                                                 const Position to) const {
+  if (getStep(from, to) == StepMap::STEP_MAX) return {};
+  const auto* row = &steps[to.getIndex() * Position::SIZE];
+  /* ステップを下る */
+  Directions dirs;
+  for (auto focus = from; focus != to;) {
+    const auto focus_step = row[focus.getIndex()];
+    auto next_p = focus;
+    for (const auto d : Direction::Along4()) {
+      auto next = focus;
+      for (int i = 1; next_p == focus && open[next.getIndex()] >> (d >> 1) & 1;
+           ++i) {
+        next = next.next(d);
+        if (row[next.getIndex()] + (simple ? i : stepTable[i]) == focus_step) {
+          dirs.insert(dirs.end(), i, d);
+          next_p = next;
+        }
+      }
+    }
+    if (next_p == focus) return {};  //< なんかおかしい
+    focus = next_p;
+  }
+  return dirs;
+}
+bool AllPairsIndex::save(std::ostream& os) const {
+  if (steps.empty()) return false;
+  const Header header = {MAGIC, MAZE_SIZE, simple, 0, hash};
+  os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  os.write(reinterpret_cast<const char*>(open.data()), sizeof(open));
+  os.write(reinterpret_cast<const char*>(steps.data()),
+           steps.size() * sizeof(step_t));
+  return os.good();
+}
+bool AllPairsIndex::load(std::istream& is, const Maze& maze) {
+  clear();
+  Header header;
+  if (!is.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+  if (header.magic != MAGIC || header.mazeSize != MAZE_SIZE) return false;
+  if (header.hash != maze.getHash()) return false;
+  std::vector<step_t> buffer(Position::SIZE * Position::SIZE);
+  if (!is.read(reinterpret_cast<char*>(open.data()), sizeof(open)) ||
+      !is.read(reinterpret_cast<char*>(buffer.data()),
+               buffer.size() * sizeof(step_t)))
+    return false;
+  simple = header.simple;
+  hash = header.hash;
+  stepTable = StepMap().getStepTable();
+  steps = std::move(buffer);
+  return true;
+}
+
+}  // namespace MazeLib
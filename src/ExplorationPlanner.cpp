@@ -0,0 +1,70 @@
+/**
+ * @file ExplorationPlanner.cpp
+ * @brief 最短経路の改善効果にもとづく探索目的地の選択を行うクラス
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-08
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include "MazeLib/ExplorationPlanner.h"
+
+#include <algorithm>  //< for std::sort, std::max
+
+namespace MazeLib {
+
+const ExplorationPlanner::Candidates& ExplorationPlanner::evaluate(
+    const Maze& maze, const Position current) {
+  candidates.clear();
+  const auto start = maze.getStart();
+  const auto& goals = maze.getGoals();
+  /* 最短経路コストの下限と上限 */
+  stepMapGoal.update(maze, goals, false, false);
+  stepMapKnown.update(maze, goals, true, false);
+  lowerStep = stepMapGoal.getStep(start);
+  upperStep = stepMapKnown.getStep(start);
+  if (lowerStep == StepMap::STEP_MAX) return candidates;  //< 経路なし
+  if (lowerStep >= upperStep) return candidates;  //< 既知の経路が最短
+  /* 既知の経路がない場合は、下限の2倍を上限の目安とする */
+  const int upper = upperStep == StepMap::STEP_MAX
+                        ? std::min<int>(2 * lowerStep, StepMap::STEP_MAX - 1)
+                        : upperStep;
+  /* 区画 p を直進で通り抜ける経路では、2つのステップの和は直線を p で
+   * 2本に分けたコストとなり、直線コストの劣加法性により過大になる。
+   * 分けたことによる増分の最大値を差し引いたものを下限とする */
+  const auto& stepTable = stepMapGoal.getStepTable();
+  int maxSplit = 0;
+  for (int a = 1; a < MAZE_SIZE; ++a)
+    for (int b = 1; a + b < MAZE_SIZE; ++b)
+      maxSplit = std::max(maxSplit, stepTable[a] + stepTable[b] -
+                                        stepTable[a + b]);
+  /* 各区画を通る経路の下限と、現在地からの移動コスト */
+  stepMapStart.update(maze, {start}, false, false);
+  stepMapCurrent.update(maze, {current}, false, true);
+  for (int i = 0; i < Position::SIZE; ++i) {
+    const auto p = Position::getPositionFromIndex(i);
+    if (!p.isInsideOfField()) continue;
+    const auto unknown = maze.unknownCount(p);
+    if (!unknown) continue;
+    const auto cost = stepMapCurrent.getStep(p);
+    const auto fromStart = stepMapStart.getStep(p);
+    const auto toGoal = stepMapGoal.getStep(p);
+    if (cost == StepMap::STEP_MAX || fromStart == StepMap::STEP_MAX ||
+        toGoal == StepMap::STEP_MAX)
+      continue;
+    /* この区画を通る経路が既知の経路より短くなり得るか */
+    const int through =
+        std::max<int>(lowerStep, fromStart + toGoal - maxSplit);
+    if (through >= upper) continue;
+    /* 未知壁が多いほど経路が確定する見込みが大きい */
+    const float gain = float(upper - through) * unknown / 4;
+    candidates.push_back({p, gain, cost, gain / (1 + cost)});
+  }
+  /* スコアの降順 (同点なら近い順) に並べ替え */
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& c1, const Candidate& c2) {
+              return c1.score > c2.score ||
+                     (!(c2.score > c1.score) && c1.cost < c2.cost);
+            });
+  return candidates;
+}
+
+}  // namespace MazeLib
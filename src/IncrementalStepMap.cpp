@@ -0,0 +1,65 @@
+/**
+ * @file IncrementalStepMap.cpp
+ * @brief 壁ログの差分のみでスタートへのステップマップを更新するクラス
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-22
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include "MazeLib/IncrementalStepMap.h"
+
+#include <utility>  //< for std::make_pair
+
+namespace MazeLib {
+
+void IncrementalStepMap::update(const Maze& maze) {
+  const auto& wallRecords = maze.getWallRecords();
+  if (start != maze.getStart() || wallRecords.size() < wallRecordsSize)
+    return rebuild(maze);
+  /* 未反映の壁ログのうち、新たに通過可能となった壁を集める */
+  Positions seeds;
+  for (size_t i = wallRecordsSize; i < wallRecords.size(); ++i) {
+    const auto& wr = wallRecords[i];
+    const auto wi = WallIndex(wr.getPosition(), wr.getDirection());
+    if (!wi.isInsideOfField()) continue;
+    const bool canGo = maze.canGo(wi);
+    if (canGo == open[wi.getIndex()]) continue;
+    /* 通過可能だった壁がなくなるとステップが増え得るので計算し直す */
+    if (!canGo) return rebuild(maze);
+    open[wi.getIndex()] = true;
+    /* 壁をまたぐ直線の始点となり得る区画: 壁の両側から同じ列を遠ざかる */
+    const auto p = wi.getPosition();
+    const auto d = wi.getDirection();
+    for (auto [q, dir] : {std::make_pair(p, Direction(d + Direction::Back)),
+                          std::make_pair(p.next(d), d)}) {
+      seeds.push_back(q);
+      while (maze.canGo(WallIndex(q, dir))) seeds.push_back(q = q.next(dir));
+    }
+  }
+  wallRecordsSize = wallRecords.size();
+  /* StepMap::update() と同じ展開を、現在のステップを初期値として行う */
+  if (!seeds.empty()) relaxedSeeds += stepMap.relax(maze, seeds, true, simple);
+}
+Directions IncrementalStepMap::calcShortestDirections(const Maze& maze,
+                                                      const Position p) {
+  update(maze);
+  if (!p.isInsideOfField()) return {};
+  Pose end;
+  const auto dirs = stepMap.getStepDownDirections(
+      maze, {p, Direction::Max}, end, true, simple, false);
+  /* スタート判定 */
+  return stepMap.getStep(end.p) == 0 ? dirs : Directions{};
+}
+void IncrementalStepMap::rebuild(const Maze& maze) {
+  ++rebuilds;
+  start = maze.getStart();
+  wallRecordsSize = maze.getWallRecords().size();
+  stepMap.update(maze, {start}, true, simple);
+  /* 既知壁のみで通過可能な壁を記録 */
+  open.reset();
+  for (int i = 0; i < WallIndex::SIZE; ++i) {
+    const auto wi = WallIndex(static_cast<uint16_t>(i));
+    if (wi.isInsideOfField() && maze.canGo(wi)) open[i] = true;
+  }
+}
+
+}  // namespace MazeLib
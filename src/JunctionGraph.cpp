@@ -0,0 +1,255 @@
+/**
+ * @file JunctionGraph.cpp
+ * @brief 通路を縮約した分岐点のグラフによる最短経路の導出
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-23
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include "MazeLib/JunctionGraph.h"
+
+#include <queue>
+
+namespace MazeLib {
+
+/** @brief 通過可能な方向のビット列 */
+static uint8_t calcOpen(const Maze& maze, const Position p,
+                        const bool knownOnly) {
+  uint8_t bits = 0;
+  for (const auto d : Direction::Along4()) {
+    const auto i = WallIndex(p, d);
+    if (i.isInsideOfField() && maze.canGo(i, knownOnly)) bits |= 1 << (d >> 1);
+  }
+  return bits;
+}
+
+JunctionGraph::JunctionGraph(const bool knownOnly, const bool simple)
+    : knownOnly(knownOnly), simple(simple) {
+  stepTable = StepMap().getStepTable();
+  open.fill(0);
+  shortcuts.fill(Position(-1, -1));
+  shortcutCosts.fill(0);
+  steps.fill(StepMap::STEP_MAX);
+}
+void JunctionGraph::update(const Maze& maze) {
+  const auto& wallRecords = maze.getWallRecords();
+  if (start != maze.getStart() || goals != maze.getGoals() ||
+      wallRecords.size() < wallRecordsSize)
+    return rebuild(maze);
+  /* 未反映の壁をすべて通過可能な方向に反映してから分類し直す */
+  Positions changed;
+  for (size_t i = wallRecordsSize; i < wallRecords.size(); ++i) {
+    const auto& wr = wallRecords[i];
+    updateWall(maze, WallIndex(wr.getPosition(), wr.getDirection()), changed);
+  }
+  wallRecordsSize = wallRecords.size();
+  /* 変化した区画と、そこから直線でつながる区画の分類が変わり得る */
+  Positions dirty = changed;
+  for (const auto p : changed) {
+    for (const auto d : Direction::Along4()) {
+      int length;
+      if (isOpen(p, d)) dirty.push_back(walk(p, d, length));
+    }
+  }
+  for (const auto p : dirty) classify(p);
+}
+Directions JunctionGraph::calcShortestDirections(const Maze& maze) {
+  update(maze);
+  steps.fill(StepMap::STEP_MAX);
+  queuePushes = 0;
+  if (!start.isInsideOfField()) return {};
+  /* ゴールから節点のみを展開する (StepMap::update() と同じ順序) */
+  struct Element {
+    Position p;
+    step_t s;
+    bool operator<(const Element& e) const { return s > e.s; }
+  };
+  std::priority_queue<Element, Vector<Element>> q;
+  const auto relax = [&](const Position p, const int step) {
+    if (step >= steps[p.getIndex()]) return;
+    steps[p.getIndex()] = step;
+    q.push({p, static_cast<step_t>(step)});
+    ++queuePushes;
+  };
+  for (const auto p : goals)
+    if (p.isInsideOfField()) relax(p, 0);
+  while (!q.empty()) {
+    const auto focus = q.top().p;
+    const auto focus_step = q.top().s;
+    q.pop();
+    if (steps[focus.getIndex()] < focus_step) continue;
+    /* スタートが確定したら終了 */
+    if (focus == start) break;
+    /* 直線上のすべての節点を更新する */
+    for (const auto d : Direction::Along4()) {
+      auto next = focus;
+      for (int i = 1; isOpen(next, d); ++i) {
+        next = next.next(d);
+        if (nodes[next.getIndex()]) relax(next, focus_step + getEdgeCost(i));
+      }
+    }
+    /* 曲がり角の連なりの反対の端を更新する */
+    const auto to = shortcuts[focus.getIndex()];
+    if (to.isInsideOfField())
+      relax(to, focus_step + shortcutCosts[focus.getIndex()]);
+  }
+  /* スタートからステップを下り、方向列に戻す */
+  Directions dirs;
+  auto focus = start;
+  while (steps[focus.getIndex()] != 0) {
+    const auto focus_step = steps[focus.getIndex()];
+    if (focus_step == StepMap::STEP_MAX) return {};
+    auto next_p = focus;
+    for (const auto d : Direction::Along4()) {
+      auto next = focus;
+      for (int i = 1; next_p == focus && isOpen(next, d); ++i) {
+        next = next.next(d);
+        if (nodes[next.getIndex()] &&
+            steps[next.getIndex()] + getEdgeCost(i) == focus_step) {
+          dirs.insert(dirs.end(), i, d);
+          next_p = next;
+        }
+      }
+    }
+    const auto to = shortcuts[focus.getIndex()];
+    if (next_p == focus && to.isInsideOfField() &&
+        steps[to.getIndex()] + shortcutCosts[focus.getIndex()] == focus_step) {
+      walkChain(focus, to, &dirs);
+      next_p = to;
+    }
+    if (next_p == focus) return {};  //< なんかおかしい
+    focus = next_p;
+  }
+  return dirs;
+}
+void JunctionGraph::rebuild(const Maze& maze) {
+  ++rebuilds;
+  start = maze.getStart();
+  goals = maze.getGoals();
+  wallRecordsSize = maze.getWallRecords().size();
+  fixed.reset();
+  if (start.isInsideOfField()) fixed[start.getIndex()] = true;
+  for (const auto p : goals)
+    if (p.isInsideOfField()) fixed[p.getIndex()] = true;
+  for (int i = 0; i < Position::SIZE; ++i)
+    open[i] = calcOpen(maze, Position::getPositionFromIndex(i), knownOnly);
+  /* 全区画を分類する。曲がり角の連なりは1回だけ作る */
+  std::bitset<Position::SIZE> visited;
+  for (int i = 0; i < Position::SIZE; ++i) {
+    if (visited[i]) continue;
+    const auto p = Position::getPositionFromIndex(i);
+    if (!isCorner(p)) {
+      classify(p);
+      continue;
+    }
+    for (const auto c : rechain(p)) visited[c.getIndex()] = true;
+  }
+}
+void JunctionGraph::updateWall(const Maze& maze, const WallIndex i,
+                               Positions& changed) {
+  if (!i.isInsideOfField()) return;
+  const auto a = i.getPosition();
+  for (const auto p : {a, a.next(i.getDirection())}) {
+    const auto bits = calcOpen(maze, p, knownOnly);
+    if (open[p.getIndex()] == bits) continue;
+    open[p.getIndex()] = bits;
+    changed.push_back(p);
+  }
+}
+void JunctionGraph::classify(const Position p) {
+  if (isCorner(p)) {
+    rechain(p);
+    return;
+  }
+  nodes[p.getIndex()] = !isStraight(p);
+  shortcuts[p.getIndex()] = Position(-1, -1);
+}
+Positions JunctionGraph::rechain(const Position p) {
+  /* 直線でつながる曲がり角を両方向にたどる */
+  Positions chain = {p};
+  bool cycle = false;
+  for (int side = 0; side < 2 && !cycle; ++side) {
+    /* 区画 p の通過可能な方向のうち side 番目 */
+    auto d = Direction::Max;
+    int count = 0;
+    for (const auto dir : Direction::Along4())
+      if (isOpen(p, dir) && count++ == side) d = dir;
+    for (auto focus = p;;) {
+      int length;
+      const auto next = walk(focus, d, length);
+      if (!isCorner(next)) break;
+      if (next == p) {
+        cycle = true;  //< 分岐点につながらない周回路
+        break;
+      }
+      if (side == 0)
+        chain.push_back(next);
+      else
+        chain.insert(chain.begin(), next);
+      d = turnCorner(next, d);
+      focus = next;
+    }
+  }
+  for (const auto c : chain) {
+    nodes[c.getIndex()] = false;
+    shortcuts[c.getIndex()] = Position(-1, -1);
+  }
+  if (cycle) return chain;
+  /* 両端を節点とし、3つ以上の連なりは両端を固定コストの辺で結ぶ */
+  const auto front = chain.front();
+  const auto back = chain.back();
+  nodes[front.getIndex()] = nodes[back.getIndex()] = true;
+  if (chain.size() < 3) return chain;
+  const auto cost = walkChain(front, back, nullptr);
+  shortcuts[front.getIndex()] = back;
+  shortcuts[back.getIndex()] = front;
+  shortcutCosts[front.getIndex()] = shortcutCosts[back.getIndex()] = cost;
+  return chain;
+}
+bool JunctionGraph::isStraight(const Position p) const {
+  const auto bits = open[p.getIndex()];
+  return !fixed[p.getIndex()] && (bits == 0b0101 || bits == 0b1010);
+}
+bool JunctionGraph::isCorner(const Position p) const {
+  const auto bits = open[p.getIndex()];
+  return !fixed[p.getIndex()] &&
+         (bits == 0b0011 || bits == 0b0110 || bits == 0b1100 || bits == 0b1001);
+}
+Direction JunctionGraph::turnCorner(const Position p,
+                                    const Direction d) const {
+  /* 曲がり角の入ってきた方向でない方へ進む */
+  const auto back = Direction(d + Direction::Back);
+  for (const auto dir : Direction::Along4())
+    if (isOpen(p, dir) && dir != back) return dir;
+  return back;
+}
+Position JunctionGraph::walk(Position p, const Direction d,
+                             int& length) const {
+  length = 0;
+  do {
+    p = p.next(d);
+    ++length;
+  } while (isStraight(p));
+  return p;
+}
+JunctionGraph::step_t JunctionGraph::walkChain(const Position from,
+                                               const Position to,
+                                               Directions* dirs) const {
+  /* 端の曲がり角から、連なりの側 (曲がり角に着く方向) へ進む */
+  auto d = Direction::Max;
+  for (const auto dir : Direction::Along4()) {
+    int length;
+    if (isOpen(from, dir) && isCorner(walk(from, dir, length))) d = dir;
+  }
+  int cost = 0;
+  for (auto focus = from; focus != to;) {
+    int length;
+    const auto next = walk(focus, d, length);
+    cost += getEdgeCost(length);
+    if (dirs) dirs->insert(dirs->end(), length, d);
+    d = turnCorner(next, d);
+    focus = next;
+  }
+  return std::min<int>(cost, StepMap::STEP_MAX);
+}
+
+}  // namespace MazeLib
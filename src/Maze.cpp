@@ -7,9 +7,12 @@
  */
 #include "MazeLib/Maze.h"
 
-#include <algorithm>  //< for std::find, std::count_if
+#include <algorithm>  //< for std::count_if
+#include <cctype>     //< for std::isspace
 #include <iomanip>    //< for std::setw
 
+#include "MazeLib/MazeRenderer.h"
+
 namespace MazeLib {
 
 /* Direction */
@@ -105,9 +108,28 @@ std::ostream& operator<<(std::ostream& os, const WallRecord& obj) {
 }
 
 /* Maze */
+#if MAZE_CELL_STORAGE
+/** @brief 4bit の中の1の数 */
+static int8_t nibbleCount(const uint8_t nibble) {
+  constexpr int8_t table[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+  return table[nibble & 0x0f];
+}
+#endif
 void Maze::reset(const bool set_start_wall, const bool set_range_full) {
+#if MAZE_CELL_STORAGE
+  /* 外周の壁は既知の壁とする (ハッシュには含めない) */
+  cells.fill(0);
+  for (int8_t i = 0; i < MAZE_SIZE; ++i) {
+    cells[Position(MAZE_SIZE - 1, i).getIndex()] |= 0x11;  //< East
+    cells[Position(i, MAZE_SIZE - 1).getIndex()] |= 0x22;  //< North
+    cells[Position(0, i).getIndex()] |= 0x44;              //< West
+    cells[Position(i, 0).getIndex()] |= 0x88;              //< South
+  }
+#else
   wall.reset();
   known.reset();
+#endif
+  hash = 0;
   min_x = min_y = set_range_full ? 0 : (MAZE_SIZE - 1);
   max_x = max_y = set_range_full ? (MAZE_SIZE - 1) : 0;
   wallRecordsBackupCounter = 0;
@@ -117,12 +139,30 @@ void Maze::reset(const bool set_start_wall, const bool set_range_full) {
   }
   wallRecords.clear();
 }
+uint64_t Maze::calcHash() const {
+  uint64_t result = 0;
+  for (int i = 0; i < WallIndex::SIZE; ++i) {
+    const auto wi = WallIndex(static_cast<uint16_t>(i));
+    if (!wi.isInsideOfField()) continue;
+    if (isWall(wi)) result ^= getZobristKey(i, false);
+    if (isKnown(wi)) result ^= getZobristKey(i, true);
+  }
+  return result;
+}
 int8_t Maze::wallCount(const Position p) const {
+#if MAZE_CELL_STORAGE
+  /* 下位4bitの数 */
+  if (p.isInsideOfField()) return nibbleCount(cells[p.getIndex()] & 0x0f);
+#endif
   const auto dirs = Direction::Along4();
   return std::count_if(dirs.cbegin(), dirs.cend(),
                        [&](const Direction d) { return isWall(p, d); });
 }
 int8_t Maze::unknownCount(const Position p) const {
+#if MAZE_CELL_STORAGE
+  /* 上位4bitのうち 0 の数 */
+  if (p.isInsideOfField()) return 4 - nibbleCount(cells[p.getIndex()] >> 4);
+#endif
   const auto dirs = Direction::Along4();
   return std::count_if(dirs.cbegin(), dirs.cend(),
                        [&](const Direction d) { return !isKnown(p, d); });
@@ -163,51 +203,76 @@ void Maze::resetLastWalls(const int num, const bool set_start_wall) {
   return;
 }
 bool Maze::parse(std::istream& is) {
-  /* determine the maze size */
-  /* get file size */
-  is.seekg(0, std::ios::end);  //< move the position to end
-  const int file_size = 1 + is.tellg();
-  is.seekg(0, std::ios::beg);  //< restore the position to begin
-  /* estimated (minimum) file size [byte] : F = (4*M + 1 + 1) * (2*M + 1) */
-  /* using quadratic formula, we have: M = (sqrt(2*F) - 2) / 4 */
-  const int mazeSize = (std::sqrt(2 * file_size) - 2) / 4;
-  if (mazeSize < 1) return false;  //< file size error
+  /* 1行ずつ読み、行末の空白と CR を除く (seekg を使わずパイプにも対応) */
+  std::string line;
+  const auto getline = [&]() {
+    if (!std::getline(is, line)) return false;
+    while (!line.empty() && std::isspace(static_cast<uint8_t>(line.back())))
+      line.pop_back();
+    return true;
+  };
+  /* 柱 ('+' または 'o') で始まる上端の行まで読み飛ばす */
+  size_t offset = std::string::npos;
+  while (offset == std::string::npos && getline()) {
+    offset = line.find_first_not_of(" \t");
+    if (offset != std::string::npos && line[offset] != '+' &&
+        line[offset] != 'o')
+      offset = std::string::npos;
+  }
+  if (offset == std::string::npos) return false;  //< no maze in the stream
+  /* 上端の行の幅から迷路の大きさを決める: W = 4 * M + 1 */
+  const int width = line.size() - offset;
+  const int mazeSize = (width - 1) / 4;
+  if (mazeSize < 1 || (width - 1) % 4) return false;  //< broken top line
+  if (mazeSize > MAZE_SIZE) {
+    /* too large for this build: skip the rest of this maze */
+    for (int i = 0; i < 2 * mazeSize && getline(); ++i) continue;
+    return false;
+  }
   /* reset existing maze */
   reset(), goals.clear();
-  char c;  //< temporal variable to use next
-  for (int8_t y = mazeSize; y >= 0; --y) {
-    /* vertical walls and cells */
-    if (y != mazeSize) {
-      is.ignore(10, '|');  //< skip until next '|'
-      for (int8_t x = 0; x < mazeSize; ++x) {
-        is.ignore(1);  //< skip a space
-        c = is.get();
-        if (c == 'S')
-          start = Position(x, y);
-        else if (c == 'G')
-          goals.push_back(Position(x, y));
-        is.ignore(1);  //< skip a space
-        c = is.get();
-        if (c == '|')
-          Maze::updateWall(Position(x, y), Direction::East, true, false);
-        else if (c == ' ')
-          Maze::updateWall(Position(x, y), Direction::East, false, false);
-      }
-    }
-    /* horizontal walls and pillars */
-    for (uint8_t x = 0; x < mazeSize; ++x) {
-      is >> c;  //< skip until next '+' or 'o'
-      std::string s;
-      for (int i = 0; i < 3; ++i) s += static_cast<char>(is.get());
-      if (s == "---")
+  /* 行末より先の文字は空白とみなす */
+  const auto at = [&](const int i) {
+    return offset + i < line.size() ? line[offset + i] : ' ';
+  };
+  /* horizontal walls and pillars */
+  const auto parseHorizontal = [&](const int8_t y) {
+    for (int8_t x = 0; x < mazeSize; ++x) {
+      const char s[3] = {at(4 * x + 1), at(4 * x + 2), at(4 * x + 3)};
+      if (s[0] == '-' && s[1] == '-' && s[2] == '-')
         Maze::updateWall(Position(x, y), Direction::South, true, false);
-      else if (s == "   ")
+      else if (s[0] == ' ' && s[1] == ' ' && s[2] == ' ')
         Maze::updateWall(Position(x, y), Direction::South, false, false);
     }
+  };
+  parseHorizontal(mazeSize);
+  for (int8_t y = mazeSize - 1; y >= 0; --y) {
+    /* vertical walls and cells */
+    if (!getline()) return false;  //< truncated
+    for (int8_t x = 0; x < mazeSize; ++x) {
+      const char c = at(4 * x + 2);
+      if (c == 'S')
+        start = Position(x, y);
+      else if (c == 'G')
+        goals.push_back(Position(x, y));
+      const char w = at(4 * x + 4);
+      if (w == '|')
+        Maze::updateWall(Position(x, y), Direction::East, true, false);
+      else if (w == ' ')
+        Maze::updateWall(Position(x, y), Direction::East, false, false);
+    }
+    if (!getline()) return false;  //< truncated
+    parseHorizontal(y);
   }
   return true;
 }
 bool Maze::parse(const std::vector<std::string>& data, const int mazeSize) {
+  /* 範囲外アクセスの防止 */
+  if (mazeSize < 1 || mazeSize > MAZE_SIZE ||
+      data.size() < static_cast<size_t>(mazeSize))
+    return false;
+  for (int i = 0; i < mazeSize; ++i)
+    if (data[i].size() < static_cast<size_t>(mazeSize)) return false;
   for (const auto xr : {true, false}) {
     for (const auto yr : {false, true}) {
       for (const auto xy : {false, true}) {
@@ -259,132 +324,42 @@ bool Maze::parse(const std::vector<std::string>& data, const int mazeSize) {
   return false;
 }
 void Maze::print(std::ostream& os, const int mazeSize) const {
-  for (int8_t y = mazeSize; y >= 0; --y) {
-    if (y != mazeSize) {
-      os << '|';
-      for (int8_t x = 0; x < mazeSize; ++x) {
-        const auto p = Position(x, y);
-        if (p == start)
-          os << " S ";
-        else if (std::find(goals.cbegin(), goals.cend(), p) != goals.cend())
-          os << " G ";
-        else
-          os << "   ";
-        const auto k = isKnown(x, y, Direction::East);
-        const auto w = isWall(x, y, Direction::East);
-        os << (k ? (w ? '|' : ' ') : '.');
-      }
-      os << std::endl;
-    }
-    for (int8_t x = 0; x < mazeSize; ++x) {
-      const auto k = isKnown(x, y, Direction::South);
-      const auto w = isWall(x, y, Direction::South);
-      os << '+' << (k ? (w ? "---" : "   ") : " . ");
-    }
-    os << '+' << std::endl;
-  }
+  MazeRenderer renderer;
+  print(renderer, os, mazeSize);
 }
 void Maze::print(const Directions& dirs, const Position start, std::ostream& os,
                  const int mazeSize) const {
-  /* preparation */
-  std::vector<Pose> path;
-  path.reserve(dirs.size());
-  {
-    Position p = start;
-    for (const auto d : dirs) path.push_back({p, d}), p = p.next(d);
-  }
-  const auto& maze = *this;
-  /* start to draw maze */
-  for (int8_t y = mazeSize; y >= 0; --y) {
-    if (y != mazeSize) {
-      for (uint8_t x = 0; x <= mazeSize; ++x) {
-        /* Vertical Wall */
-        const auto it =
-            std::find_if(path.cbegin(), path.cend(), [&](const Pose& pose) {
-              return WallIndex(pose.p, pose.d) ==
-                     WallIndex(Position(x, y), Direction::West);
-            });
-        const auto w = maze.isWall(x, y, Direction::West);
-        const auto k = maze.isKnown(x, y, Direction::West);
-        if (it != path.cend())
-          os << C_YE << it->d << C_NO;
-        else
-          os << (k ? (w ? "|" : " ") : (C_RE "." C_NO));
-        /* Breaking Condition */
-        if (x == mazeSize) break;
-        /* Cell */
-        const auto p = Position(x, y);
-        if (p == start)
-          os << C_BL << " S " << C_NO;
-        else if (std::find(goals.cbegin(), goals.cend(), p) != goals.cend())
-          os << C_BL << " G " << C_NO;
-        else
-          os << "   ";
-      }
-      os << std::endl;
-    }
-    for (uint8_t x = 0; x < mazeSize; ++x) {
-      /* Pillar */
-      os << '+';
-      /* Horizontal Wall */
-      const auto it =
-          std::find_if(path.cbegin(), path.cend(), [&](const Pose pose) {
-            return WallIndex(pose.p, pose.d) ==
-                   WallIndex(Position(x, y), Direction::South);
-          });
-      const auto w = maze.isWall(x, y, Direction::South);
-      const auto k = maze.isKnown(x, y, Direction::South);
-      if (it != path.cend())
-        os << C_YE << ' ' << it->d << ' ' << C_NO;
-      else
-        os << (k ? (w ? "---" : "   ") : (C_RE " . " C_NO));
-    }
-    /* Last Pillar */
-    os << '+' << std::endl;
-  }
+  MazeRenderer renderer;
+  print(renderer, dirs, start, os, mazeSize);
 }
 void Maze::print(const Positions& positions, std::ostream& os,
                  const int mazeSize) const {
-  /* preparation */
-  const auto exists = [&](const Position p) {
-    return std::find(positions.cbegin(), positions.cend(), p) !=
-           positions.cend();
-  };
-  const auto& maze = *this;
-  /* start to draw maze */
-  for (int8_t y = mazeSize; y >= 0; --y) {
-    if (y != mazeSize) {
-      for (uint8_t x = 0; x <= mazeSize; ++x) {
-        /* Vertical Wall */
-        const auto w = maze.isWall(x, y, Direction::West);
-        const auto k = maze.isKnown(x, y, Direction::West);
-        os << (k ? (w ? "|" : " ") : (C_RE "." C_NO));
-        /* Breaking Condition */
-        if (x == mazeSize) break;
-        /* Cell */
-        const auto p = Position(x, y);
-        if (p == start)
-          os << C_BL << " S " << C_NO;
-        else if (std::find(goals.cbegin(), goals.cend(), p) != goals.cend())
-          os << C_BL << " G " << C_NO;
-        else if (exists(p))
-          os << C_YE << " X " << C_NO;
-        else
-          os << "   ";
-      }
-      os << std::endl;
-    }
-    for (uint8_t x = 0; x < mazeSize; ++x) {
-      /* Pillar */
-      os << '+';
-      /* Horizontal Wall */
-      const auto w = maze.isWall(x, y, Direction::South);
-      const auto k = maze.isKnown(x, y, Direction::South);
-      os << (k ? (w ? "---" : "   ") : (C_RE " . " C_NO));
-    }
-    /* Last Pillar */
-    os << '+' << std::endl;
-  }
+  MazeRenderer renderer;
+  print(renderer, positions, os, mazeSize);
+}
+void Maze::print(MazeRenderer& renderer, std::ostream& os,
+                 const int mazeSize) const {
+  renderer.clear();
+  renderer.renderMaze(*this, mazeSize);
+  renderer.write(os);
+  os.flush();
+}
+void Maze::print(MazeRenderer& renderer, const Directions& dirs,
+                 const Position start, std::ostream& os,
+                 const int mazeSize) const {
+  renderer.clear();
+  renderer.setPath(dirs, start);
+  renderer.renderMazeColored(*this, mazeSize);
+  renderer.write(os);
+  os.flush();
+}
+void Maze::print(MazeRenderer& renderer, const Positions& positions,
+                 std::ostream& os, const int mazeSize) const {
+  renderer.clear();
+  renderer.setHighlights(positions);
+  renderer.renderMazeColored(*this, mazeSize);
+  renderer.write(os);
+  os.flush();
 }
 bool Maze::backupWallRecordsToFile(const std::string& filepath,
                                    const bool clear) {
@@ -419,17 +394,21 @@ bool Maze::restoreWallRecordsFromFile(const std::string& filepath) {
     MAZE_LOGW << "failed to open file! " << filepath << std::endl;
     return false;
   }
+  return restoreWallRecords(f);
+}
+bool Maze::restoreWallRecords(std::istream& is) {
   reset();
-  while (!f.eof()) {
-    WallRecord wr;
-    f.read(reinterpret_cast<char*>(&wr), sizeof(WallRecord));
-    Position p = Position(wr.x, wr.y);
-    Direction d = Direction(wr.d);
-    bool b = wr.b;
-    updateWall(p, d, b);
+  WallRecord wr;
+  while (is.read(reinterpret_cast<char*>(&wr), sizeof(WallRecord))) {
+    /* 破損した記録があれば、それより前の記録までを復元する */
+    const auto p = wr.getPosition();
+    const auto d = wr.getDirection();
+    if (!p.isInsideOfField() || !d.isAlong()) return false;
+    updateWall(p, d, wr.b);
     wallRecordsBackupCounter++;
   }
-  return true;
+  /* 末尾に半端なバイト列が残っていたら破損とみなす */
+  return is.gcount() == 0;
 }
 
 }  // namespace MazeLib
@@ -0,0 +1,231 @@
+/**
+ * @file MazeBatch.cpp
+ * @brief 多数の迷路に同じ問い合わせをまとめて行うクラス
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-20
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include "MazeLib/MazeBatch.h"
+
+#include <algorithm>  //< for std::min
+
+namespace MazeLib {
+
+/** @brief 隣接区画 (Position::next() のインライン版) */
+static Position neighbor(const Position p, const Direction d) {
+  constexpr int8_t dx[4] = {1, 0, -1, 0};
+  constexpr int8_t dy[4] = {0, 1, 0, -1};
+  return Position(p.x + dx[d >> 1], p.y + dy[d >> 1]);
+}
+
+/** @brief レーンごとのビット (シフトを避けて自動ベクトル化を効かせる) */
+static constexpr std::array<MazeBatch::Mask, MazeBatch::LANES> laneBits = {
+    1 << 0, 1 << 1, 1 << 2,  1 << 3,  1 << 4,  1 << 5,  1 << 6,  1 << 7,
+    1 << 8, 1 << 9, 1 << 10, 1 << 11, 1 << 12, 1 << 13, 1 << 14, 1 << 15,
+};
+
+/** @brief 4方位の隣接区画への通し番号の差 (East, North, West, South) */
+static constexpr std::array<int, 4> shifts = {
+    1 << MAZE_SIZE_BIT, 1, -(1 << MAZE_SIZE_BIT), -1};
+
+/**
+ * @brief レーンごとに dst = min(dst, src + cost) とする
+ * @param reach 緩和するレーン
+ * @return ステップが減ったレーン
+ */
+static MazeBatch::Mask relax(
+    const std::array<StepMap::step_t, MazeBatch::LANES>& src,
+    std::array<StepMap::step_t, MazeBatch::LANES>& dst,
+    const StepMap::step_t cost, const MazeBatch::Mask reach) {
+  /*
+   * レーン方向の単純な繰り返し (自動ベクトル化の対象)。
+   * 符号なしの比較を分岐のない減算で表し、SSE2 などの基本命令でもベクトル化させる。
+   * 完全に展開されるとベクトル化されなくなるので、展開を抑止する。
+   */
+  using step_t = StepMap::step_t;
+  MazeBatch::Mask improved = 0;
+#pragma GCC unroll 1
+  for (int lane = 0; lane < MazeBatch::LANES; ++lane) {
+    const step_t disabled = -step_t((reach & laneBits[lane]) == 0);
+    const step_t step = (src[lane] + cost) | disabled;
+    const step_t diff = (dst[lane] - step) & -step_t(dst[lane] > step);
+    dst[lane] -= diff;
+    improved |= laneBits[lane] & -step_t(diff != 0);
+  }
+  return improved;
+}
+
+size_t MazeBatch::add(const Maze& maze) {
+  const size_t index = size();
+  const int lane = index % LANES;
+  if (lane == 0) {
+    groups.emplace_back();
+    groups.back().wall.fill(~Mask(0));
+    groups.back().known.fill(0);
+  }
+  auto& group = groups.back();
+  const Mask bit = laneBits[lane];
+  for (int8_t z = 0; z < 2; ++z) {
+    for (int8_t y = 0; y < MAZE_SIZE; ++y) {
+      for (int8_t x = 0; x < MAZE_SIZE; ++x) {
+        const auto i = WallIndex(x, y, z);
+        if (!i.isInsideOfField()) continue;
+        const auto index = i.getIndex();
+        if (!maze.isWall(i)) group.wall[index] &= ~bit;
+        if (maze.isKnown(i)) group.known[index] |= bit;
+      }
+    }
+  }
+  starts.push_back(maze.getStart());
+  goals.push_back(maze.getGoals());
+  return index;
+}
+void MazeBatch::clear() {
+  groups.clear();
+  starts.clear();
+  goals.clear();
+}
+void MazeBatch::update(const size_t group, const StepMap& stepMap,
+                       const bool knownOnly, const bool simple) {
+  /* 区画ごと、方向ごとに通過可能なレーンを求めておく */
+  const auto& g = groups[group];
+  for (auto& o : open) o.fill(0);
+  for (int8_t x = 0; x < MAZE_SIZE; ++x) {
+    for (int8_t y = 0; y < MAZE_SIZE; ++y) {
+      const auto p = Position(x, y);
+      for (const auto d : Direction::Along4()) {
+        const auto i = WallIndex(p, d);
+        if (!i.isInsideOfField()) continue;
+        auto& o = open[d >> 1][p.getIndex()];
+        o = ~g.wall[i.getIndex()];
+        if (knownOnly) o &= g.known[i.getIndex()];
+      }
+    }
+  }
+  /* 全区画のステップを最大値とし、目的地のステップを0とする */
+  for (auto& s : steps) s.fill(StepMap::STEP_MAX);
+  std::array<Mask, Position::SIZE> dest{};
+  for (int lane = 0; lane < LANES; ++lane) {
+    const size_t index = group * LANES + lane;
+    if (index >= size()) break;
+    for (const auto p : goals[index]) {
+      if (!p.isInsideOfField()) continue;
+      dest[p.getIndex()] |= laneBits[lane];
+      steps[p.getIndex()][lane] = 0;
+    }
+  }
+  if (simple)
+    updateSimple(dest);
+  else
+    updateWeighted(dest, stepMap);
+}
+void MazeBatch::updateSimple(std::array<Mask, Position::SIZE>& frontier) {
+  std::array<Mask, Position::SIZE> visited = frontier;
+  std::array<Mask, Position::SIZE> next;
+  /* 1回の展開で全レーンの幅優先探索を1段ずつ進める */
+  for (step_t level = 1;; ++level) {
+    next.fill(0);
+    for (int i = 0; i < Position::SIZE; ++i) {
+      if (!frontier[i]) continue;
+      for (int d = 0; d < 4; ++d)
+        if (const Mask m = frontier[i] & open[d][i]) next[i + shifts[d]] |= m;
+    }
+    /* 初めて訪れた区画のみを次の展開対象とする */
+    Mask any = 0;
+    for (int i = 0; i < Position::SIZE; ++i) {
+      const Mask m = next[i] &= ~visited[i];
+      if (!m) continue;
+      visited[i] |= m;
+      any |= m;
+      for (int lane = 0; lane < LANES; ++lane)
+        if (m & laneBits[lane]) steps[i][lane] = level;
+    }
+    if (!any) break;
+    frontier.swap(next);
+  }
+}
+void MazeBatch::updateWeighted(std::array<Mask, Position::SIZE>& dirty,
+                               const StepMap& stepMap) {
+  const auto& table = stepMap.getStepTable();
+  /* ステップが減ったレーンのみを緩和元として、変化がなくなるまで繰り返す */
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (int i = 0; i < Position::SIZE; ++i) {
+      const Mask source = dirty[i];
+      if (!source) continue;
+      dirty[i] = 0;
+      changed = true;
+      const auto src = steps[i];  //< 緩和先と別名にならないよう複製
+      for (int d = 0; d < 4; ++d) {
+        /* 直線で行けるところまで更新する */
+        Mask reach = source;
+        for (int j = i, k = 1; (reach &= open[d][j]); ++k) {
+          j += shifts[d];
+          dirty[j] |= relax(src, steps[j], table[k], reach);
+        }
+      }
+    }
+  }
+}
+Directions MazeBatch::getStepDownDirections(const int lane,
+                                            const Position start,
+                                            const StepMap& stepMap,
+                                            const bool simple) const {
+  const auto& table = stepMap.getStepTable();
+  const Mask bit = laneBits[lane];
+  Directions shortestDirections;
+  auto focus = start;
+  while (1) {
+    const auto focus_step = getStep(lane, focus);
+    if (focus_step == 0) break;
+    /* 直線の先のステップがエッジコスト分だけ小さい最初の方向を選ぶ */
+    auto min_p = focus;
+    auto min_d = Direction::Max;
+    for (const auto d : Direction::Along4()) {
+      auto next = focus;
+      for (int8_t i = 1; open[d >> 1][next.getIndex()] & bit; ++i) {
+        next = neighbor(next, d);
+        const step_t edge_cost = simple ? i : table[i];
+        if (edge_cost > focus_step) break;  //< 桁あふれ防止
+        if (getStep(lane, next) == focus_step - edge_cost) {
+          min_p = next, min_d = d;
+          break;
+        }
+      }
+      if (min_d != Direction::Max) break;
+    }
+    if (focus_step <= getStep(lane, min_p)) break;
+    while (focus != min_p) {
+      focus = neighbor(focus, min_d);
+      shortestDirections.push_back(min_d);
+    }
+  }
+  return shortestDirections;
+}
+StepMap::Routes MazeBatch::calcShortestDirections(const StepMap& stepMap,
+                                                  const bool knownOnly,
+                                                  const bool simple) {
+  StepMap::Routes routes(size());
+  for (size_t group = 0; group < groups.size(); ++group) {
+    update(group, stepMap, knownOnly, simple);
+    for (int lane = 0; lane < LANES; ++lane) {
+      const size_t index = group * LANES + lane;
+      if (index >= size()) break;
+      auto& route = routes[index];
+      route.cost = StepMap::STEP_MAX;
+      const auto start = starts[index];
+      if (!start.isInsideOfField()) continue;
+      route.directions = getStepDownDirections(lane, start, stepMap, simple);
+      /* ゴール判定 */
+      auto end = start;
+      for (const auto d : route.directions) end = neighbor(end, d);
+      if (getStep(lane, end) == 0)
+        route.cost = getStep(lane, start);
+      else
+        route.directions.clear();
+    }
+  }
+  return routes;
+}
+
+}  // namespace MazeLib
@@ -0,0 +1,45 @@
+/**
+ * @file MazeCorpus.cpp
+ * @brief 対称な重複を除いて迷路の集合を管理するクラス
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-17
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include "MazeLib/MazeCorpus.h"
+
+namespace MazeLib {
+
+std::pair<size_t, bool> MazeCorpus::add(const std::string& name,
+                                        const Maze& maze, const int mazeSize) {
+  auto canonical = CanonicalMaze::fromMaze(maze, mazeSize);
+  const auto hash = canonical.hash();
+  const Member member{name, canonical.transform};
+  ++members;
+  const auto i = find(canonical, hash);
+  if (i < entries.size()) {
+    entries[i].members.push_back(member);
+    return {i, false};
+  }
+  /* 正準形の変換は最初に追加した迷路のものとして記録しておく */
+  index.emplace(hash, entries.size());
+  entries.push_back({std::move(canonical), {member}});
+  return {entries.size() - 1, true};
+}
+size_t MazeCorpus::find(const Maze& maze, const int mazeSize) const {
+  const auto canonical = CanonicalMaze::fromMaze(maze, mazeSize);
+  return find(canonical, canonical.hash());
+}
+Maze MazeCorpus::restore(const size_t entry, const size_t member) const {
+  const auto& e = entries[entry];
+  const auto t = e.members[member].transform.inverse();
+  return t.apply(e.canonical.toMaze(), e.canonical.mazeSize);
+}
+size_t MazeCorpus::find(const CanonicalMaze& canonical,
+                        const uint64_t hash) const {
+  const auto range = index.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it)
+    if (entries[it->second].canonical == canonical) return it->second;
+  return entries.size();
+}
+
+}  // namespace MazeLib
@@ -0,0 +1,178 @@
+/**
+ * @file MazeGenerator.cpp
+ * @brief 乱数により迷路を生成するクラス
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-18
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include "MazeLib/MazeGenerator.h"
+
+#include <numeric>  //< for std::iota
+
+namespace MazeLib {
+
+void MazeGenerator::setSeed(const uint64_t seed) {
+  /* splitmix64 で種を拡散し、状態が 0 にならないようにする */
+  uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  state = (z ^ (z >> 31)) | 1;
+}
+bool MazeGenerator::generate(Maze& maze, const Option& option) {
+  const int n = option.mazeSize;
+  if (n < 2 || n > MAZE_SIZE || option.goalSize < 0 || option.goalSize >= n)
+    return false;
+  this->option = option;
+  /* ゴール区画の配置 */
+  goal = option.goal;
+  if (!isInside(goal) || !isInside(goal + Position(option.goalSize - 1,
+                                                   option.goalSize - 1)))
+    goal = Position((n - option.goalSize) / 2, (n - option.goalSize) / 2);
+  if (option.goalSize && isGoal(Position(0, 0))) return false;
+  Positions goals;
+  for (int8_t y = 0; y < option.goalSize; ++y)
+    for (int8_t x = 0; x < option.goalSize; ++x)
+      goals.push_back(goal + Position(x, y));
+  maze.setGoals(goals);
+  maze.setStart(Position(0, 0));
+  /* すべての壁を既知の壁とし、ゴール区画の内部の壁を除く */
+  maze.reset(false, true);
+  for (int8_t y = 0; y < n; ++y) {
+    for (int8_t x = 0; x < n; ++x) {
+      const auto p = Position(x, y);
+      for (const auto d : {Direction::East, Direction::North}) {
+        const auto q = neighbor(p, d);
+        maze.setWall(p, d, !(isGoal(p) && isGoal(q)));
+        maze.setKnown(p, d, true);
+      }
+    }
+  }
+  /* 全域木 */
+  if (option.algorithm == Kruskal)
+    carveKruskal(maze);
+  else
+    carveDepthFirst(maze);
+  /* ループの追加 */
+  addLoops(maze);
+  return true;
+}
+int MazeGenerator::pillarWallCount(const Maze& maze, const Position p) {
+  /* 柱から北、南、東、西に伸びる壁 */
+  return maze.isWall(WallIndex(p.x - 1, p.y, 0)) +
+         maze.isWall(WallIndex(p.x - 1, p.y - 1, 0)) +
+         maze.isWall(WallIndex(p.x, p.y - 1, 1)) +
+         maze.isWall(WallIndex(p.x - 1, p.y - 1, 1));
+}
+bool MazeGenerator::canRemove(const Maze& maze, const Position p,
+                              const Direction d) const {
+  if (isFixed(p, d) || !maze.isWall(p, d)) return false;
+  /* 壁の両端の柱 */
+  const WallIndex i(p, d);
+  const auto p1 = Position(i.x + 1 - i.z, i.y + i.z);
+  const auto p2 = Position(i.x + 1, i.y + 1);
+  for (const auto pillar : {p1, p2})
+    if (!isGoalPillar(pillar) && pillarWallCount(maze, pillar) < 2)
+      return false;
+  return true;
+}
+void MazeGenerator::carveDepthFirst(Maze& maze) {
+  std::bitset<Position::SIZE> visited;
+  auto& stack = work;
+  stack.clear();
+  const auto visit = [&](const Position p) {
+    /* ゴール区画は1つの部屋としてまとめて訪問する */
+    if (!isGoal(p)) {
+      visited[p.getIndex()] = true;
+      stack.push_back(p.getIndex());
+      return;
+    }
+    for (int8_t y = 0; y < option.goalSize; ++y)
+      for (int8_t x = 0; x < option.goalSize; ++x) {
+        const auto g = goal + Position(x, y);
+        visited[g.getIndex()] = true;
+        stack.push_back(g.getIndex());
+      }
+  };
+  visit(Position(0, 0));
+  while (!stack.empty()) {
+    const auto p = Position::getPositionFromIndex(stack.back());
+    Direction candidates[4];
+    int count = 0;
+    for (const auto d : Direction::Along4()) {
+      const auto q = neighbor(p, d);
+      if (!isFixed(p, d) && !visited[q.getIndex()]) candidates[count++] = d;
+    }
+    if (!count) {
+      stack.pop_back();
+      continue;
+    }
+    const auto d = candidates[uniform(count)];
+    maze.setWall(p, d, false);
+    visit(neighbor(p, d));
+  }
+}
+void MazeGenerator::carveKruskal(Maze& maze) {
+  const int n = option.mazeSize;
+  /* 素集合データ構造。ゴール区画は最初から1つにまとめておく */
+  std::array<uint16_t, Position::SIZE> parent;
+  std::iota(parent.begin(), parent.end(), 0);
+  const auto find = [&](uint16_t i) {
+    while (parent[i] != i) i = parent[i] = parent[parent[i]];
+    return i;
+  };
+  for (int8_t y = 0; y < option.goalSize; ++y)
+    for (int8_t x = 0; x < option.goalSize; ++x)
+      parent[(goal + Position(x, y)).getIndex()] = goal.getIndex();
+  /* 除去できる壁を並べて Fisher-Yates で混ぜる */
+  auto& walls = work;
+  walls.clear();
+  for (int8_t y = 0; y < n; ++y)
+    for (int8_t x = 0; x < n; ++x)
+      for (const auto d : {Direction::East, Direction::North})
+        if (!isFixed(Position(x, y), d) && maze.isWall(Position(x, y), d))
+          walls.push_back(WallIndex(Position(x, y), d).getIndex());
+  for (int i = walls.size() - 1; i > 0; --i)
+    std::swap(walls[i], walls[uniform(i + 1)]);
+  for (const auto index : walls) {
+    const WallIndex i(index);
+    const auto a = find(i.getPosition().getIndex());
+    const auto b = find(neighbor(i.getPosition(), i.getDirection()).getIndex());
+    if (a == b) continue;
+    parent[a] = b;
+    maze.setWall(i, false);
+  }
+}
+void MazeGenerator::addLoops(Maze& maze) {
+  const int n = option.mazeSize;
+  /* 行き止まりの除去。隣も行き止まりなら優先してつなぐ */
+  if (option.braid > 0) {
+    for (int8_t y = 0; y < n; ++y) {
+      for (int8_t x = 0; x < n; ++x) {
+        const auto p = Position(x, y);
+        if (p == Position(0, 0) || maze.wallCount(p) != 3) continue;
+        if (!chance(option.braid)) continue;
+        Direction candidates[4];
+        int count = 0;
+        for (const auto d : Direction::Along4()) {
+          if (!canRemove(maze, p, d)) continue;
+          if (maze.wallCount(neighbor(p, d)) == 3) {
+            candidates[0] = d, count = 1;
+            break;
+          }
+          candidates[count++] = d;
+        }
+        if (count) maze.setWall(p, candidates[uniform(count)], false);
+      }
+    }
+  }
+  /* 残った壁の除去 */
+  if (option.loops > 0) {
+    for (int8_t y = 0; y < n; ++y)
+      for (int8_t x = 0; x < n; ++x)
+        for (const auto d : {Direction::East, Direction::North})
+          if (chance(option.loops) && canRemove(maze, Position(x, y), d))
+            maze.setWall(Position(x, y), d, false);
+  }
+}
+
+}  // namespace MazeLib
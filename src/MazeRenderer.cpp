@@ -0,0 +1,228 @@
+/**
+ * @file MazeRenderer.cpp
+ * @brief 迷路とステップマップを文字列として描画するクラス
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-10
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include "MazeLib/MazeRenderer.h"
+
+#include <algorithm>  //< for std::min
+#include <cstdio>     //< for std::snprintf
+
+#include "MazeLib/StepMap.h"
+
+namespace MazeLib {
+
+/* 1区画あたりの描画文字数の上限 (エスケープシーケンスを含む) */
+static constexpr int CELL_LENGTH_MAX = 32;
+
+MazeRenderer::MazeRenderer() {
+  const int lines = 2 * MAZE_SIZE + 1;
+  buffer.reserve(lines * (CELL_LENGTH_MAX * (MAZE_SIZE + 1) + 8));
+  lineEnds.reserve(lines);
+  lineHashes.reserve(lines);
+}
+void MazeRenderer::setPath(const Directions& dirs, const Position start) {
+  pathWalls.reset();
+  auto p = start;
+  for (const auto d : dirs) {
+    const auto i = WallIndex(p, d);
+    /* 同じ壁を複数回通る場合は最初の方向を表示する */
+    if (d.isAlong() && i.isInsideOfField() && !pathWalls[i.getIndex()])
+      pathWalls.set(i.getIndex()), pathDirs[i.getIndex()] = d;
+    p = p.next(d);
+  }
+}
+void MazeRenderer::setHighlights(const Positions& positions) {
+  highlights.reset();
+  for (const auto p : positions)
+    if (p.isInsideOfField()) highlights.set(p.getIndex());
+}
+void MazeRenderer::clear() {
+  pathWalls.reset();
+  highlights.reset();
+}
+void MazeRenderer::renderMaze(const Maze& maze, const int mazeSize) {
+  begin(maze, mazeSize, 4 * mazeSize + 2);
+  const auto start = maze.getStart();
+  for (int8_t y = mazeSize; y >= 0; --y) {
+    if (y != mazeSize) {
+      buffer += '|';
+      for (int8_t x = 0; x < mazeSize; ++x) {
+        const auto p = Position(x, y);
+        if (p == start)
+          buffer += " S ";
+        else if (goals[p.getIndex()])
+          buffer += " G ";
+        else
+          buffer += "   ";
+        const auto k = maze.isKnown(x, y, Direction::East);
+        const auto w = maze.isWall(x, y, Direction::East);
+        buffer += (k ? (w ? '|' : ' ') : '.');
+      }
+      endLine();
+    }
+    for (int8_t x = 0; x < mazeSize; ++x) {
+      const auto k = maze.isKnown(x, y, Direction::South);
+      const auto w = maze.isWall(x, y, Direction::South);
+      buffer += '+';
+      buffer += (k ? (w ? "---" : "   ") : " . ");
+    }
+    buffer += '+';
+    endLine();
+  }
+}
+void MazeRenderer::renderMazeColored(const Maze& maze, const int mazeSize) {
+  begin(maze, mazeSize, CELL_LENGTH_MAX * (mazeSize + 1));
+  const auto start = maze.getStart();
+  Direction d;
+  for (int8_t y = mazeSize; y >= 0; --y) {
+    if (y != mazeSize) {
+      for (int8_t x = 0; x <= mazeSize; ++x) {
+        /* Vertical Wall */
+        const auto w = maze.isWall(x, y, Direction::West);
+        const auto k = maze.isKnown(x, y, Direction::West);
+        if (findPath(WallIndex(Position(x, y), Direction::West), d))
+          ((buffer += C_YE) += d.toChar()) += C_NO;
+        else
+          buffer += (k ? (w ? "|" : " ") : (C_RE "." C_NO));
+        /* Breaking Condition */
+        if (x == mazeSize) break;
+        /* Cell */
+        const auto p = Position(x, y);
+        if (p == start)
+          buffer += C_BL " S " C_NO;
+        else if (goals[p.getIndex()])
+          buffer += C_BL " G " C_NO;
+        else if (highlights[p.getIndex()])
+          buffer += C_YE " X " C_NO;
+        else
+          buffer += "   ";
+      }
+      endLine();
+    }
+    for (int8_t x = 0; x < mazeSize; ++x) {
+      /* Pillar */
+      buffer += '+';
+      /* Horizontal Wall */
+      const auto w = maze.isWall(x, y, Direction::South);
+      const auto k = maze.isKnown(x, y, Direction::South);
+      if (findPath(WallIndex(Position(x, y), Direction::South), d))
+        ((buffer += C_YE " ") += d.toChar()) += " " C_NO;
+      else
+        buffer += (k ? (w ? "---" : "   ") : (C_RE " . " C_NO));
+    }
+    /* Last Pillar */
+    buffer += '+';
+    endLine();
+  }
+}
+void MazeRenderer::renderStepMap(const Maze& maze, const StepMap& stepMap,
+                                 const bool full) {
+  using step_t = StepMap::step_t;
+  const int mazeSize = MAZE_SIZE;
+  begin(maze, mazeSize, CELL_LENGTH_MAX * (mazeSize + 1));
+  /* ステップが3桁に収まらなければスケーリングする */
+  step_t maxStep = 0;
+  for (const auto step : stepMap.getMapArray())
+    if (step != StepMap::STEP_MAX) maxStep = std::max(maxStep, step);
+  const bool simple = (maxStep < 999);
+  const auto& stepTable = stepMap.getStepTable();
+  const step_t scaler =
+      stepTable[stepTable.size() - 1] - stepTable[stepTable.size() - 2];
+  /* 行末の消去は、ステップ数の桁が減ったときの残りを消すため */
+  const char* suffix = full ? "" : "\e[0K";
+  Direction d;
+  for (int8_t y = mazeSize; y >= 0; --y) {
+    /* Vertical Wall Line */
+    if (y != mazeSize) {
+      for (int8_t x = 0; x <= mazeSize; ++x) {
+        /* Vertical Wall */
+        const auto w = maze.isWall(x, y, Direction::West);
+        const auto k = maze.isKnown(x, y, Direction::West);
+        if (findPath(WallIndex(Position(x, y), Direction::West), d))
+          ((buffer += C_YE "\e[1m") += d.toChar()) += C_NO;
+        else
+          buffer += (k ? (w ? "|" : " ") : (C_RE "." C_NO));
+        /* Cell */
+        if (x == mazeSize) break;
+        const auto p = Position(x, y);
+        if (!stepMap.isSettled(p)) {
+          buffer += full ? "     " : "   ";  //< 未確定の区画は表示しない
+          continue;
+        }
+        step_t step = stepMap.getStep(p);
+        if (!full) step = std::min(999, simple ? step : step / scaler);
+        buffer += (step == 0 ? C_YE : C_BL);
+        appendNumber(step, full ? 5 : 3);
+        buffer += C_NO;
+      }
+      endLine(suffix);
+    }
+    /* Horizontal Wall Line */
+    for (int8_t x = 0; x < mazeSize; ++x) {
+      /* Pillar */
+      buffer += '+';
+      /* Horizontal Wall */
+      const auto w = maze.isWall(x, y, Direction::South);
+      const auto k = maze.isKnown(x, y, Direction::South);
+      if (findPath(WallIndex(Position(x, y), Direction::South), d))
+        ((buffer += full ? C_YE "\e[1m  " : C_YE "\e[1m ") += d.toChar()) +=
+            full ? "  " C_NO : " " C_NO;
+      else if (full)
+        buffer += (k ? (w ? "-----" : "     ") : (C_RE "  .  " C_NO));
+      else
+        buffer += (k ? (w ? "---" : "   ") : (C_RE " . " C_NO));
+    }
+    buffer += '+';
+    endLine(suffix);
+  }
+}
+int MazeRenderer::writeChanged(std::ostream& os, const int row) {
+  const int lines = lineEnds.size();
+  /* 行数が変わったらすべての行を出力する */
+  const bool all = static_cast<int>(lineHashes.size()) != lines;
+  if (all) lineHashes.resize(lines);
+  char cursor[16];
+  int count = 0;
+  uint32_t begin = 0;
+  for (int i = 0; i < lines; ++i) {
+    const auto end = lineEnds[i];
+    /* FNV-1a ハッシュで前回の行と比較 */
+    uint32_t hash = 2166136261u;
+    for (auto j = begin; j < end; ++j)
+      hash = (hash ^ static_cast<uint8_t>(buffer[j])) * 16777619u;
+    if (all || hash != lineHashes[i]) {
+      lineHashes[i] = hash;
+      os.write(cursor, std::snprintf(cursor, sizeof(cursor), "\e[%d;1H",
+                                     row + i));
+      os.write(buffer.data() + begin, end - begin);
+      ++count;
+    }
+    begin = end;
+  }
+  os.write(cursor,
+           std::snprintf(cursor, sizeof(cursor), "\e[%d;1H", row + lines));
+  return count;
+}
+void MazeRenderer::begin(const Maze& maze, const int mazeSize,
+                         const int lineLength) {
+  buffer.clear();
+  buffer.reserve((2 * mazeSize + 1) * (lineLength + 8));
+  lineEnds.clear();
+  goals.reset();
+  for (const auto p : maze.getGoals())
+    if (p.isInsideOfField()) goals.set(p.getIndex());
+}
+void MazeRenderer::endLine(const char* suffix) {
+  (buffer += suffix) += '\n';
+  lineEnds.push_back(buffer.size());
+}
+void MazeRenderer::appendNumber(const int value, const int width) {
+  char str[12];
+  const int n = std::snprintf(str, sizeof(str), "%*d", width, value);
+  buffer.append(str, n);
+}
+
+}  // namespace MazeLib
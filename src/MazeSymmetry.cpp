@@ -0,0 +1,199 @@
+/**
+ * @file MazeSymmetry.cpp
+ * @brief 迷路の対称変換と正準形
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-17
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include "MazeLib/MazeSymmetry.h"
+
+#include <algorithm>  //< for std::sort
+
+namespace MazeLib {
+
+/* MazeTransform */
+Position MazeTransform::apply(const Position p, const int mazeSize) const {
+  Position q = isTransposed() ? Position(p.y, p.x) : p;
+  if (isMirroredX()) q.x = mazeSize - 1 - q.x;
+  if (isMirroredY()) q.y = mazeSize - 1 - q.y;
+  return q;
+}
+Direction MazeTransform::apply(const Direction d) const {
+  /* 角度 θ に対して、転置: 90°-θ, x反転: 180°-θ, y反転: -θ */
+  Direction r = isTransposed() ? Direction(Direction::North - d) : d;
+  if (isMirroredX()) r = Direction::West - r;
+  if (isMirroredY()) r = -r;
+  return r;
+}
+Maze MazeTransform::apply(const Maze& maze, const int mazeSize) const {
+  Positions goals;
+  for (const auto p : maze.getGoals()) goals.push_back(apply(p, mazeSize));
+  Maze result(goals, apply(maze.getStart(), mazeSize));
+  MazeBitPlanes::fromMaze(maze, mazeSize)
+      .transformed(*this, mazeSize)
+      .toMaze(result, mazeSize);
+  return result;
+}
+std::ostream& operator<<(std::ostream& os, const MazeTransform t) {
+  return os << (t.isTransposed() ? 'T' : '-') << (t.isMirroredX() ? 'X' : '-')
+            << (t.isMirroredY() ? 'Y' : '-');
+}
+
+/* MazeBitPlanes */
+MazeBitPlanes MazeBitPlanes::fromMaze(const Maze& maze, const int mazeSize) {
+  MazeBitPlanes planes;
+  for (int8_t y = 0; y < mazeSize; ++y) {
+    for (int8_t x = 0; x < mazeSize; ++x) {
+      const Row bit = Row(1) << x;
+      /* 外周の壁は含めない */
+      if (x < mazeSize - 1) {
+        const WallIndex i(x, y, 0);
+        if (maze.isWall(i)) planes.east[y] |= bit;
+        if (maze.isKnown(i)) planes.eastKnown[y] |= bit;
+      }
+      if (y < mazeSize - 1) {
+        const WallIndex i(x, y, 1);
+        if (maze.isWall(i)) planes.north[y] |= bit;
+        if (maze.isKnown(i)) planes.northKnown[y] |= bit;
+      }
+    }
+  }
+  return planes;
+}
+void MazeBitPlanes::toMaze(Maze& maze, const int mazeSize) const {
+  maze.reset(false);
+  for (int8_t y = 0; y < mazeSize; ++y) {
+    for (int8_t x = 0; x < mazeSize; ++x) {
+      const auto p = Position(x, y);
+      const auto load = [&](const Plane& wall, const Plane& known,
+                            const Direction d) {
+        const bool b = (wall[y] >> x) & 1;
+        if ((known[y] >> x) & 1)
+          maze.updateWall(p, d, b, false);
+        else if (b)
+          maze.setWall(p, d, true);
+      };
+      load(east, eastKnown, Direction::East);
+      load(north, northKnown, Direction::North);
+      /* 外周の壁 (MAZE_SIZE の場合は範囲外なので無視される) */
+      if (x == mazeSize - 1) maze.updateWall(p, Direction::East, true, false);
+      if (y == mazeSize - 1) maze.updateWall(p, Direction::North, true, false);
+    }
+  }
+}
+MazeBitPlanes MazeBitPlanes::transformed(const MazeTransform t,
+                                         const int mazeSize) const {
+  MazeBitPlanes r = *this;
+  const int n = mazeSize;
+  /* 転置: East 壁と North 壁が入れ替わる */
+  if (t.isTransposed()) {
+    std::swap(r.east, r.north);
+    std::swap(r.eastKnown, r.northKnown);
+    for (auto* plane : {&r.east, &r.north, &r.eastKnown, &r.northKnown})
+      transpose(*plane);
+  }
+  /* x反転: 区画 x の East 壁は区画 n-2-x の East 壁になる */
+  if (t.isMirroredX()) {
+    for (int y = 0; y < n; ++y) {
+      r.east[y] = reverse(r.east[y], n) >> 1;
+      r.eastKnown[y] = reverse(r.eastKnown[y], n) >> 1;
+      r.north[y] = reverse(r.north[y], n);
+      r.northKnown[y] = reverse(r.northKnown[y], n);
+    }
+  }
+  /* y反転: 行 y の North 壁は行 n-2-y の North 壁になる */
+  if (t.isMirroredY()) {
+    std::reverse(r.east.begin(), r.east.begin() + n);
+    std::reverse(r.eastKnown.begin(), r.eastKnown.begin() + n);
+    std::reverse(r.north.begin(), r.north.begin() + n - 1);
+    std::reverse(r.northKnown.begin(), r.northKnown.begin() + n - 1);
+  }
+  return r;
+}
+uint64_t MazeBitPlanes::hash() const {
+  uint64_t h = 0xcbf29ce484222325ull;
+  for (const auto* plane : {&east, &north, &eastKnown, &northKnown})
+    for (const auto row : *plane) h = (h ^ row) * 0x100000001b3ull;
+  return h ^ (h >> 29);
+}
+void MazeBitPlanes::transpose(Plane& a) {
+  constexpr int N = MAZE_SIZE_MAX;
+  /* 右上と左下のブロックを交換し、ブロックを半分にしていく */
+  Row m = (N == 64) ? ~Row(0) >> 32 : (Row(1) << (N / 2)) - 1;
+  for (int j = N / 2; j; j >>= 1, m ^= m << j) {
+    for (int k = 0; k < N; k = ((k | j) + 1) & ~j) {
+      const Row t = ((a[k] >> j) ^ a[k | j]) & m;
+      a[k] ^= t << j;
+      a[k | j] ^= t;
+    }
+  }
+}
+MazeBitPlanes::Row MazeBitPlanes::reverse(Row r, const int n) {
+  r = ((r >> 1) & 0x5555555555555555ull) | ((r & 0x5555555555555555ull) << 1);
+  r = ((r >> 2) & 0x3333333333333333ull) | ((r & 0x3333333333333333ull) << 2);
+  r = ((r >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((r & 0x0F0F0F0F0F0F0F0Full) << 4);
+  r = ((r >> 8) & 0x00FF00FF00FF00FFull) | ((r & 0x00FF00FF00FF00FFull) << 8);
+  r = ((r >> 16) & 0x0000FFFF0000FFFFull) | ((r & 0x0000FFFF0000FFFFull) << 16);
+  r = (r >> 32) | (r << 32);
+  return r >> (64 - n);
+}
+
+/* CanonicalMaze */
+CanonicalMaze CanonicalMaze::fromMaze(const Maze& maze, const int mazeSize) {
+  const auto planes = MazeBitPlanes::fromMaze(maze, mazeSize);
+  const auto key = [](const Position p) { return p.getIndex(); };
+  CanonicalMaze best;
+  for (uint8_t i = 0; i < MazeTransform::SIZE; ++i) {
+    CanonicalMaze c;
+    c.transform = MazeTransform(i);
+    c.mazeSize = mazeSize;
+    c.planes = planes.transformed(c.transform, mazeSize);
+    c.start = c.transform.apply(maze.getStart(), mazeSize);
+    for (const auto p : maze.getGoals())
+      c.goals.push_back(c.transform.apply(p, mazeSize));
+    std::sort(c.goals.begin(), c.goals.end(),
+              [&](const Position a, const Position b) {
+                return key(a) < key(b);
+              });
+    /* 壁情報、スタート、ゴールの辞書式順序で最小のものを選ぶ */
+    if (i == 0) {
+      best = c;
+      continue;
+    }
+    if (best.planes < c.planes) continue;
+    if (c.planes == best.planes) {
+      if (key(best.start) < key(c.start)) continue;
+      if (c.start == best.start &&
+          !std::lexicographical_compare(
+              c.goals.cbegin(), c.goals.cend(), best.goals.cbegin(),
+              best.goals.cend(), [&](const Position a, const Position b) {
+                return key(a) < key(b);
+              }))
+        continue;
+    }
+    best = c;
+  }
+  return best;
+}
+Maze CanonicalMaze::toMaze() const {
+  Maze maze(goals, start);
+  planes.toMaze(maze, mazeSize);
+  return maze;
+}
+uint64_t CanonicalMaze::hash() const {
+  uint64_t h = planes.hash() ^ (static_cast<uint64_t>(mazeSize) << 48);
+  h = (h ^ start.getIndex()) * 0x100000001b3ull;
+  for (const auto p : goals) h = (h ^ p.getIndex()) * 0x100000001b3ull;
+  return h;
+}
+int CanonicalMaze::estimateMazeSize(const Maze& maze) {
+  int size = 1;
+  for (int i = 0; i < WallIndex::SIZE; ++i) {
+    const WallIndex wi(static_cast<uint16_t>(i));
+    if (wi.isInsideOfField() && maze.isKnown(wi))
+      size = std::max(size, std::max(wi.x, wi.y) + 1);
+  }
+  return size;
+}
+
+}  // namespace MazeLib
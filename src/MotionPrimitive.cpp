@@ -0,0 +1,152 @@
+/**
+ * @file MotionPrimitive.cpp
+ * @brief 移動方向列を走行動作の列に変換するクラス
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-15
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include "MazeLib/MotionPrimitive.h"
+
+#include <cmath>  //< for std::sqrt
+#include <deque>
+
+namespace MazeLib {
+
+std::string MotionPrimitive::toString() const {
+  static constexpr const char* names[TypeMax] = {
+      "S", "D", "S90", "F45", "F90", "F135", "F180", "FV90",
+  };
+  if (type == Straight || type == Diagonal)
+    return names[type] + std::to_string(length);
+  return std::string(names[type]) + (turn == Direction::Left ? "L" : "R");
+}
+std::ostream& operator<<(std::ostream& os, const MotionPrimitives& obj) {
+  for (size_t i = 0; i < obj.size(); ++i) os << (i ? " " : "") << obj[i];
+  return os;
+}
+
+MotionPrimitives MotionCompiler::compile(const Directions& dirs,
+                                         const bool diagEnabled) const {
+  MotionPrimitives motions;
+  if (dirs.empty()) return motions;
+  for (size_t i = 0; i + 1 < dirs.size(); ++i)
+    if (Direction(dirs[i + 1] - dirs[i]) == Direction::Back) return {};
+  /* 斜めなし: 曲がる区画ごとに小回りターン */
+  if (!diagEnabled) {
+    int length = 1;  //< 始点区画の中心から境界まで
+    for (size_t i = 0; i + 1 < dirs.size(); ++i) {
+      if (dirs[i] == dirs[i + 1]) {
+        length += 2;
+        continue;
+      }
+      if (length)
+        motions.push_back(makeStraight(MotionPrimitive::Straight, length));
+      motions.push_back(makeTurn(MotionPrimitive::S90, dirs[i + 1] - dirs[i]));
+      length = 0;
+    }
+    motions.push_back(makeStraight(MotionPrimitive::Straight, length + 1));
+    return motions;
+  }
+  /* 区画の境界の中点を結ぶ線分に分解し、同じ向きの線分をまとめる */
+  struct Run {
+    Direction d; /**< @brief 線分の向き */
+    int length;  /**< @brief 半区画の数 */
+  };
+  std::vector<Run> runs;
+  const auto push = [&](const Direction d, const int length) {
+    if (!runs.empty() && runs.back().d == d)
+      runs.back().length += length;
+    else
+      runs.push_back({d, length});
+  };
+  push(dirs.front(), 1);
+  for (size_t i = 0; i + 1 < dirs.size(); ++i) {
+    if (dirs[i] == dirs[i + 1])
+      push(dirs[i], 2);
+    else if (Direction(dirs[i + 1] - dirs[i]) == Direction::Left)
+      push(dirs[i] + Direction::Left45, 1);
+    else
+      push(dirs[i] + Direction::Right45, 1);
+  }
+  push(dirs.back(), 1);
+  /* 壁沿いの直線に挟まれた斜めの線分の並びをターンにあてはめる */
+  for (size_t i = 0; i < runs.size();) {
+    const auto& along = runs[i];
+    motions.push_back(makeStraight(MotionPrimitive::Straight, along.length));
+    /* 次の壁沿いの直線までの斜めの線分の並び */
+    size_t j = i + 1;
+    while (j < runs.size() && runs[j].d.isDiag()) ++j;
+    if (j == i + 1 || j == runs.size()) break;  //< 終点
+    std::deque<Run> diags(runs.cbegin() + i + 1, runs.cbegin() + j);
+    const auto d_in = along.d;
+    const auto d_out = runs[j].d;
+    if (diags.size() == 1 && diags.front().length == 1) {
+      motions.push_back(makeTurn(MotionPrimitive::F90, d_out - d_in));
+    } else if (diags.size() == 2 && diags.front().length == 1 &&
+               diags.back().length == 1) {
+      motions.push_back(
+          makeTurn(MotionPrimitive::F180, diags.front().d - d_in));
+    } else {
+      /* 斜めに入るターン */
+      if (diags.size() >= 2 && diags.front().length == 1) {
+        diags.pop_front();
+        motions.push_back(
+            makeTurn(MotionPrimitive::F135, diags.front().d - d_in));
+      } else {
+        motions.push_back(
+            makeTurn(MotionPrimitive::F45, diags.front().d - d_in));
+      }
+      /* 斜めから抜けるターン */
+      auto exit = makeTurn(MotionPrimitive::F45, d_out - diags.back().d);
+      if (diags.size() >= 2 && diags.back().length == 1) {
+        diags.pop_back();
+        exit = makeTurn(MotionPrimitive::F135, d_out - diags.back().d);
+      }
+      /* 斜めの直線と V90 ターン */
+      for (size_t k = 0; k < diags.size(); ++k) {
+        if (k)
+          motions.push_back(
+              makeTurn(MotionPrimitive::FV90, diags[k].d - diags[k - 1].d));
+        motions.push_back(
+            makeStraight(MotionPrimitive::Diagonal, diags[k].length));
+      }
+      motions.push_back(exit);
+    }
+    i = j;
+  }
+  return motions;
+}
+float MotionCompiler::calcStraightTime(const float distance) const {
+  /* StepMap のコストテーブルと同じく、グラフの面積から時間を求める */
+  const auto am = parameter.am;
+  const auto vs = parameter.vs;
+  const auto vm = parameter.vm;
+  const auto d_thr = (vm * vm - vs * vs) / am;  //< 最大速度に達する距離
+  if (distance < d_thr)
+    return 2 * (std::sqrt(vs * vs + am * distance) - vs) / am * 1000;
+  return (am * distance + (vm - vs) * (vm - vs)) / (am * vm) * 1000;
+}
+float MotionCompiler::calcTotalTime(const MotionPrimitives& motions) {
+  float sum = 0;
+  for (const auto& m : motions) sum += m.time;
+  return sum;
+}
+MotionPrimitive MotionCompiler::makeStraight(const MotionPrimitive::Type type,
+                                             const int length) const {
+  /* 壁沿いの半区画は seg / 2、斜めの半区画は seg / sqrt(2) */
+  const float unit = type == MotionPrimitive::Straight
+                         ? parameter.seg / 2
+                         : parameter.seg / std::sqrt(2.0f);
+  return {type, Direction::Front, static_cast<uint8_t>(length),
+          calcStraightTime(unit * length)};
+}
+MotionPrimitive MotionCompiler::makeTurn(const MotionPrimitive::Type type,
+                                         const Direction rel) const {
+  /* 相対方向 Left45, Left, Left135 は左、それ以外は右 */
+  const Direction turn =
+      (rel > Direction::Front && rel < Direction::Back) ? Direction::Left
+                                                        : Direction::Right;
+  return {type, turn, 0, parameter.turnTime[type]};
+}
+
+}  // namespace MazeLib
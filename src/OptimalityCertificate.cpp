@@ -0,0 +1,161 @@
+/**
+ * @file OptimalityCertificate.cpp
+ * @brief 既知壁のみの最短経路が最短であることの証明を扱うクラス
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-09
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include "MazeLib/OptimalityCertificate.h"
+
+#include <algorithm>  //< for std::min
+#include <cstdlib>    //< for std::abs
+
+namespace MazeLib {
+
+OptimalityCertificate::OptimalityCertificate(const bool simple)
+    : simple(simple) {
+  stepTable = StepMap().getStepTable();
+  reset();
+}
+void OptimalityCertificate::reset() {
+  for (auto& s : steps) s.fill(STEP_MAX);
+  while (!q.empty()) q.pop();
+  dest.clear();
+  recordCount = -1;
+  recorded.reset();
+  lowerDirty = false;
+  min_x = min_y = max_x = max_y = 0;
+}
+void OptimalityCertificate::update(const Maze& maze) {
+  const auto& records = maze.getWallRecords();
+  const int size = records.size();
+  /* 範囲の拡大、ゴールの変更、壁ログの削除があれば全体を再計算 */
+  bool full = updateRange(maze);
+  full = full || recordCount < 0 || size < recordCount ||
+         dest != maze.getGoals();
+  /* 壁ログの差分を取り込む */
+  for (int n = recordCount; !full && n < size; ++n) {
+    const auto& wr = records[n];
+    const auto i = WallIndex(wr.getPosition(), wr.getDirection());
+    if (!i.isInsideOfField()) continue;  //< 外周は常に壁あり
+    /* 同じ壁の再記録は既知壁との食い違いを含む */
+    if (recorded[i.getIndex()] || !maze.isKnown(i) ||
+        maze.isWall(i) != wr.b) {
+      full = true;
+      break;
+    }
+    recorded.set(i.getIndex());
+    if (!wr.b)
+      pushUpperLine(i);  //< 上限が減る可能性がある
+    else if (!lowerDirty && isTightWall(i))
+      lowerDirty = true;  //< 下限が増える可能性がある
+  }
+  if (full) {
+    while (!q.empty()) q.pop();
+    dest = maze.getGoals();
+    recorded.reset();
+    for (const auto& wr : records) {
+      const auto i = WallIndex(wr.getPosition(), wr.getDirection());
+      if (i.isInsideOfField()) recorded.set(i.getIndex());
+    }
+    seed(Lower);
+    seed(Upper);
+    lowerDirty = false;
+  }
+  recordCount = size;
+  flood(maze);
+}
+OptimalityCertificate::Result OptimalityCertificate::certify(
+    const Maze& maze, const float tolerance) {
+  update(maze);
+  /* 保留していた下限の再計算 */
+  if (lowerDirty) {
+    seed(Lower);
+    flood(maze);
+    lowerDirty = false;
+  }
+  const auto start = maze.getStart();
+  const auto lower = getLowerStep(start);
+  const auto upper = getUpperStep(start);
+  if (lower == STEP_MAX) return {NoPath, lower, upper};
+  if (upper <= lower) return {Optimal, lower, upper};
+  if (upper != STEP_MAX && upper <= lower * (1 + tolerance))
+    return {WithinTolerance, lower, upper};
+  return {Unproven, lower, upper};
+}
+bool OptimalityCertificate::updateRange(const Maze& maze) {
+  /* StepMap と同じく、既知壁とゴールの範囲に外周を加えた範囲に制限 */
+  int8_t x0 = maze.getMinX(), x1 = maze.getMaxX();
+  int8_t y0 = maze.getMinY(), y1 = maze.getMaxY();
+  for (const auto p : maze.getGoals()) {
+    x0 = std::min(p.x, x0);
+    x1 = std::max(p.x, x1);
+    y0 = std::min(p.y, y0);
+    y1 = std::max(p.y, y1);
+  }
+  x0 -= 1, y0 -= 1, x1 += 2, y1 += 2;
+  if (x0 == min_x && y0 == min_y && x1 == max_x && y1 == max_y) return false;
+  min_x = x0, min_y = y0, max_x = x1, max_y = y1;
+  return true;
+}
+void OptimalityCertificate::seed(const Channel ch) {
+  for (auto& s : steps) s[ch] = STEP_MAX;
+  for (const auto p : dest)
+    if (p.isInsideOfField()) steps[p.getIndex()][ch] = 0, q.push({p, ch, 0});
+}
+void OptimalityCertificate::flood(const Maze& maze) {
+  while (!q.empty()) {
+    const auto focus = q.top().p;
+    const auto ch = q.top().ch;
+    const auto focus_step_q = q.top().s;
+    q.pop();
+    /* 計算を高速化するため展開範囲を制限 */
+    if (focus.x > max_x || focus.y > max_y || focus.x < min_x ||
+        focus.y < min_y)
+      continue;
+    const auto focus_step = steps[focus.getIndex()][ch];
+    /* 枝刈り */
+    if (focus_step < focus_step_q) continue;
+    /* 周辺を走査。上限チャンネルは未知壁を壁ありとみなす */
+    StepMap::relaxStraights(
+        maze, focus, focus_step, ch == Upper, simple,
+        [&](Direction) -> const auto& { return stepTable; },
+        [&](const Position next, const step_t next_step) {
+          auto& step = steps[next.getIndex()][ch];
+          if (step <= next_step) return;
+          step = next_step;
+          q.push({next, ch, step});
+        });
+  }
+}
+bool OptimalityCertificate::isTightWall(const WallIndex& i) const {
+  /* 壁の両側の区画の組のうち、直線で結ぶとステップの差が一致するもの */
+  const auto d = i.getDirection();
+  const auto b = d + Direction::Back;
+  const auto a = i.getPosition();
+  for (auto u = a; u.isInsideOfField(); u = u.next(b)) {
+    const int su = steps[u.getIndex()][Lower];
+    int8_t len = std::abs(u.x - a.x) + std::abs(u.y - a.y);
+    for (auto v = a.next(d); v.isInsideOfField(); v = v.next(d)) {
+      const int sv = steps[v.getIndex()][Lower];
+      const int cost = getEdgeStep(++len);
+      if ((su != STEP_MAX && su + cost == sv) ||
+          (sv != STEP_MAX && sv + cost == su))
+        return true;
+    }
+  }
+  return false;
+}
+void OptimalityCertificate::pushUpperLine(const WallIndex& i) {
+  /* 壁を通る直線上の区画から上限チャンネルの展開を再開する */
+  const auto d = i.getDirection();
+  const auto b = d + Direction::Back;
+  auto p = i.getPosition();
+  while (p.next(b).isInsideOfField()) p = p.next(b);
+  for (; p.isInsideOfField(); p = p.next(d)) {
+    const auto s = steps[p.getIndex()][Upper];
+    if (s != STEP_MAX) q.push({p, Upper, s});
+  }
+}
+
+}  // namespace MazeLib
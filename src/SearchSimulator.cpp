@@ -0,0 +1,155 @@
+/**
+ * @file SearchSimulator.cpp
+ * @brief 正解の迷路を用いて探索走行を模擬するクラス
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-12
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include "MazeLib/SearchSimulator.h"
+
+#include <algorithm>  //< for std::find_if
+
+namespace MazeLib {
+
+SearchSimulator::Result SearchSimulator::run(const Maze& mazeTarget) {
+  /* 初期化 */
+  this->mazeTarget = &mazeTarget;
+  result = Result();
+  maze.reset(false);
+  maze.setStart(mazeTarget.getStart());
+  maze.setGoals(mazeTarget.getGoals());
+  certificate.reset();
+  rng.seed(noise.seed);
+  pose = Pose(mazeTarget.getStart(), Direction::North);
+  /* スタート区画の背面の壁は既知とする */
+  const auto back = pose.d + Direction::Back;
+  maze.updateWall(pose.p, back, mazeTarget.isWall(pose.p, back));
+  const auto& goals = maze.getGoals();
+  const bool simple = strategy.simple;
+  /* 追加探索の経路導出では、始点区画が確定したら展開を打ち切る */
+  stepMap.setEarlyExitMargin(0);
+  /* 1. ゴールへ向かう探索走行 */
+  senseWalls();
+  while (!isGoal()) {
+    /* 未知壁はないものとしてゴールへのステップマップを更新 */
+    cache.update(stepMap, maze, goals, false, simple);
+    ++result.recomputes;
+    if (isLimitExceeded()) return result;
+    /* 読み違えた壁で閉じ込められたら、直近の壁情報を捨てて確認し直す */
+    if (stepMap.getStep(pose.p) == StepMap::STEP_MAX) {
+      ++result.resets;
+      resetLastWalls();
+      continue;
+    }
+    /* 未知壁を含む区画まで既知区間を進む */
+    Pose end;
+    const auto knownDirs =
+        stepMap.getStepDownDirections(maze, pose, end, false, simple, true);
+    const auto candidates = stepMap.getNextDirectionCandidates(
+        maze, end, strategy.candidateOrder);
+    move(knownDirs, false);
+    if (isGoal()) break;
+    if (pose.p != end.p) continue;  //< 壁に当たって中断したら再計算
+    /* 壁のない候補のうち優先順位の最も高い方向に1区画進む */
+    const auto it = std::find_if(
+        candidates.cbegin(), candidates.cend(),
+        [&](const Direction d) { return !maze.isWall(pose.p, d); });
+    if (it == candidates.cend()) continue;  //< 候補がなければ再計算
+    move({*it}, false);
+  }
+  /* 2. 最短経路を見つける追加探索走行 */
+  while (1) {
+    if (certificate.certify(maze).status == OptimalityCertificate::Optimal)
+      break;
+    Position target;
+    if (!planner.selectTarget(maze, pose.p, target)) break;
+    /* 矛盾により現在区画の壁が未知になったら、向きを変えて確認し直す */
+    if (target == pose.p) {
+      ++result.recomputes;
+      if (isLimitExceeded()) return result;
+      pose.d = pose.d + Direction::Back;
+      senseWalls();
+      continue;
+    }
+    const auto moveDirs =
+        stepMap.calcShortestDirections(maze, pose.p, {target}, false, simple);
+    ++result.recomputes;
+    if (moveDirs.empty() || isLimitExceeded()) return result;
+    move(moveDirs, true);
+  }
+  /* 3. スタート区画へ戻る走行 */
+  while (pose.p != maze.getStart()) {
+    bool knownOnly = strategy.knownOnly;
+    auto moveDirs = stepMap.calcShortestDirectionsAstar(
+        maze, pose.p, {maze.getStart()}, knownOnly, simple);
+    /* 既知壁のみで戻れない場合 (矛盾による未知壁など) は未知壁を通る */
+    if (moveDirs.empty() && knownOnly)
+      moveDirs = stepMap.calcShortestDirectionsAstar(
+          maze, pose.p, {maze.getStart()}, knownOnly = false, simple);
+    ++result.recomputes;
+    if (isLimitExceeded()) return result;
+    if (moveDirs.empty()) {
+      ++result.resets;
+      resetLastWalls();
+      continue;
+    }
+    /* 未知壁を通る経路では新たな壁を見つけたら止まって再計算する */
+    move(moveDirs, !knownOnly);
+  }
+  /* 最短経路の導出 */
+  result.shortestDirections =
+      cache.calcShortestDirections(stepMap, maze, true, false);
+  if (result.shortestDirections.empty()) return result;
+  /* 読み違えた壁を通る経路は走行できないので失敗とする */
+  auto p = maze.getStart();
+  for (const auto d : result.shortestDirections) {
+    if (mazeTarget.isWall(p, d)) return result;
+    p = p.next(d);
+  }
+  result.shortestCost =
+      stepMap.calcDirectionsCost(result.shortestDirections, false);
+  result.success = true;
+  return result;
+}
+void SearchSimulator::senseWalls() {
+  /* 位置ずれ: 前後の区画の壁を現在区画の壁として読んでしまう */
+  auto sensed = pose.p;
+  if (chance(noise.slip)) {
+    const auto slipped = pose.p.next(
+        pose.d + (chance(0.5f) ? Direction::Front : Direction::Back));
+    if (slipped.isInsideOfField()) sensed = slipped, ++result.slips;
+  }
+  for (const auto d : {Direction::Front, Direction::Left, Direction::Right}) {
+    const auto dir = pose.d + d;
+    bool wall = mazeTarget->isWall(sensed, dir);
+    /* 読み違い */
+    if (chance(noise.misread)) wall = !wall, ++result.misreads;
+    maze.updateWall(pose.p, dir, wall);
+  }
+}
+void SearchSimulator::resetLastWalls() {
+  /* 繰り返し閉じ込められる場合は古い壁情報まで捨てる */
+  maze.resetLastWalls(RESET_WALLS_ON_DEADLOCK * result.resets, false);
+  /* 現在区画の壁を確認し直す */
+  senseWalls();
+}
+void SearchSimulator::move(const Directions& dirs, const bool breakUnknown) {
+  for (const auto d : dirs) {
+    /* 壁に当たったら壁ありを確認して中断 */
+    if (mazeTarget->isWall(pose.p, d)) {
+      maze.updateWall(pose.p, d, true);
+      ++result.collisions;
+      break;
+    }
+    /* 通過した壁は壁なしとして1区画進む */
+    const auto records = maze.getWallRecords().size();
+    maze.updateWall(pose.p, d, false);
+    pose = pose.next(d);
+    ++result.moves;
+    /* 移動先の区画で壁を確認。新たな壁情報を得たら終了 */
+    senseWalls();
+    if (breakUnknown && maze.getWallRecords().size() != records) break;
+  }
+}
+
+}  // namespace MazeLib
@@ -7,11 +7,13 @@
  */
 #include "MazeLib/StepMap.h"
 
-#include <algorithm>  //< for std::sort
+#include <algorithm>  //< for std::min, std::max
 #include <cmath>      //< for std::sqrt
-#include <iomanip>    //< for std::setw
+#include <limits>     //< for std::numeric_limits
 #include <queue>
 
+#include "MazeLib/MazeRenderer.h"
+
 namespace MazeLib {
 
 StepMap::StepMap() {
@@ -24,60 +26,8 @@ void StepMap::print(const Maze& maze, const Position p, const Direction d,
 }
 void StepMap::print(const Maze& maze, const Directions& dirs,
                     const Position start, std::ostream& os) const {
-  /* preparation */
-  std::vector<Pose> path;
-  path.reserve(dirs.size());
-  Position p = start;
-  for (const auto d : dirs) path.push_back({p, d}), p = p.next(d);
-  const int mazeSize = MAZE_SIZE;
-  step_t maxStep = 0;
-  for (const auto step : stepMap)
-    if (step != STEP_MAX) maxStep = std::max(maxStep, step);
-  const bool simple = (maxStep < 999);
-  const step_t scaler =
-      stepTable[stepTableSize - 1] - stepTable[stepTableSize - 2];
-  const auto find = [&](const WallIndex& i) {
-    return std::find_if(path.cbegin(), path.cend(), [&](const Pose& pose) {
-      return WallIndex(pose.p, pose.d) == i;
-    });
-  };
-  /* start to draw maze */
-  for (int8_t y = mazeSize; y >= 0; --y) {
-    /* Vertical Wall Line */
-    if (y != mazeSize) {
-      for (uint8_t x = 0; x <= mazeSize; ++x) {
-        /* Vertical Wall */
-        const auto w = maze.isWall(x, y, Direction::West);
-        const auto k = maze.isKnown(x, y, Direction::West);
-        const auto it = find(WallIndex(Position(x, y), Direction::West));
-        if (it != path.cend())
-          os << C_YE "\e[1m" << it->d << C_NO;
-        else
-          os << (k ? (w ? "|" : " ") : (C_RE "." C_NO));
-        /* Cell */
-        if (x != mazeSize) {
-          step_t step = getStep(x, y);
-          step = std::min(999, simple ? step : step / scaler);
-          os << (step == 0 ? C_YE : C_BL) << std::setw(3) << step << C_NO;
-        }
-      }
-      os << "\e[0K" << std::endl;  // clear from cursor position to end of line
-    }
-    /* Horizontal Wall Line */
-    for (uint8_t x = 0; x < mazeSize; ++x) {
-      /* Pillar */
-      os << '+';
-      /* Horizontal Wall */
-      const auto w = maze.isWall(x, y, Direction::South);
-      const auto k = maze.isKnown(x, y, Direction::South);
-      const auto it = find(WallIndex(Position(x, y), Direction::South));
-      if (it != path.cend())
-        os << C_YE "\e[1m " << it->d << " " C_NO;
-      else
-        os << (k ? (w ? "---" : "   ") : (C_RE " . " C_NO));
-    }
-    os << '+' << "\e[0K" << std::endl;
-  }
+  MazeRenderer renderer;
+  print(renderer, maze, dirs, start, os);
 }
 void StepMap::printFull(const Maze& maze, const Position p, const Direction d,
                         std::ostream& os) const {
@@ -85,151 +35,312 @@ void StepMap::printFull(const Maze& maze, const Position p, const Direction d,
 }
 void StepMap::printFull(const Maze& maze, const Directions& dirs,
                         const Position start, std::ostream& os) const {
-  /* preparation */
-  std::vector<Pose> path;
-  path.reserve(dirs.size());
-  Position p = start;
-  for (const auto d : dirs) path.push_back({p, d}), p = p.next(d);
-  const int mazeSize = MAZE_SIZE;
-  const auto find = [&](const WallIndex& i) {
-    return std::find_if(path.cbegin(), path.cend(), [&](const Pose& pose) {
-      return WallIndex(pose.p, pose.d) == i;
-    });
-  };
-  /* start to draw maze */
-  for (int8_t y = mazeSize; y >= 0; --y) {
-    /* Vertical Wall Line */
-    if (y != mazeSize) {
-      for (uint8_t x = 0; x <= mazeSize; ++x) {
-        /* Vertical Wall */
-        const auto w = maze.isWall(x, y, Direction::West);
-        const auto k = maze.isKnown(x, y, Direction::West);
-        const auto it = find(WallIndex(Position(x, y), Direction::West));
-        if (it != path.cend())
-          os << C_YE "\e[1m" << it->d << C_NO;
-        else
-          os << (k ? (w ? "|" : " ") : (C_RE "." C_NO));
-        /* Cell */
-        if (x != mazeSize) {
-          auto step = std::min((step_t)99999, getStep(x, y));
-          os << (step == 0 ? C_YE : C_BL) << std::setw(5) << step << C_NO;
-        }
-      }
-      os << std::endl;
-    }
-    /* Horizontal Wall Line */
-    for (uint8_t x = 0; x < mazeSize; ++x) {
-      /* Pillar */
-      os << '+';
-      /* Horizontal Wall */
-      const auto w = maze.isWall(x, y, Direction::South);
-      const auto k = maze.isKnown(x, y, Direction::South);
-      const auto it = find(WallIndex(Position(x, y), Direction::South));
-      if (it != path.cend())
-        os << C_YE "\e[1m  " << it->d << "  " C_NO;
-      else
-        os << (k ? (w ? "-----" : "     ") : (C_RE "  .  " C_NO));
-    }
-    os << '+' << std::endl;
-  }
+  MazeRenderer renderer;
+  printFull(renderer, maze, dirs, start, os);
 }
-void StepMap::update(const Maze& maze, const Positions& dest,
-                     const bool knownOnly, const bool simple) {
-  MAZE_DEBUG_PROFILING_START(0)
-  /* 計算を高速化するため、迷路の大きさを制限 */
-  int8_t min_x = maze.getMinX();
-  int8_t max_x = maze.getMaxX();
-  int8_t min_y = maze.getMinY();
-  int8_t max_y = maze.getMaxY();
-  for (const auto p : dest) {  //< ゴールを含めないと導出不可能になる
-    min_x = std::min(p.x, min_x);
-    max_x = std::max(p.x, max_x);
-    min_y = std::min(p.y, min_y);
-    max_y = std::max(p.y, max_y);
+void StepMap::print(MazeRenderer& renderer, const Maze& maze,
+                    const Directions& dirs, const Position start,
+                    std::ostream& os) const {
+  renderer.clear();
+  renderer.setPath(dirs, start);
+  renderer.renderStepMap(maze, *this, false);
+  renderer.write(os);
+  os.flush();
+}
+void StepMap::printFull(MazeRenderer& renderer, const Maze& maze,
+                        const Directions& dirs, const Position start,
+                        std::ostream& os) const {
+  renderer.clear();
+  renderer.setPath(dirs, start);
+  renderer.renderStepMap(maze, *this, true);
+  renderer.write(os);
+  os.flush();
+}
+StepMap::Range StepMap::calcRange(const Maze& maze,
+                                  const Positions& positions) {
+  Range r = {maze.getMinX(), maze.getMinY(), maze.getMaxX(), maze.getMaxY()};
+  for (const auto p : positions) {  //< ゴールを含めないと導出不可能になる
+    r.min_x = std::min(p.x, r.min_x);
+    r.max_x = std::max(p.x, r.max_x);
+    r.min_y = std::min(p.y, r.min_y);
+    r.max_y = std::max(p.y, r.max_y);
   }
-  min_x -= 1, min_y -= 1, max_x += 2, max_y += 2;  //< 外周を許す
-  /* 全区画のステップを最大値に設定 */
-  reset();
-  /* ステップの更新予約のキュー */
-#define STEP_MAP_USE_PRIORITY_QUEUE 1
-#if STEP_MAP_USE_PRIORITY_QUEUE
+  r.min_x -= 1, r.min_y -= 1, r.max_x += 2, r.max_y += 2;  //< 外周を許す
+  return r;
+}
+template <typename Key, typename Stop, typename Settle>
+int StepMap::flood(const Maze& maze, const Positions& seeds,
+                   const bool knownOnly, const bool simple, const Range& range,
+                   Key key, Stop stop, Settle settle) {
+  /* ステップの更新予約のキュー (優先度の昇順) */
   struct Element {
     Position p;
     step_t s;
-    bool operator<(const Element& e) const { return s > e.s; }
+    uint32_t k;  //< 優先度
+    bool operator<(const Element& e) const { return k > e.k; }
   };
-  std::priority_queue<Element> q;
-#else
-  std::queue<Position> q;
-#endif
-  /* destのステップを0とする */
-  for (const auto p : dest)
-    if (p.isInsideOfField())
-#if STEP_MAP_USE_PRIORITY_QUEUE
-      setStep(p, 0), q.push({p, 0});
-#else
-      setStep(p, 0), q.push(p);
-#endif
+  std::priority_queue<Element, Vector<Element>> q;
+  for (const auto p : seeds) {
+    const auto step = getStep(p);
+    if (step != STEP_MAX) q.push({p, step, key(p, step)});
+  }
+  const int seedCount = q.size();
   /* ステップの更新がなくなるまで更新処理 */
   while (!q.empty()) {
 #if MAZE_DEBUG_PROFILING
     queueSizeMax = std::max(queueSizeMax, static_cast<int>(q.size()));
 #endif
     /* 注目する区画を取得 */
-#if STEP_MAP_USE_PRIORITY_QUEUE
     const auto focus = q.top().p;
     const auto focus_step_q = q.top().s;
-#else
-    const auto focus = q.front();
-#endif
+    if (stop(focus_step_q, q.top().k)) break;
     q.pop();
     /* 計算を高速化するため展開範囲を制限 */
-    if (focus.x > max_x || focus.y > max_y || focus.x < min_x ||
-        focus.y < min_y)
-      continue;
+    if (!range.contains(focus)) continue;
     const auto focus_step = stepMap[focus.getIndex()];
-#if STEP_MAP_USE_PRIORITY_QUEUE
     /* 枝刈り */
     if (focus_step < focus_step_q) continue;
-#endif
+    settle(focus, focus_step);
     /* 周辺を走査 */
-    for (const auto d : Direction::Along4()) {
-      /* 直線で行けるところまで更新する */
-      auto next = focus;
-      for (int8_t i = 1;; ++i) {
-        /* 壁あり or 既知壁のみで未知壁 ならば次へ */
-        const auto next_wi = WallIndex(next, d);
-        if (maze.isWall(next_wi) || (knownOnly && !maze.isKnown(next_wi)))
-          break;
-        next = next.next(d);  //< 移動
-        /* 直線加速を考慮したステップを算出 */
-        const step_t next_step = focus_step + (simple ? i : stepTable[i]);
-        const auto next_index = next.getIndex();
-        if (stepMap[next_index] <= next_step) break;  //< 更新の必要がない
-        stepMap[next_index] = next_step;              //< 更新
-        /* 再帰的に更新するためにキューにプッシュ */
-#if STEP_MAP_USE_PRIORITY_QUEUE
-        q.push({next, next_step});
-#else
-        q.push(next);
-#endif
-      }
-    }
+    relaxStraights(
+        maze, focus, focus_step, knownOnly, simple,
+        [&](const Direction d) -> const auto& {
+          /* ゴール区画に進入する直線は、減速の余地に応じたコストとする */
+          return goalBraking && !simple && focus_step == 0
+                     ? goalStepTable[calcGoalRoom(
+                           maze, focus, d + Direction::Back, knownOnly)]
+                     : stepTable;
+        },
+        [&](const Position next, const step_t next_step) {
+          auto& step = stepMap[next.getIndex()];
+          if (step <= next_step) return;
+          step = next_step;  //< 更新
+          /* 再帰的に更新するためにキューにプッシュ */
+          q.push({next, next_step, key(next, next_step)});
+        });
   }
+  return seedCount;
+}
+void StepMap::update(const Maze& maze, const Positions& dest,
+                     const bool knownOnly, const bool simple,
+                     const Position start, const step_t margin) {
+  MAZE_DEBUG_PROFILING_START(0)
+  /* 全区画のステップを最大値に設定し、destのステップを0とする */
+  reset();
+  for (const auto p : dest)
+    if (p.isInsideOfField()) setStep(p, 0);
+  /* 始点区画の確定後、このステップを超えたら展開を打ち切る */
+  step_t limit_step = STEP_MAX;
+  const bool early_exit = start.isInsideOfField() && margin != STEP_MAX;
+  flood(
+      maze, dest, knownOnly, simple, calcRange(maze, dest),
+      [](const Position, const step_t s) { return s; },
+      [&](const step_t s, uint32_t) {
+        /* 打ち切り判定。これ以下のステップの区画はすべて確定している */
+        if (s <= limit_step) return false;
+        settledStep = limit_step;
+        return true;
+      },
+      [&](const Position p, const step_t s) {
+        /* 始点区画が確定したら打ち切りステップを決定 */
+        if (early_exit && p == start)
+          limit_step = std::min<int>(s + margin, STEP_MAX - 1);
+      });
   MAZE_DEBUG_PROFILING_END(0)
 }
+void StepMap::updateAstar(const Maze& maze, const Positions& dest,
+                          const Position start, const bool knownOnly,
+                          const bool simple) {
+  MAZE_DEBUG_PROFILING_START(0)
+  /* 全区画のステップを最大値に設定 */
+  reset();
+  if (!start.isInsideOfField()) return;
+  /* destのステップを0とする */
+  for (const auto p : dest)
+    if (p.isInsideOfField()) setStep(p, 0);
+  /* 展開範囲には始点区画も含める */
+  auto positions = dest;
+  positions.push_back(start);
+  const auto start_index = start.getIndex();
+  /* 推定総コスト (ステップ + 始点までのコストの下限) の昇順に展開 */
+  flood(
+      maze, dest, knownOnly, simple, calcRange(maze, positions),
+      [&](const Position p, const step_t s) -> uint32_t {
+        return s + calcHeuristicStep(p, start, simple);
+      },
+      [&](step_t, const uint32_t f) {
+        /* 残りの候補が始点のステップを改善できなければ確定 */
+        if (f < stepMap[start_index]) return false;
+        settledStep = 0;  //< 確定区画は経路上のみなので、目的地区画のみとする
+        return true;
+      },
+      [](Position, step_t) {});
+  MAZE_DEBUG_PROFILING_END(0)
+}
+int StepMap::relax(const Maze& maze, const Positions& seeds,
+                   const bool knownOnly, const bool simple) {
+  /* 展開範囲は制限しない */
+  const Range range = {-1, -1, MAZE_SIZE, MAZE_SIZE};
+  return flood(
+      maze, seeds, knownOnly, simple, range,
+      [](const Position, const step_t s) { return s; },
+      [](step_t, uint32_t) { return false; }, [](Position, step_t) {});
+}
+Directions StepMap::calcShortestDirectionsAstar(const Maze& maze,
+                                                const Position start,
+                                                const Positions& dest,
+                                                const bool knownOnly,
+                                                const bool simple) {
+  /* 始点区画に向けてステップマップを更新 */
+  updateAstar(maze, dest, start, knownOnly, simple);
+  if (!start.isInsideOfField()) return {};
+  Pose end;
+  auto shortestDirections = getStepDownDirections(
+      maze, {start, Direction::Max}, end, knownOnly, simple, false);
+  /* ゴール判定 */
+  if (stepMap[end.p.getIndex()] != 0) return {};
+  appendGoalBraking(maze, end, shortestDirections, knownOnly, simple);
+  return shortestDirections;
+}
 Directions StepMap::calcShortestDirections(const Maze& maze,
                                            const Position start,
                                            const Positions& dest,
                                            const bool knownOnly,
                                            const bool simple) {
-  /* ステップマップを更新 */
+  /* ステップマップを更新。始点区画が確定したら打ち切る */
+  update(maze, dest, knownOnly, simple, start, earlyExitMargin);
+  if (!start.isInsideOfField()) return {};
+  Pose end;
+  auto shortestDirections = getStepDownDirections(
+      maze, {start, Direction::Max}, end, knownOnly, simple, false);
+  /* ゴール判定 */
+  if (stepMap[end.p.getIndex()] != 0) return {};
+  appendGoalBraking(maze, end, shortestDirections, knownOnly, simple);
+  return shortestDirections;
+}
+StepMap::Routes StepMap::calcKShortestDirections(const Maze& maze,
+                                                 const Position start,
+                                                 const Positions& dest,
+                                                 const int k,
+                                                 const bool knownOnly,
+                                                 const bool simple) {
+  Routes routes;      //< 確定した経路
+  Routes candidates;  //< 確定前の候補経路 (コストの昇順)
+  if (k < 1 || !start.isInsideOfField()) return routes;
+  /* ゴール区画内での減速は考慮しない (終了時に設定を戻す) */
+  struct BrakingGuard {
+    bool& enabled;
+    const bool saved;
+    ~BrakingGuard() { enabled = saved; }
+  } brakingGuard{goalBraking, goalBraking};
+  goalBraking = false;
+  /* 最短経路を導出 */
   update(maze, dest, knownOnly, simple);
   Pose end;
   const auto shortestDirections = getStepDownDirections(
       maze, {start, Direction::Max}, end, knownOnly, simple, false);
-  /* ゴール判定 */
-  return stepMap[end.p.getIndex()] == 0 ? shortestDirections : Directions{};
+  if (stepMap[end.p.getIndex()] != 0) return routes;
+  routes.push_back(
+      {shortestDirections, calcDirectionsCost(shortestDirections, simple)});
+  /* 最短経路のステップマップを下限コストの目安として保持 */
+  const auto heuristic = stepMap;
+  /* 分岐点から先の経路探索に使う迷路 */
+  Maze spurMaze = maze;
+  WallIndexes blockedWalls;
+  const auto block = [&](const Position p, const Direction d) {
+    const auto i = WallIndex(p, d);
+    if (spurMaze.isWall(i)) return;
+    spurMaze.setWall(i, true);
+    blockedWalls.push_back(i);
+  };
+  while (static_cast<int>(routes.size()) < k) {
+    const auto previous = routes.back().directions;
+    /* 直前の経路上の各区画を分岐点として迂回経路を探す */
+    auto spur = start;
+    for (size_t i = 0; i < previous.size(); spur = spur.next(previous[i++])) {
+      const Directions root(previous.cbegin(), previous.cbegin() + i);
+      /* 分岐点以降のコストの下限で枝刈り */
+      const auto spurStep = heuristic[spur.getIndex()];
+      if (spurStep == STEP_MAX) continue;
+      const auto required = k - routes.size();
+      if (candidates.size() >= required) {
+        /* 根の最後の直線は迂回経路とつながり得るので除く */
+        auto lastRun = root.size();
+        while (lastRun > 0 && root[lastRun - 1] == root.back()) --lastRun;
+        const Directions rootPrefix(root.cbegin(), root.cbegin() + lastRun);
+        const int lowerBound =
+            calcDirectionsCost(rootPrefix, simple) + spurStep;
+        if (candidates[required - 1].cost <= lowerBound) continue;
+      }
+      /* 同じ根をもつ確定経路の分岐方向を塞ぐ */
+      for (const auto& route : routes) {
+        const auto& dirs = route.directions;
+        if (dirs.size() > i && std::equal(root.cbegin(), root.cend(),
+                                          dirs.cbegin()))
+          block(spur, dirs[i]);
+      }
+      /* 根の区画を塞ぐ (分岐点を除く) */
+      auto p = start;
+      for (const auto d : root) {
+        for (const auto d4 : Direction::Along4()) block(p, d4);
+        p = p.next(d);
+      }
+      /* 分岐点から目的地までの経路を導出 */
+      update(spurMaze, dest, knownOnly, simple);
+      Pose spurEnd;
+      const auto spurDirections = getStepDownDirections(
+          spurMaze, {spur, Direction::Max}, spurEnd, knownOnly, simple, false);
+      const bool reached = stepMap[spurEnd.p.getIndex()] == 0;
+      /* 塞いだ壁を元に戻す */
+      for (const auto i : blockedWalls) spurMaze.setWall(i, false);
+      blockedWalls.clear();
+      if (!reached) continue;
+      /* 重複を除いて候補に追加 */
+      Route route{root, 0};
+      route.directions.insert(route.directions.cend(), spurDirections.cbegin(),
+                              spurDirections.cend());
+      route.cost = calcDirectionsCost(route.directions, simple);
+      const auto isSame = [&](const Route& r) {
+        return r.directions == route.directions;
+      };
+      if (std::any_of(routes.cbegin(), routes.cend(), isSame) ||
+          std::any_of(candidates.cbegin(), candidates.cend(), isSame))
+        continue;
+      candidates.insert(
+          std::upper_bound(candidates.cbegin(), candidates.cend(), route,
+                           [](const Route& r1, const Route& r2) {
+                             return r1.cost < r2.cost;
+                           }),
+          route);
+    }
+    /* 候補がなくなったら終了 */
+    if (candidates.empty()) break;
+    routes.push_back(candidates.front());
+    candidates.erase(candidates.cbegin());
+  }
+  /* 最短経路のステップマップに戻す */
+  stepMap = heuristic;
+  return routes;
+}
+StepMap::step_t StepMap::calcDirectionsCost(const Directions& dirs,
+                                            const bool simple,
+                                            const int brakeCells) const {
+  /* 減速に使う区画は進入後なのでコストに含めない */
+  const int brake = std::max(0, std::min<int>(brakeCells, dirs.size()));
+  const size_t size = dirs.size() - brake;
+  if (simple) return std::min<size_t>(size, STEP_MAX);
+  int cost = 0;
+  for (size_t i = 0; i < size;) {
+    /* 同じ方向が続く区間を1本の直線とする */
+    size_t j = i + 1;
+    while (j < size && dirs[j] == dirs[i]) ++j;
+    const auto& table =
+        j == size ? goalStepTable[std::min(brake, goalRoomSize - 1)]
+                  : stepTable;
+    cost += table[std::min<int>(j - i, stepTableSize - 1)];
+    i = j;
+  }
+  return std::min<int>(cost, STEP_MAX);
 }
 Pose StepMap::calcNextDirections(const Maze& maze, const Pose& start,
                                  Directions& nextDirectionsKnown,
@@ -237,7 +348,8 @@ Pose StepMap::calcNextDirections(const Maze& maze, const Pose& start,
   Pose end;
   nextDirectionsKnown =
       getStepDownDirections(maze, start, end, false, false, true);
-  nextDirectionCandidates = getNextDirectionCandidates(maze, end);
+  const auto candidates = getNextDirectionCandidates(maze, end);
+  nextDirectionCandidates.assign(candidates.begin(), candidates.end());
   return end;
 }
 Directions StepMap::getStepDownDirections(const Maze& maze, const Pose& start,
@@ -252,14 +364,17 @@ Directions StepMap::getStepDownDirections(const Maze& maze, const Pose& start,
   focus = start;
   /* 確認 */
   if (!start.p.isInsideOfField()) return {};
+  /* 直前に曲がる前の方向 (PreferZigzag 用) */
+  int8_t before = Direction::Max;
   /* 周辺の走査; 未知壁の有無と最小ステップの方向を求める */
   while (1) {
     const auto focus_step = stepMap[focus.p.getIndex()];
     /* 終了条件 */
     if (focus_step == 0) break;
-    /* 周辺を走査 */
+    /* 周辺を走査; ステップが一致する候補から方針に従って1つ選ぶ */
     auto min_p = focus.p;
     auto min_d = Direction::Max;
+    int min_key = std::numeric_limits<int>::max();
     for (const auto d : Direction::Along4()) {
       /* 直線で行けるところまで探す */
       auto next = focus.p;  //< 隣接
@@ -269,17 +384,34 @@ Directions StepMap::getStepDownDirections(const Maze& maze, const Pose& start,
           break;
         next = next.next(d);  //< 移動
         /* 直線加速を考慮したステップを算出 */
-        const step_t next_step = focus_step - (simple ? i : stepTable[i]);
-        /* エッジコストと一致するか確認 */
-        if (stepMap[next.getIndex()] == next_step) {
-          min_p = next, min_d = d;
-          goto loop_exit;
+        step_t edge_cost = simple ? i : stepTable[i];
+        /* ゴール区画に進入する直線は、減速の余地に応じたコストとする */
+        if (goalBraking && !simple && stepMap[next.getIndex()] == 0)
+          edge_cost = goalStepTable[calcGoalRoom(maze, next, d, knownOnly)][i];
+        /* 桁あふれ防止。減速を考慮するとより遠くのゴール区画が安くなり得る */
+        if (edge_cost > focus_step) {
+          if (goalBraking) continue;
+          break;
         }
+        const step_t next_step = focus_step - edge_cost;
+        /* エッジコストと一致しなければ次へ */
+        if (stepMap[next.getIndex()] != next_step) continue;
+        /* 方針の優先度 (小さいほど優先)、直進、Along4() の順で詰めたキー */
+        int key = (d != focus.d) << 2 | d >> 1;
+        if (tieBreak == FewerTurns) key |= (MAZE_SIZE - i) << 3;
+        if (tieBreak == PreferKnown) key |= (maze.unknownCount(next) > 0) << 3;
+        if (tieBreak == PreferZigzag) key = (d != before) << 3 | (key ^ 4);
+        if (tieBreak == FirstFound) key = d >> 1;
+        if (key < min_key) min_key = key, min_p = next, min_d = d;
+        /* FewerTurns 以外は方向ごとに最も近い候補のみ */
+        if (tieBreak != FewerTurns) break;
       }
+      /* FirstFound は最初の候補で確定 */
+      if (tieBreak == FirstFound && min_d != Direction::Max) break;
     }
-  loop_exit:
     /* 現在地よりステップが大きかったらなんかおかしい */
     if (focus_step <= stepMap[min_p.getIndex()]) break;
+    if (focus.d != min_d) before = focus.d;
     /* 移動分を結果に追加 */
     while (focus.p != min_p) {
       /* breakUnknown のとき、未知壁を含むならば既知区間は終了 */
@@ -327,35 +459,41 @@ Directions StepMap::getStepDownDirections(const Maze& maze, const Pose& start,
   return shortestDirections;
 #endif
 }
-Directions StepMap::getNextDirectionCandidates(const Maze& maze,
-                                               const Pose& focus) const {
-  /* 直線優先で進行方向の候補を抽出。全方位 STEP_MAX だと空になる */
-  Directions dirs;
-  dirs.reserve(4);
-  for (const auto d : {focus.d + Direction::Front, focus.d + Direction::Left,
-                       focus.d + Direction::Right, focus.d + Direction::Back})
-    if (!maze.isWall(focus.p, d) && getStep(focus.p.next(d)) != STEP_MAX)
-      dirs.push_back(d);
-  /* コストの低い順に並べ替え */
-  std::sort(dirs.begin(), dirs.end(),
-            [&](const Direction d1, const Direction d2) {
-              return getStep(focus.p.next(d1)) < getStep(focus.p.next(d2));
-            });
-#if 1
-  /* 未知壁優先で並べ替え(未知壁同士ならばコストが低い順) */
-  std::sort(dirs.begin(), dirs.end(),
-            [&](const Direction d1, const Direction d2) {
-              return (maze.unknownCount(focus.p.next(d1)) &&
-                      !maze.unknownCount(focus.p.next(d2)));
-            });
-#endif
-#if 1
-  /* 直進優先に並べ替え */
-  std::sort(dirs.begin(), dirs.end(),
-            [&](const Direction d1, const Direction d2
-                __attribute__((unused))) { return d1 == focus.d; });
-#endif
-  return dirs;
+StepMap::Candidates StepMap::getNextDirectionCandidates(
+    const Maze& maze, const Pose& focus, const CandidateOrder order) const {
+  /* 直進優先で進行方向の候補を抽出。全方位 STEP_MAX だと空になる */
+  /* 部分的なステップマップでは未確定の区画は到達可能とみなす */
+  static constexpr Direction rels[4] = {
+      Direction::Front, Direction::Left, Direction::Right, Direction::Back};
+  static constexpr uint32_t INVALID = std::numeric_limits<uint32_t>::max();
+  /* 方向ごとの並べ替えのキー; 小さいほど優先 */
+  uint32_t keys[4];
+  for (int i = 0; i < 4; ++i) {
+    const auto d = focus.d + rels[i];
+    const auto next = focus.p.next(d);
+    const auto step = getStep(next);
+    const bool valid =
+        !maze.isWall(focus.p, d) && (step != STEP_MAX || !isSettled(next));
+    const bool straightFirst = order >= StraightFirst && i != 0;
+    const bool unknownFirst = order >= UnknownFirst && !maze.unknownCount(next);
+    keys[i] = valid ? (straightFirst << 19 | unknownFirst << 18 | step << 2 | i)
+                    : INVALID;
+  }
+  /* 4要素のソーティングネットワークで並べ替え */
+  const auto compareSwap = [&](const int a, const int b) {
+    const auto lo = std::min(keys[a], keys[b]);
+    const auto hi = std::max(keys[a], keys[b]);
+    keys[a] = lo, keys[b] = hi;
+  };
+  compareSwap(0, 1), compareSwap(2, 3);
+  compareSwap(0, 2), compareSwap(1, 3);
+  compareSwap(1, 2);
+  /* キーの下位2ビットから方向を復元 */
+  Candidates candidates;
+  for (const auto key : keys)
+    if (key != INVALID)
+      candidates.dirs[candidates.count++] = focus.d + rels[key & 3];
+  return candidates;
 }
 void StepMap::appendStraightDirections(const Maze& maze,
                                        Directions& shortestDirections,
@@ -394,44 +532,80 @@ void StepMap::appendStraightDirections(const Maze& maze,
   }
 }
 /**
- * @brief 台形加速を考慮したコストを生成する関数
+ * @brief 終点速度を基本速度より高くできる直線のコストを生成する関数
  *
  * @param i マスの数
  * @param am 最大加速度
  * @param vs 始点速度
+ * @param ve 終点速度の上限
  * @param vm 飽和速度
  * @param seg 1マスの長さ
  * @return StepMap::step_t コスト
  */
 static StepMap::step_t calcStraightCost(const int i, const float am,
-                                        const float vs, const float vm,
-                                        const float seg) {
+                                        const float vs, const float ve,
+                                        const float vm, const float seg) {
   const auto d = seg * i;  //< i 区画分の走行距離
-  /* グラフの面積から時間を求める */
-  const auto d_thr = (vm * vm - vs * vs) / am;  //< 最大速度に達する距離
-  if (d < d_thr)
-    return 2 * (std::sqrt(vs * vs + am * d) - vs) / am * 1000;  //< 三角加速
-  else
-    return (am * d + (vm - vs) * (vm - vs)) / (am * vm) * 1000;  //< 台形加速
+  const auto v_end = std::min(ve, vm);
+  /* 加速し続けても終点速度の上限に達しない */
+  const auto v_acc2 = vs * vs + 2 * am * d;
+  if (v_acc2 <= v_end * v_end) return (std::sqrt(v_acc2) - vs) / am * 1000;
+  /* 加速してから終点速度の上限まで減速する */
+  const auto v_peak2 = am * d + (vs * vs + v_end * v_end) / 2;
+  if (v_peak2 < vm * vm)
+    return (2 * std::sqrt(v_peak2) - vs - v_end) / am * 1000;  //< 三角加速
+  const auto d_acc = (2 * vm * vm - vs * vs - v_end * v_end) / (2 * am);
+  return ((2 * vm - vs - v_end) / am + (d - d_acc) / vm) * 1000;  //< 台形加速
 }
 void StepMap::calcStraightCostTable() {
-  const float vs = 420.0f;      //< 基本速度 [mm/s]
-  const float am_a = 4200.0f;   //< 最大加速度 [mm/s/s]
-  const float vm_a = 1500.0f;   //< 飽和速度 [mm/s]
-  const float seg_a = 90.0f;    //< 区画の長さ [mm]
-  const float t_turn = 287.0f;  //< 小回り90度ターンの時間 [ms]
-  stepTable[0] = 0;             //< [0] は使用しない
-  for (int i = 1; i < stepTableSize; ++i) {
-    /* 1歩目は90度ターンとみなす */
-    stepTable[i] = t_turn + calcStraightCost(i - 1, am_a, vs, vm_a, seg_a);
-  }
-  /* コストの合計が 65,535 [ms] を超えないようにスケーリング */
-  for (int i = 0; i < stepTableSize; ++i) {
-    stepTable[i] /= scalingFactor;
+  using P = TrapezoidProfile;
+  stepTable[0] = 0;  //< [0] は使用しない
+  for (int i = 1; i < stepTableSize; ++i) stepTable[i] = P::calcStep(i);
 #if 0
+  for (int i = 0; i < stepTableSize; ++i)
     MAZE_LOGI << "stepTable[" << i << "]:\t" << stepTable[i] << std::endl;
 #endif
+  /* ゴール領域に進入する直線。余地の区画で基本速度まで減速できる速度で進入 */
+  goalStepTable[0] = stepTable;
+  for (int r = 1; r < goalRoomSize; ++r) {
+    const float ve = std::sqrt(P::vs * P::vs + 2 * P::am * P::seg * r);
+    goalStepTable[r][0] = 0;
+    for (int i = 1; i < stepTableSize; ++i)
+      goalStepTable[r][i] =
+          (P::t_turn +
+           calcStraightCost(i - 1, P::am, P::vs, ve, P::vm, P::seg)) /
+          scalingFactor;
   }
 }
+StepMap::step_t StepMap::calcHeuristicStep(const Position p1,
+                                           const Position p2,
+                                           const bool simple) const {
+  const int dx = std::abs(p1.x - p2.x);
+  const int dy = std::abs(p1.y - p2.y);
+  if (simple) return dx + dy;
+  /* 直線コストは劣加法的なので、縦横各1本の直線のコストが下限となる */
+  /* ゴール区画での減速を考慮する場合は、最も安い進入のコストで見積もる */
+  const auto& table =
+      goalBraking ? goalStepTable[goalRoomSize - 1] : stepTable;
+  return (dx ? table[dx] : 0) + (dy ? table[dy] : 0);
+}
+int StepMap::calcGoalRoom(const Maze& maze, const Position p,
+                          const Direction d, const bool knownOnly) const {
+  int room = 0;
+  for (auto next = p; room < goalRoomSize - 1; ++room) {
+    if (maze.isWall(next, d) || (knownOnly && !maze.isKnown(next, d))) break;
+    next = next.next(d);
+    if (getStep(next) != 0) break;
+  }
+  return room;
+}
+void StepMap::appendGoalBraking(const Maze& maze, const Pose& end,
+                                Directions& dirs, const bool knownOnly,
+                                const bool simple) const {
+  if (!goalBraking || simple || dirs.empty()) return;
+  /* 進入した向きのまま、減速の余地の区画を進んで停止する */
+  const int room = calcGoalRoom(maze, end.p, end.d, knownOnly);
+  dirs.insert(dirs.end(), room, end.d);
+}
 
 }  // namespace MazeLib
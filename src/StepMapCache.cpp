@@ -0,0 +1,94 @@
+/**
+ * @file StepMapCache.cpp
+ * @brief 迷路の状態をキーとしてステップマップを再利用するキャッシュ
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-16
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include "MazeLib/StepMapCache.h"
+
+#include <algorithm>  //< for std::max
+
+namespace MazeLib {
+
+StepMapCache::StepMapCache(const size_t budget) {
+  /* 要素の実体に加えて、リストと索引のノードの分を見込む */
+  const size_t entrySize = sizeof(Entry) + sizeof(Key) + 8 * sizeof(void*);
+  capacity = std::max<size_t>(1, budget / entrySize);
+  index.reserve(capacity);
+}
+bool StepMapCache::update(StepMap& stepMap, const Maze& maze,
+                          const Positions& dest, const bool knownOnly,
+                          const bool simple) {
+  const auto key = makeKey(stepMap, maze, dest, knownOnly, simple);
+  const auto it = index.find(key);
+  if (it != index.end()) {
+    /* 最近使ったものとして先頭に移動 */
+    entries.splice(entries.begin(), entries, it->second);
+    stepMap.setMapArray(it->second->map);
+    ++hits;
+    return true;
+  }
+  ++misses;
+  stepMap.update(maze, dest, knownOnly, simple);
+  /* 予算を超えるなら最も長く使われていないものを捨てる */
+  if (entries.size() >= capacity) {
+    index.erase(entries.back().key);
+    entries.pop_back();
+  }
+  entries.push_front({key, stepMap.getMapArray()});
+  index[key] = entries.begin();
+  return false;
+}
+Directions StepMapCache::calcShortestDirections(StepMap& stepMap,
+                                                const Maze& maze,
+                                                const Position start,
+                                                const Positions& dest,
+                                                const bool knownOnly,
+                                                const bool simple) {
+  update(stepMap, maze, dest, knownOnly, simple);
+  if (!start.isInsideOfField()) return {};
+  Pose end;
+  auto shortestDirections = stepMap.getStepDownDirections(
+      maze, {start, Direction::Max}, end, knownOnly, simple, false);
+  /* ゴール判定 */
+  if (stepMap.getStep(end.p) != 0) return {};
+  stepMap.appendGoalBraking(maze, end, shortestDirections, knownOnly, simple);
+  return shortestDirections;
+}
+void StepMapCache::clear() {
+  entries.clear();
+  index.clear();
+  hits = misses = 0;
+}
+StepMapCache::Key StepMapCache::makeKey(const StepMap& stepMap,
+                                        const Maze& maze,
+                                        const Positions& dest,
+                                        const bool knownOnly,
+                                        const bool simple) {
+  Key key;
+  key.maze = maze.getHash();
+  /* 目的地の集合は順不同なので、区画ごとの値の和とする */
+  key.dest = dest.size();
+  for (const auto p : dest) {
+    uint64_t z = (p.getIndex() + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    key.dest += z ^ (z >> 31);
+  }
+  /* 展開範囲は既知壁の範囲に依存する */
+  key.option = static_cast<uint8_t>(maze.getMinX()) |
+               static_cast<uint8_t>(maze.getMinY()) << 8 |
+               static_cast<uint8_t>(maze.getMaxX()) << 16 |
+               static_cast<uint64_t>(static_cast<uint8_t>(maze.getMaxY()))
+                   << 24 |
+               static_cast<uint64_t>(knownOnly) << 32 |
+               static_cast<uint64_t>(simple) << 33 |
+               static_cast<uint64_t>(stepMap.isGoalBraking()) << 34;
+  /* コストテーブルの FNV-1a ハッシュ */
+  key.profile = 2166136261u;
+  for (const auto step : stepMap.getStepTable())
+    key.profile = (key.profile ^ step) * 16777619u;
+  return key;
+}
+
+}  // namespace MazeLib
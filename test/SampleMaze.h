@@ -0,0 +1,47 @@
+/**
+ * @file SampleMaze.h
+ * @brief 単体テストで共通に使う 9x9 の迷路
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-13
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include <sstream>
+
+#include "MazeLib/Maze.h"
+
+namespace MazeLib {
+
+/**
+ * @brief ゴール区画が 3x3 の 9x9 の迷路
+ */
+inline Maze getSampleMaze() {
+  std::stringstream maze_stream;
+  maze_stream << R"(
++---+---+---+---+---+---+---+---+---+
+|               |                   |
++   +---+   +   +   +---+---+---+   +
+|       |   |   |   |               |
++---+   +   +   +   +   +---+---+---+
+|       |   |       |               |
++   +---+   +---+---+---+---+---+   +
+|       |   | G   G   G |           |
++---+   +   +   +   +   +   +---+---+
+|       |   | G   G   G |           |
++   +---+   +   +   +   +---+---+   +
+|       |   | G   G   G |       |   |
++---+   +   +   +---+---+   +   +   +
+|       |   |   |       |   |   |   |
++   +   +   +   +   +   +   +   +   +
+|       |   |   |   |   |   |   |   |
++   +   +   +   +   +   +   +   +   +
+| S |       |       |       |       |
++---+---+---+---+---+---+---+---+---+
+)";
+  Maze maze;
+  maze_stream >> maze;
+  return maze;
+}
+
+}  // namespace MazeLib
@@ -0,0 +1,68 @@
+/**
+ * @file WallRevealer.h
+ * @brief 正解の迷路の壁を乱順に確定させる単体テストの補助
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-23
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include <algorithm>  //< for std::shuffle
+#include <random>
+
+#include "MazeLib/MazeGenerator.h"
+
+namespace MazeLib {
+
+/**
+ * @brief 生成した正解の迷路の壁を、未知の迷路に乱順に1枚ずつ確定させる
+ * @details 差分更新の結果を全体の再計算と比較する試験で使う
+ */
+struct WallRevealer {
+  Maze mazeTarget;   /**< @brief 正解の迷路 */
+  Maze maze;         /**< @brief 壁を確定させていく迷路 */
+  WallIndexes walls; /**< @brief 壁を確定させる順序 */
+
+  /**
+   * @brief コンストラクタ
+   * @param seed 壁の順序の乱数の種
+   */
+  explicit WallRevealer(const uint32_t seed) : generator(2023), rng(seed) {}
+  /**
+   * @brief 次の正解の迷路を生成し、壁がすべて未知の迷路に戻す
+   * @param loops 全域木の後に残った壁をさらに除去する確率
+   */
+  void reset(const float loops) {
+    MazeGenerator::Option option;
+    option.loops = loops;
+    mazeTarget = generator.generate(option);
+    maze = Maze();
+    maze.setStart(mazeTarget.getStart());
+    maze.setGoals(mazeTarget.getGoals());
+    walls.clear();
+    for (int i = 0; i < WallIndex::SIZE; ++i) {
+      const WallIndex wi(static_cast<uint16_t>(i));
+      if (wi.isInsideOfField()) walls.push_back(wi);
+    }
+    std::shuffle(walls.begin(), walls.end(), rng);
+  }
+  /**
+   * @brief すべての壁を順に確定させる
+   * @param onReveal 壁を確定させるたびに呼ぶ関数 (順序の添字, 壁)
+   */
+  template <typename F>
+  void revealAll(F onReveal) {
+    for (size_t n = 0; n < walls.size(); ++n) {
+      const auto wi = walls[n];
+      maze.updateWall(wi.getPosition(), wi.getDirection(),
+                      mazeTarget.isWall(wi));
+      onReveal(n, wi);
+    }
+  }
+
+ protected:
+  MazeGenerator generator; /**< @brief 正解の迷路の生成器 */
+  std::mt19937 rng;        /**< @brief 壁の順序の乱数 */
+};
+
+}  // namespace MazeLib
@@ -0,0 +1,87 @@
+/**
+ * @file test_all_pairs_index.cpp
+ * @brief Unit Test for MazeLib::AllPairsIndex
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-24
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include <random>
+#include <sstream>
+
+#include "MazeLib/AllPairsIndex.h"
+#include "MazeLib/MazeGenerator.h"
+
+using namespace MazeLib;
+
+TEST(AllPairsIndex, calcShortestDirections) {
+  MazeGenerator generator(2023);
+  std::mt19937 rng(3);
+  std::uniform_int_distribution<int> cell(0, Position::SIZE - 1);
+  StepMap stepMap;
+  for (const bool simple : {false, true}) {
+    MazeGenerator::Option option;
+    option.loops = 0.2f;
+    const auto maze = generator.generate(option);
+    AllPairsIndex index;
+    EXPECT_FALSE(index.isValidFor(maze));
+    index.build(maze, simple);
+    EXPECT_TRUE(index.isValidFor(maze));
+    /* 区画の組ごとに StepMap と比較する */
+    for (int n = 0; n < 200; ++n) {
+      const auto from = Position::getPositionFromIndex(cell(rng));
+      const auto to = Position::getPositionFromIndex(cell(rng));
+      stepMap.update(maze, {to}, true, simple);
+      const auto step = stepMap.getStep(from);
+      ASSERT_EQ(index.getStep(from, to), step) << from << " " << to;
+      const auto dirs = index.calcShortestDirections(from, to);
+      if (step == StepMap::STEP_MAX) {
+        EXPECT_TRUE(dirs.empty());
+        continue;
+      }
+      auto end = from;
+      for (const auto d : dirs) {
+        ASSERT_TRUE(maze.canGo(end, d));
+        end = end.next(d);
+      }
+      EXPECT_EQ(end, to);
+      EXPECT_EQ(stepMap.calcDirectionsCost(dirs, simple), step);
+    }
+    EXPECT_EQ(index.getStep(Position(-1, 0), Position(0, 0)),
+              StepMap::STEP_MAX);
+  }
+}
+TEST(AllPairsIndex, save_load) {
+  MazeGenerator generator(2023);
+  auto maze = generator.generate(MazeGenerator::Option());
+  AllPairsIndex index;
+  std::stringstream empty;
+  EXPECT_FALSE(index.save(empty));
+  index.build(maze);
+  std::stringstream ss;
+  ASSERT_TRUE(index.save(ss));
+  const auto data = ss.str();
+  /* 同じ迷路なら復元できる */
+  AllPairsIndex loaded;
+  std::istringstream is(data);
+  ASSERT_TRUE(loaded.load(is, maze));
+  EXPECT_TRUE(loaded.isValidFor(maze));
+  for (int i = 0; i < Position::SIZE; i += 7) {
+    const auto from = Position::getPositionFromIndex(i);
+    EXPECT_EQ(loaded.getStep(from, maze.getStart()),
+              index.getStep(from, maze.getStart()));
+    EXPECT_EQ(loaded.calcShortestDirections(from, maze.getStart()),
+              index.calcShortestDirections(from, maze.getStart()));
+  }
+  /* 末尾が欠けたバイト列は復元しない */
+  std::istringstream truncated(data.substr(0, data.size() - 1));
+  EXPECT_FALSE(loaded.load(truncated, maze));
+  EXPECT_FALSE(loaded.isValidFor(maze));
+  /* 壁情報が異なる迷路では復元しない */
+  maze.updateWall(Position(0, 0), Direction::East,
+                  !maze.isWall(Position(0, 0), Direction::East));
+  EXPECT_FALSE(index.isValidFor(maze));
+  std::istringstream mismatched(data);
+  EXPECT_FALSE(loaded.load(mismatched, maze));
+}
@@ -0,0 +1,111 @@
+/**
+ * @file test_constexpr_maze.cpp
+ * @brief Unit Test for MazeLib::ConstexprMaze and MazeLib::ConstexprStepMap
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-11
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include "MazeLib/ConstexprMaze.h"
+#include "MazeLib/OptimalityCertificate.h"
+
+using namespace MazeLib;
+
+static constexpr std::string_view sample_maze_text = R"(
++---+---+---+---+---+---+---+---+---+
+|               |                   |
++   +---+   +   +   +---+---+---+   +
+|       |   |   |   |               |
++---+   +   +   +   +   +---+---+---+
+|       |   |       |               |
++   +---+   +---+---+---+---+---+   +
+|       |   | G   G   G |           |
++---+   +   +   +   +   +   +---+---+
+|       |   | G   G   G |           |
++   +---+   +   +   +   +---+---+   +
+|       |   | G   G   G |       |   |
++---+   +   +   +---+---+   +   +   +
+|       |   |   |       |   |   |   |
++   +   +   +   +   +   +   +   +   +
+|       |   |   |   |   |   |   |   |
++   +   +   +   +   +   +   +   +   +
+| S |       |       |       |       |
++---+---+---+---+---+---+---+---+---+
+)";
+
+/* コンパイル時の評価 */
+static constexpr ConstexprMaze<9> sample_maze(sample_maze_text);
+static_assert(sample_maze.isValid(), "parse error");
+static_assert(sample_maze.isWall(0, 0, Direction::East), "start wall");
+static_assert(!sample_maze.isWall(0, 0, Direction::North), "start wall");
+static_assert(sample_maze.isGoal(4, 4) && !sample_maze.isGoal(2, 4), "goal");
+static_assert(!ConstexprMaze<9>("+---+").isValid(), "truncated maze");
+static constexpr ConstexprStepMap<9> sample_step_map(sample_maze, true);
+static_assert(sample_step_map.getStep(sample_maze.getStart()) == 58, "step");
+static_assert(sample_step_map.calcShortestRoute(sample_maze, Position(0, 0))
+                      .size == 58,
+              "shortest path length");
+
+TEST(ConstexprMaze, toMaze) {
+  std::stringstream ss;
+  ss << sample_maze_text;
+  Maze expected;
+  ss >> expected;
+  const auto maze = sample_maze.toMaze();
+  EXPECT_EQ(maze.getStart(), expected.getStart());
+  EXPECT_EQ(maze.getGoals().size(), expected.getGoals().size());
+  for (int8_t x = 0; x < 9; ++x)
+    for (int8_t y = 0; y < 9; ++y)
+      for (const auto d : Direction::Along4())
+        EXPECT_EQ(maze.isWall(x, y, d), expected.isWall(x, y, d));
+  /* CRLF の改行でも同じ迷路となる */
+  std::string crlf;
+  for (const auto c : sample_maze_text) {
+    if (c == '\n') crlf += '\r';
+    crlf += c;
+  }
+  const ConstexprMaze<9> maze_crlf(crlf);
+  EXPECT_TRUE(maze_crlf.isValid());
+  for (int8_t x = 0; x < 9; ++x)
+    for (int8_t y = 0; y < 9; ++y)
+      for (const auto d : Direction::Along4())
+        EXPECT_EQ(maze_crlf.isWall(x, y, d), sample_maze.isWall(x, y, d));
+}
+
+/* コストテーブルは StepMap と同じ走行パラメータから計算する */
+static_assert(ConstexprStepMap<MAZE_SIZE>::calcStepTable()[1] ==
+              StepMap::TrapezoidProfile::calcStep(1));
+static_assert(ConstexprStepMap<MAZE_SIZE>::calcStepTable()[MAZE_SIZE - 1] ==
+              StepMap::TrapezoidProfile::calcStep(MAZE_SIZE - 1));
+
+TEST(ConstexprStepMap, update) {
+  /* コストテーブルは StepMap と一致する */
+  constexpr auto stepTable = ConstexprStepMap<MAZE_SIZE>::calcStepTable();
+  StepMap stepMap;
+  for (int i = 1; i < MAZE_SIZE; ++i)
+    EXPECT_EQ(stepTable[i], stepMap.getStepTable()[i]) << i;
+  /* 実行時の厳密なステップと一致する */
+  const auto maze = sample_maze.toMaze();
+  for (const auto simple : {true, false}) {
+    const ConstexprStepMap<9> constexprStepMap(sample_maze, simple);
+    OptimalityCertificate certificate(simple);
+    certificate.certify(maze);
+    for (int8_t x = 0; x < 9; ++x)
+      for (int8_t y = 0; y < 9; ++y)
+        EXPECT_EQ(constexprStepMap.getStep(x, y),
+                  certificate.getUpperStep(Position(x, y)));
+    const auto route =
+        constexprStepMap.calcShortestRoute(sample_maze, maze.getStart());
+    const Directions dirs(route.directions.cbegin(),
+                          route.directions.cbegin() + route.size);
+    EXPECT_EQ(route.cost, stepMap.calcDirectionsCost(dirs, simple));
+    auto p = maze.getStart();
+    for (const auto d : dirs) {
+      EXPECT_TRUE(maze.canGo(p, d));
+      p = p.next(d);
+    }
+    EXPECT_TRUE(sample_maze.isGoal(p.x, p.y));
+  }
+  EXPECT_EQ(ConstexprStepMap<9>().getStep(0, 0), StepMap::STEP_MAX);
+}
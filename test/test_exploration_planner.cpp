@@ -0,0 +1,165 @@
+/**
+ * @file test_exploration_planner.cpp
+ * @brief Unit Test for MazeLib::ExplorationPlanner
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-08
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <queue>
+#include <random>
+
+#include "MazeLib/ExplorationPlanner.h"
+#include "MazeLib/MazeGenerator.h"
+#include "SampleMaze.h"
+
+using namespace MazeLib;
+
+/* 目的地に向かって未知壁を含む区画に当たるまで進み、壁を確認する */
+static void moveAndSense(Maze& maze, const Maze& mazeTarget, Pose& pose,
+                         const Positions& dest) {
+  StepMap stepMap;
+  const auto dirs =
+      stepMap.calcShortestDirections(maze, pose.p, dest, false, true);
+  ASSERT_FALSE(dirs.empty());
+  for (const auto d : dirs) {
+    if (maze.unknownCount(pose.p)) break;
+    pose = pose.next(d);
+  }
+  for (const auto d : {Direction::Front, Direction::Left, Direction::Right})
+    maze.updateWall(pose.p, pose.d + d, mazeTarget.isWall(pose.p, pose.d + d));
+}
+
+/**
+ * @brief 区画 via を通るスタートからゴールまでの経路の最小コスト (参照実装)
+ * @details 未知壁は壁なしとみなし、(区画, via を通ったか) を状態として
+ * 直線で行ける区画すべてに辺を張ったダイクストラ法
+ */
+static int calcStepThrough(const Maze& maze, const StepMap& stepMap,
+                           const Position via) {
+  const auto& stepTable = stepMap.getStepTable();
+  std::vector<int> dist(2 * Position::SIZE, StepMap::STEP_MAX);
+  using Element = std::pair<int, int>;  //< (コスト, 状態)
+  std::priority_queue<Element, std::vector<Element>, std::greater<Element>> q;
+  const auto start = maze.getStart();
+  const int s0 = start.getIndex() * 2 + (start == via);
+  q.push({dist[s0] = 0, s0});
+  while (!q.empty()) {
+    const auto [cost, state] = q.top();
+    q.pop();
+    if (cost > dist[state]) continue;
+    const auto p = Position::getPositionFromIndex(state / 2);
+    const bool visited = state % 2;
+    const auto& goals = maze.getGoals();
+    if (visited && std::find(goals.cbegin(), goals.cend(), p) != goals.cend())
+      return cost;
+    for (const auto d : Direction::Along4()) {
+      auto next = p;
+      bool v = visited;
+      for (int i = 1; maze.canGo(WallIndex(next, d), false); ++i) {
+        next = next.next(d);
+        v = v || next == via;
+        const int next_state = next.getIndex() * 2 + v;
+        const int next_cost = cost + stepTable[i];
+        if (next_cost >= dist[next_state]) continue;
+        q.push({dist[next_state] = next_cost, next_state});
+      }
+    }
+  }
+  return StepMap::STEP_MAX;
+}
+
+TEST(ExplorationPlanner, evaluate) {
+  const auto mazeTarget = getSampleMaze();
+  ExplorationPlanner planner;
+  /* 既知の迷路では追加探索は不要 */
+  EXPECT_TRUE(planner.evaluate(mazeTarget, mazeTarget.getStart()).empty());
+  EXPECT_EQ(planner.getLowerStep(), planner.getUpperStep());
+  /* 未知の迷路ではスコアの降順に候補が並ぶ */
+  Maze maze;
+  maze.setGoals(mazeTarget.getGoals());
+  const auto& candidates = planner.evaluate(maze, maze.getStart());
+  ASSERT_FALSE(candidates.empty());
+  EXPECT_EQ(planner.getUpperStep(), StepMap::STEP_MAX);
+  for (size_t i = 1; i < candidates.size(); ++i)
+    EXPECT_GE(candidates[i - 1].score, candidates[i].score);
+  for (const auto& c : candidates) EXPECT_GT(maze.unknownCount(c.p), 0);
+  /* ゴールが封鎖されている場合は候補なし */
+  Maze mazeBlocked = mazeTarget;
+  mazeBlocked.setGoals({Position(-1, -1)});
+  EXPECT_TRUE(planner.evaluate(mazeBlocked, maze.getStart()).empty());
+}
+
+TEST(ExplorationPlanner, search) {
+  const auto mazeTarget = getSampleMaze();
+  Maze maze;
+  maze.setGoals(mazeTarget.getGoals());
+  Pose pose(maze.getStart(), Direction::North);
+  maze.updateWall(pose.p, Direction::East, true);
+  maze.updateWall(pose.p, Direction::West, true);
+  /* ゴールへ向かう探索 */
+  const auto& goals = maze.getGoals();
+  while (std::find(goals.cbegin(), goals.cend(), pose.p) == goals.cend())
+    moveAndSense(maze, mazeTarget, pose, goals);
+  /* 最短経路を見つける追加探索 */
+  ExplorationPlanner planner;
+  Position target;
+  int count = 0;
+  while (planner.selectTarget(maze, pose.p, target)) {
+    ASSERT_LE(planner.getLowerStep(), planner.getUpperStep());
+    moveAndSense(maze, mazeTarget, pose, {target});
+    ASSERT_LT(++count, 9 * 9);
+  }
+  /* 既知壁のみの最短経路が正解の迷路の最短経路と一致する */
+  StepMap stepMap;
+  for (const auto simple : {true, false}) {
+    stepMap.calcShortestDirections(mazeTarget, true, simple);
+    const auto expected = stepMap.getStep(mazeTarget.getStart());
+    stepMap.calcShortestDirections(maze, true, simple);
+    EXPECT_EQ(stepMap.getStep(maze.getStart()), expected);
+  }
+}
+
+TEST(ExplorationPlanner, throughStraight) {
+  /* 最短経路を改善し得る区画は、直線の途中の区画であっても候補に残る */
+  MazeGenerator generator(2023);
+  std::mt19937 rng(4);
+  ExplorationPlanner planner;
+  StepMap stepMap;
+  int midStraight = 0;
+  for (int t = 0; t < 20; ++t) {
+    MazeGenerator::Option option;
+    option.loops = 0.3f + (t % 4) * 0.2f;
+    const auto mazeTarget = generator.generate(option);
+    /* 既知の経路がある状態から、一部の壁を未知に戻す */
+    Maze maze = mazeTarget;
+    std::bernoulli_distribution forget(0.3);
+    for (int i = 0; i < WallIndex::SIZE; ++i) {
+      const WallIndex wi(static_cast<uint16_t>(i));
+      if (wi.isInsideOfField() && forget(rng)) maze.setKnown(wi, false);
+    }
+    const auto& candidates = planner.evaluate(maze, maze.getStart());
+    const int upper = planner.getUpperStep();
+    if (upper == StepMap::STEP_MAX) continue;
+    stepMap.update(maze, {maze.getStart()}, false, false);
+    const auto fromStart = stepMap.getMapArray();
+    stepMap.update(maze, maze.getGoals(), false, false);
+    for (int i = 0; i < Position::SIZE; ++i) {
+      const auto p = Position::getPositionFromIndex(i);
+      if (!maze.unknownCount(p)) continue;
+      const int through = calcStepThrough(maze, stepMap, p);
+      if (through >= upper) continue;
+      EXPECT_NE(std::find_if(candidates.cbegin(), candidates.cend(),
+                             [&](const auto& c) { return c.p == p; }),
+                candidates.cend())
+          << p;
+      /* 下限の経路上になく、2つのステップの和では刈られてしまう区画 */
+      if (through > planner.getLowerStep() &&
+          fromStart[i] + stepMap.getStep(p) >= upper)
+        ++midStraight;
+    }
+  }
+  EXPECT_GT(midStraight, 0);
+}
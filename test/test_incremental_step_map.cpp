@@ -0,0 +1,76 @@
+/**
+ * @file test_incremental_step_map.cpp
+ * @brief Unit Test for MazeLib::IncrementalStepMap
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-22
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include "MazeLib/IncrementalStepMap.h"
+#include "WallRevealer.h"
+
+using namespace MazeLib;
+
+TEST(IncrementalStepMap, update) {
+  /* 正解の迷路の壁を乱順に確定させながら、全区画の再計算と比較する */
+  WallRevealer revealer(1);
+  StepMap expected;
+  for (int t = 0; t < 6; ++t) {
+    revealer.reset((t % 3) * 0.1f);
+    const auto& mazeTarget = revealer.mazeTarget;
+    auto& maze = revealer.maze;
+    const bool simple = t % 2;
+    IncrementalStepMap incremental(simple);
+    const auto check = [&](const char* msg) {
+      incremental.update(maze);
+      expected.update(maze, {maze.getStart()}, true, simple);
+      for (int i = 0; i < Position::SIZE; ++i) {
+        const auto p = Position::getPositionFromIndex(i);
+        ASSERT_EQ(incremental.getStepMap().getStep(p), expected.getStep(p))
+            << msg << " " << p;
+      }
+    };
+    revealer.revealAll([&](const size_t n, const WallIndex wi) {
+      if (n % 7 == 0) check("wall");
+      /* 既知壁と矛盾する更新で通過可能な壁が未知壁に戻る */
+      if (n % 97 == 50 && !mazeTarget.isWall(wi)) {
+        incremental.update(maze);
+        const int rebuilds = incremental.getRebuilds();
+        maze.updateWall(wi.getPosition(), wi.getDirection(), true);
+        check("conflict");
+        EXPECT_EQ(incremental.getRebuilds(), rebuilds + 1);
+        maze.updateWall(wi.getPosition(), wi.getDirection(), false);
+      }
+    });
+    check("all");
+    EXPECT_GT(incremental.getRelaxedSeeds(), 0);
+    /* 壁ログが短くなると計算し直す */
+    const int rebuilds = incremental.getRebuilds();
+    maze.resetLastWalls(10, false);
+    check("resetLastWalls");
+    EXPECT_EQ(incremental.getRebuilds(), rebuilds + 1);
+    /* 差分がなければ何もしない */
+    incremental.update(maze);
+    EXPECT_EQ(incremental.getRebuilds(), rebuilds + 1);
+    /* スタートへの経路はステップマップを下るだけで求まる */
+    for (int8_t x = 0; x < MAZE_SIZE; x += 3) {
+      const auto p = Position(x, MAZE_SIZE - 1);
+      const auto dirs = incremental.calcShortestDirections(maze, p);
+      const auto step = expected.getStep(p);
+      if (step == StepMap::STEP_MAX) {
+        EXPECT_TRUE(dirs.empty());
+        continue;
+      }
+      auto end = p;
+      for (const auto d : dirs) {
+        EXPECT_TRUE(maze.canGo(end, d));
+        end = end.next(d);
+      }
+      EXPECT_EQ(end, maze.getStart());
+      EXPECT_EQ(expected.calcDirectionsCost(dirs, simple), step);
+    }
+    EXPECT_TRUE(incremental.calcShortestDirections(maze, Position(-1, 0))
+                    .empty());
+  }
+}
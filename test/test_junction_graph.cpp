@@ -0,0 +1,66 @@
+/**
+ * @file test_junction_graph.cpp
+ * @brief Unit Test for MazeLib::JunctionGraph
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-23
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>  //< for std::find
+
+#include "MazeLib/JunctionGraph.h"
+#include "WallRevealer.h"
+
+using namespace MazeLib;
+
+TEST(JunctionGraph, calcShortestDirections) {
+  /* 正解の迷路の壁を乱順に確定させながら、作り直したグラフと比較する */
+  WallRevealer revealer(2);
+  StepMap stepMap;
+  for (int t = 0; t < 8; ++t) {
+    revealer.reset((t % 4) * 0.1f);
+    auto& maze = revealer.maze;
+    const bool knownOnly = t % 2;
+    const bool simple = t / 2 % 2;
+    JunctionGraph graph(knownOnly, simple);
+    const auto check = [&](const char* msg) {
+      const auto dirs = graph.calcShortestDirections(maze);
+      stepMap.update(maze, maze.getGoals(), knownOnly, simple);
+      const auto step = stepMap.getStep(maze.getStart());
+      if (step == StepMap::STEP_MAX) {
+        EXPECT_TRUE(dirs.empty()) << msg;
+        return;
+      }
+      auto end = maze.getStart();
+      for (const auto d : dirs) {
+        ASSERT_TRUE(maze.canGo(WallIndex(end, d), knownOnly)) << msg;
+        end = end.next(d);
+      }
+      const auto& goals = maze.getGoals();
+      EXPECT_NE(std::find(goals.begin(), goals.end(), end), goals.end()) << msg;
+      EXPECT_EQ(stepMap.calcDirectionsCost(dirs, simple), step) << msg;
+      /* 差分の反映が全体の作り直しと一致する */
+      JunctionGraph expected(knownOnly, simple);
+      expected.update(maze);
+      for (int i = 0; i < Position::SIZE; ++i) {
+        const auto p = Position::getPositionFromIndex(i);
+        ASSERT_EQ(graph.isNode(p), expected.isNode(p)) << msg << " " << p;
+        ASSERT_EQ(graph.getShortcut(p), expected.getShortcut(p))
+            << msg << " " << p;
+      }
+    };
+    revealer.revealAll([&](const size_t n, const WallIndex) {
+      if (n % 11 == 0) check("wall");
+    });
+    check("all");
+    EXPECT_EQ(graph.getRebuilds(), 1);
+    /* 節点のみを展開するので、キューに積む回数は区画数より少ない */
+    EXPECT_LT(graph.getNodeCount(), Position::SIZE);
+    EXPECT_LT(graph.getQueuePushes(), Position::SIZE);
+    /* 壁ログが短くなると作り直す */
+    maze.resetLastWalls(10, false);
+    check("resetLastWalls");
+    EXPECT_EQ(graph.getRebuilds(), 2);
+  }
+}
@@ -8,20 +8,47 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <filesystem>
+#include <sstream>
 
 #include "MazeLib/Maze.h"
+#include "MazeLib/MazeGenerator.h"
 
 using namespace MazeLib;
 
 TEST(Maze, parse_from_file) {
-  /* ファイルから迷路情報を取得 */
+  /* 書き出した迷路ファイルから迷路情報を取得 */
+  const auto dir = std::filesystem::temp_directory_path();
+  const auto filepath = (dir / "mazelib_parse_from_file.maze").string();
+  const auto mazeTarget = MazeGenerator(1).generate({});
+  {
+    std::ofstream ofs(filepath);
+    mazeTarget.print(ofs);
+  }
   Maze maze;
-  const std::string filepath = "../mazedata/data/32MM2019HX.maze";
-  EXPECT_TRUE(maze.parse(filepath.c_str()));
+  EXPECT_TRUE(maze.parse(filepath));
+  for (int i = 0; i < WallIndex::SIZE; ++i) {
+    const WallIndex wi(static_cast<uint16_t>(i));
+    EXPECT_EQ(maze.isWall(wi), mazeTarget.isWall(wi)) << wi;
+  }
   EXPECT_TRUE(maze.canGo(Position(0, 0), Direction::North));
+  const auto backup = (dir / "mazelib_parse_from_file.bin").string();
   for (const auto clear : {true, false})
-    EXPECT_TRUE(maze.backupWallRecordsToFile("data.bin", clear));
-  EXPECT_TRUE(maze.restoreWallRecordsFromFile("data.bin"));
+    EXPECT_TRUE(maze.backupWallRecordsToFile(backup, clear));
+  EXPECT_TRUE(maze.restoreWallRecordsFromFile(backup));
+  /* MAZE_SIZE を超える迷路 (32x32 の迷路など) は読み込まない */
+  const int large = 2 * MAZE_SIZE;
+  {
+    std::ofstream ofs(filepath);
+    std::string top = "+", row = "|";
+    for (int x = 0; x < large; ++x) top += "---+", row += "    ";
+    row.back() = '|';
+    ofs << top << '\n';
+    for (int y = 0; y < large; ++y) ofs << row << '\n' << top << '\n';
+  }
+  EXPECT_FALSE(maze.parse(filepath));
+  std::filesystem::remove(filepath);
+  std::filesystem::remove(backup);
 }
 
 TEST(Maze, parse_from_istream) {
@@ -96,3 +123,168 @@ TEST(Maze, parse_from_string_array) {
   sample.print(std::cout, mazeSize);
   ::testing::internal::GetCapturedStdout();
 }
+
+TEST(Maze, parse_invalid) {
+  Maze maze;
+  /* 行や文字が足りない配列 */
+  EXPECT_FALSE(maze.parse({"9a3c", "5e61", "b8d4"}, 4));
+  EXPECT_FALSE(maze.parse({"9a3c", "5e61", "b8d", "c39a"}, 4));
+  EXPECT_FALSE(maze.parse({}, 0));
+  const std::vector<std::string> tooLarge(MAZE_SIZE + 1,
+                                          std::string(MAZE_SIZE + 1, '0'));
+  EXPECT_FALSE(maze.parse(tooLarge, MAZE_SIZE + 1));
+  /* 迷路を含まない入力 */
+  std::stringstream large(std::string(64 * 1024, ' '));
+  EXPECT_FALSE(maze.parse(large));
+  std::stringstream empty;
+  EXPECT_FALSE(maze.parse(empty));
+  /* MAZE_SIZE を超える迷路は読み飛ばし、続く迷路は読める */
+  std::string border = "+";
+  for (int i = 0; i < MAZE_SIZE + 1; ++i) border += "---+";
+  std::stringstream tooLargeStream;
+  tooLargeStream << border << "\n";
+  for (int i = 0; i < MAZE_SIZE + 1; ++i)
+    tooLargeStream << "|\n" << border << "\n";
+  tooLargeStream << "+---+\n| S |\n+---+\n";
+  EXPECT_FALSE(maze.parse(tooLargeStream));
+  EXPECT_TRUE(maze.parse(tooLargeStream));
+  /* 途中で切れた迷路と幅の不正な迷路 */
+  std::stringstream truncated("+---+---+\n|   |   |\n");
+  EXPECT_FALSE(maze.parse(truncated));
+  std::stringstream badWidth("+---+--+\n|      |\n+------+\n");
+  EXPECT_FALSE(maze.parse(badWidth));
+}
+
+/**
+ * @brief シークできない入力ストリームバッファ (パイプの代わり)
+ */
+class PipeBuffer : public std::streambuf {
+ public:
+  explicit PipeBuffer(const std::string& data) : data(data) {}
+
+ protected:
+  int_type underflow() override {
+    if (pos >= data.size()) return traits_type::eof();
+    ch = data[pos++];
+    setg(&ch, &ch, &ch + 1);
+    return traits_type::to_int_type(ch);
+  }
+
+ private:
+  std::string data;
+  size_t pos = 0;
+  char ch = 0;
+};
+
+TEST(Maze, parse_concatenated_stream) {
+  const std::string first =
+      "maze #1\r\n"
+      "+---+---+---+\r\n"
+      "|       | G |\r\n"
+      "+   +---+   +\r\n"
+      "|   |       |\r\n"
+      "+   +   +---+\r\n"
+      "| S |       |\r\n"
+      "+---+---+---+\r\n";
+  const std::string second =
+      "\n"
+      "o---o---o\n"
+      "| G   G |\n"
+      "o   o\n"
+      "| S |   |\n"
+      "o---o---o\n";
+  PipeBuffer buffer(first + second);
+  std::istream is(&buffer);
+  std::vector<Maze> mazes;
+  for (Maze maze; is >> maze;) mazes.push_back(maze);
+  EXPECT_TRUE(is.fail());
+  ASSERT_EQ(mazes.size(), 2u);
+  /* 3x3 の迷路 (CRLF 改行と先頭の文字列) */
+  EXPECT_EQ(mazes[0].getStart(), Position(0, 0));
+  EXPECT_EQ(mazes[0].getGoals(), Positions({Position(2, 2)}));
+  EXPECT_TRUE(mazes[0].isWall(Position(0, 0), Direction::East));
+  EXPECT_FALSE(mazes[0].isWall(Position(0, 1), Direction::North));
+  EXPECT_TRUE(mazes[0].isWall(Position(1, 1), Direction::North));
+  EXPECT_FALSE(mazes[0].isWall(Position(2, 2), Direction::South));
+  EXPECT_TRUE(mazes[0].isKnown(Position(2, 0), Direction::North));
+  /* 2x2 の迷路 ('o' の柱と行末の空白の省略) */
+  EXPECT_EQ(mazes[1].getStart(), Position(0, 0));
+  EXPECT_EQ(mazes[1].getGoals().size(), 2u);
+  EXPECT_TRUE(mazes[1].isWall(Position(0, 0), Direction::East));
+  EXPECT_FALSE(mazes[1].isWall(Position(0, 1), Direction::East));
+  EXPECT_FALSE(mazes[1].isWall(Position(1, 1), Direction::South));
+  EXPECT_TRUE(mazes[1].isKnown(Position(1, 1), Direction::South));
+  EXPECT_TRUE(mazes[1].isWall(Position(1, 1), Direction::East));
+}
+
+TEST(Maze, restoreWallRecords) {
+  Maze maze;
+  maze.updateWall(Position(1, 0), Direction::North, true);
+  maze.updateWall(Position(1, 1), Direction::West, false);
+  std::string bytes;
+  for (const auto& wr : maze.getWallRecords())
+    bytes.append(reinterpret_cast<const char*>(&wr), sizeof(wr));
+  /* 正常な記録 */
+  Maze restored;
+  std::istringstream is(bytes);
+  EXPECT_TRUE(restored.restoreWallRecords(is));
+  EXPECT_EQ(restored.getHash(), maze.getHash());
+  EXPECT_EQ(restored.getWallRecords().size(), maze.getWallRecords().size());
+  /* 末尾の半端なバイト列は破損とみなすが、それまでは復元する */
+  std::istringstream truncated(bytes.substr(0, bytes.size() - 1));
+  EXPECT_FALSE(restored.restoreWallRecords(truncated));
+  EXPECT_EQ(restored.getWallRecords().size(), 1u);
+  /* 斜め方向の記録は破損とみなす */
+  const WallRecord diag(Position(2, 2), Direction::NorthEast, true);
+  std::istringstream corrupted(
+      bytes + std::string(reinterpret_cast<const char*>(&diag), sizeof(diag)));
+  EXPECT_FALSE(restored.restoreWallRecords(corrupted));
+  EXPECT_EQ(restored.getHash(), maze.getHash());
+}
+
+TEST(Maze, wall_storage) {
+  /* 保持形式 (MAZE_CELL_STORAGE) によらず同じ結果となる */
+  Maze maze;
+  /* 外周は既知の壁、内側は未知の壁なし */
+  for (int8_t i = 0; i < MAZE_SIZE; ++i) {
+    EXPECT_TRUE(maze.isWall(Position(i, 0), Direction::South));
+    EXPECT_TRUE(maze.isKnown(Position(i, 0), Direction::South));
+    EXPECT_TRUE(maze.isWall(Position(MAZE_SIZE - 1, i), Direction::East));
+    EXPECT_TRUE(maze.isKnown(Position(MAZE_SIZE - 1, i), Direction::East));
+  }
+  EXPECT_FALSE(maze.isWall(Position(5, 5), Direction::North));
+  EXPECT_FALSE(maze.isKnown(Position(5, 5), Direction::North));
+  EXPECT_TRUE(maze.isWall(Position(-1, 3), Direction::East));
+  /* 共有する壁は隣接区画からも同じに見える */
+  maze.setWall(Position(5, 5), Direction::North, true);
+  maze.setKnown(Position(5, 6), Direction::South, true);
+  EXPECT_TRUE(maze.isWall(Position(5, 6), Direction::South));
+  EXPECT_TRUE(maze.isKnown(Position(5, 5), Direction::North));
+  maze.setWall(Position(6, 6), Direction::West, true);
+  EXPECT_TRUE(maze.isWall(Position(5, 6), Direction::East));
+  EXPECT_FALSE(maze.isKnown(Position(5, 6), Direction::East));
+  /* 外周の更新は無視する */
+  maze.setWall(Position(0, 3), Direction::West, false);
+  EXPECT_TRUE(maze.isWall(Position(0, 3), Direction::West));
+  /* 区画ごとの数え上げは方向ごとの参照と一致する */
+  for (int8_t x = 0; x < MAZE_SIZE; ++x) {
+    for (int8_t y = 0; y < MAZE_SIZE; ++y) {
+      const auto p = Position(x, y);
+      int walls = 0, unknowns = 0;
+      for (const auto d : Direction::Along4()) {
+        walls += maze.isWall(p, d);
+        unknowns += !maze.isKnown(p, d);
+      }
+      EXPECT_EQ(maze.wallCount(p), walls) << p;
+      EXPECT_EQ(maze.unknownCount(p), unknowns) << p;
+    }
+  }
+  EXPECT_EQ(maze.wallCount(Position(5, 6)), 2);
+  EXPECT_EQ(maze.getHash(), maze.calcHash());
+  /* 元に戻すとハッシュも戻る */
+  const auto hash = Maze().getHash();
+  maze.setWall(Position(5, 5), Direction::North, false);
+  maze.setKnown(Position(5, 5), Direction::North, false);
+  maze.setWall(Position(6, 6), Direction::West, false);
+  EXPECT_EQ(maze.getHash(), hash);
+}
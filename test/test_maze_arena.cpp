@@ -0,0 +1,77 @@
+/**
+ * @file test_maze_arena.cpp
+ * @brief Unit Test for MazeLib::MazeArena
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-25
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include "MazeLib/MazeArena.h"
+#include "MazeLib/MazeGenerator.h"
+#include "MazeLib/StepMap.h"
+
+#if MAZE_PMR
+
+#include <cstdlib>  //< for std::malloc
+#include <new>
+
+using namespace MazeLib;
+
+/* 大域的な確保の回数を数える */
+static size_t allocations = 0;
+
+void* operator new(const std::size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+TEST(MazeArena, planning) {
+  MazeGenerator generator(2023);
+  MazeGenerator::Option option;
+  option.loops = 0.2f;
+  const auto mazeTarget = generator.generate(option);
+  /* 探索途中の迷路 (左半分のみ既知) */
+  Maze maze;
+  maze.setStart(mazeTarget.getStart());
+  maze.setGoals(mazeTarget.getGoals());
+  for (int8_t x = 0; x < MAZE_SIZE / 2; ++x)
+    for (int8_t y = 0; y < MAZE_SIZE; ++y)
+      for (const auto d : Direction::Along4())
+        maze.updateWall(Position(x, y), d, mazeTarget.isWall(x, y, d));
+  StepMap stepMap;
+  MazeArena arena;
+  /* 計画の周期ごとに arena を使い捨てる */
+  size_t lengths = 0;
+  const auto before = allocations;
+  for (int t = 0; t < 20; ++t) {
+    {
+      const MazeArena::Scope scope(arena);
+      Directions known, candidates;
+      stepMap.update(maze, maze.getGoals(), false, false);
+      stepMap.calcNextDirections(maze, {maze.getStart(), Direction::North},
+                                 known, candidates);
+      const auto shortest =
+          stepMap.calcShortestDirections(mazeTarget, true, false);
+      const auto back = stepMap.calcShortestDirections(
+          mazeTarget, mazeTarget.getGoals()[0], {mazeTarget.getStart()},
+          true, true);
+      lengths += known.size() + candidates.size() + shortest.size() +
+                 back.size();
+    }
+    arena.reset();
+  }
+  EXPECT_EQ(allocations, before);
+  EXPECT_GT(lengths, 0u);
+  /* Scope の間のみ arena から確保する */
+  {
+    const MazeArena::Scope scope(arena);
+    EXPECT_EQ(Directions().get_allocator().resource(), arena.getResource());
+  }
+  EXPECT_NE(Directions().get_allocator().resource(), arena.getResource());
+}
+
+#endif
@@ -0,0 +1,74 @@
+/**
+ * @file test_maze_batch.cpp
+ * @brief Unit Test for MazeLib::MazeBatch
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-20
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include "MazeLib/MazeBatch.h"
+#include "MazeLib/MazeGenerator.h"
+
+using namespace MazeLib;
+
+TEST(MazeBatch, calcShortestDirections) {
+  /* グループの端数が出る数の迷路を、一部の壁を未知にして StepMap と比較する */
+  MazeGenerator generator(2023);
+  std::vector<Maze> mazes;
+  MazeBatch batch;
+  for (int t = 0; t < 2 * MazeBatch::LANES + 5; ++t) {
+    MazeGenerator::Option option;
+    option.mazeSize = t % 3 ? MAZE_SIZE : 9;
+    option.goalSize = t % 3 ? 2 : 3;
+    option.algorithm =
+        t % 2 ? MazeGenerator::Kruskal : MazeGenerator::DepthFirst;
+    option.braid = (t % 4) / 3.0f;
+    option.loops = (t % 5) * 0.05f;
+    auto maze = generator.generate(option);
+    for (int i = t * 7 % 11; i < WallIndex::SIZE; i += 11) {
+      const WallIndex wi(static_cast<uint16_t>(i));
+      if (wi.getPosition() == Position(0, 0)) continue;
+      maze.setWall(wi, false), maze.setKnown(wi, false);
+    }
+    /* ゴールにたどり着けない迷路 */
+    if (t == 4) maze.setWall(Position(0, 0), Direction::North, true);
+    EXPECT_EQ(batch.add(maze), mazes.size());
+    mazes.push_back(maze);
+  }
+  EXPECT_EQ(batch.size(), mazes.size());
+  EXPECT_EQ(batch.getGroupCount(), 3u);
+  StepMap stepMap;
+  for (const bool knownOnly : {true, false}) {
+    for (const bool simple : {true, false}) {
+      const auto routes =
+          batch.calcShortestDirections(stepMap, knownOnly, simple);
+      ASSERT_EQ(routes.size(), mazes.size());
+      for (size_t i = 0; i < mazes.size(); ++i) {
+        const auto& maze = mazes[i];
+        const auto expected =
+            stepMap.calcShortestDirections(maze, knownOnly, simple);
+        EXPECT_EQ(routes[i].directions, expected)
+            << i << " knownOnly: " << knownOnly << " simple: " << simple;
+        EXPECT_EQ(routes[i].cost,
+                  expected.empty() ? StepMap::STEP_MAX
+                                   : stepMap.calcDirectionsCost(expected,
+                                                                simple));
+      }
+      EXPECT_TRUE(routes[4].directions.empty());
+      /* 最後に更新したグループのステップは全区画で一致する */
+      const size_t group = batch.getGroupCount() - 1;
+      for (int lane = 0; lane < 5; ++lane) {
+        const auto& maze = mazes[group * MazeBatch::LANES + lane];
+        stepMap.update(maze, maze.getGoals(), knownOnly, simple);
+        for (int8_t x = 0; x < MAZE_SIZE; ++x)
+          for (int8_t y = 0; y < MAZE_SIZE; ++y)
+            EXPECT_EQ(batch.getStep(lane, Position(x, y)),
+                      stepMap.getStep(x, y));
+      }
+    }
+  }
+  batch.clear();
+  EXPECT_EQ(batch.size(), 0u);
+  EXPECT_TRUE(batch.calcShortestDirections(stepMap, true, false).empty());
+}
@@ -0,0 +1,134 @@
+/**
+ * @file test_maze_generator.cpp
+ * @brief Unit Test for MazeLib::MazeGenerator
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-18
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include "MazeLib/MazeGenerator.h"
+#include "MazeLib/StepMap.h"
+
+using namespace MazeLib;
+
+/**
+ * @brief 生成した迷路が競技規則の性質を満たすか確認する
+ */
+static void checkProperties(const Maze& maze, const MazeGenerator::Option& o) {
+  const int n = o.mazeSize;
+  /* スタート区画 */
+  EXPECT_EQ(maze.getStart(), Position(0, 0));
+  EXPECT_TRUE(maze.isWall(0, 0, Direction::East));
+  EXPECT_FALSE(maze.isWall(0, 0, Direction::North));
+  /* ゴール区画は内部に壁のない正方形 */
+  const auto& goals = maze.getGoals();
+  EXPECT_EQ(goals.size(), size_t(o.goalSize * o.goalSize));
+  for (const auto g : goals)
+    for (const auto d : Direction::Along4())
+      if (std::find(goals.cbegin(), goals.cend(), g.next(d)) != goals.cend())
+        EXPECT_FALSE(maze.isWall(g, d));
+  /* すべての壁が既知で、外周は壁 */
+  for (int8_t y = 0; y < n; ++y)
+    for (int8_t x = 0; x < n; ++x)
+      for (const auto d : Direction::Along4()) {
+        const auto p = Position(x, y);
+        EXPECT_TRUE(maze.isKnown(p, d) || !WallIndex(p, d).isInsideOfField());
+        const auto q = p.next(d);
+        if (q.x < 0 || q.y < 0 || q.x >= n || q.y >= n)
+          EXPECT_TRUE(maze.isWall(p, d));
+      }
+  /* すべての区画にスタートからたどり着ける */
+  StepMap stepMap;
+  stepMap.update(maze, {maze.getStart()}, true, true);
+  for (int8_t y = 0; y < n; ++y)
+    for (int8_t x = 0; x < n; ++x)
+      EXPECT_NE(stepMap.getStep(Position(x, y)), StepMap::STEP_MAX);
+  /* ゴール区画の内部以外の柱には壁が接する */
+  const auto isGoal = [&](const Position p) {
+    return std::find(goals.cbegin(), goals.cend(), p) != goals.cend();
+  };
+  for (int8_t y = 1; y < n; ++y)
+    for (int8_t x = 1; x < n; ++x) {
+      const auto p = Position(x, y);
+      if (isGoal(p) && isGoal(p + Position(-1, -1))) continue;
+      EXPECT_GE(MazeGenerator::pillarWallCount(maze, p), 1);
+    }
+}
+
+TEST(MazeGenerator, properties) {
+  MazeGenerator generator(123);
+  Maze maze;
+  for (const auto algorithm :
+       {MazeGenerator::DepthFirst, MazeGenerator::Kruskal})
+    for (const int n : {4, 8, 9, MAZE_SIZE})
+      for (const int goalSize : {0, 1, 2, 3})
+        for (const float braid : {0.0f, 0.5f, 1.0f}) {
+          if (goalSize >= n - 1) continue;  //< スタート区画と重なる
+          MazeGenerator::Option o;
+          o.mazeSize = n;
+          o.algorithm = algorithm;
+          o.goalSize = goalSize;
+          o.braid = braid;
+          o.loops = braid / 4;
+          ASSERT_TRUE(generator.generate(maze, o));
+          checkProperties(maze, o);
+          if (braid > 0) continue;
+          /* ループがなければ、ゴール区画を1つにまとめた全域木になる */
+          int openings = 0;
+          for (int8_t y = 0; y < n; ++y)
+            for (int8_t x = 0; x < n; ++x)
+              for (const auto d : {Direction::East, Direction::North})
+                openings += !maze.isWall(Position(x, y), d);
+          const int g = goalSize;
+          EXPECT_EQ(openings, (n * n - g * g + (g ? 1 : 0) - 1) +
+                                  2 * g * std::max(0, g - 1));
+        }
+}
+
+TEST(MazeGenerator, deterministic) {
+  MazeGenerator::Option o;
+  o.braid = 0.3f;
+  o.loops = 0.05f;
+  MazeGenerator a(7), b(7), c(8);
+  const auto mazeA = a.generate(o);
+  const auto mazeB = b.generate(o);
+  const auto mazeC = c.generate(o);
+  EXPECT_EQ(mazeA.getHash(), mazeB.getHash());
+  EXPECT_NE(mazeA.getHash(), mazeC.getHash());
+  /* 続けて生成すると別の迷路 */
+  EXPECT_NE(a.generate(o).getHash(), mazeA.getHash());
+  a.setSeed(7);
+  EXPECT_EQ(a.generate(o).getHash(), mazeA.getHash());
+  /* 表示した迷路を読み込むと同じ迷路 */
+  for (const int n : {9, MAZE_SIZE}) {
+    o.mazeSize = n;
+    o.goalSize = 3;
+    const auto maze = a.generate(o);
+    std::stringstream ss;
+    maze.print(ss, n);
+    Maze parsed;
+    ASSERT_TRUE(parsed.parse(ss));
+    EXPECT_EQ(parsed.getHash(), maze.getHash());
+    EXPECT_EQ(parsed.getGoals().size(), maze.getGoals().size());
+  }
+}
+
+TEST(MazeGenerator, invalidOption) {
+  MazeGenerator generator;
+  Maze maze;
+  MazeGenerator::Option o;
+  o.mazeSize = MAZE_SIZE + 1;
+  EXPECT_FALSE(generator.generate(maze, o));
+  o.mazeSize = 4;
+  o.goalSize = 4;
+  EXPECT_FALSE(generator.generate(maze, o));
+  /* スタート区画を含むゴール */
+  o.goalSize = 2;
+  o.goal = Position(0, 0);
+  EXPECT_FALSE(generator.generate(maze, o));
+  /* 範囲外のゴールは中央に配置する */
+  o.goal = Position(10, 10);
+  EXPECT_TRUE(generator.generate(maze, o));
+  EXPECT_EQ(maze.getGoals().front(), Position(1, 1));
+}
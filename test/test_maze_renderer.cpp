@@ -0,0 +1,117 @@
+/**
+ * @file test_maze_renderer.cpp
+ * @brief Unit Test for MazeLib::MazeRenderer
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-10
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include "MazeLib/MazeRenderer.h"
+#include "MazeLib/StepMap.h"
+#include "SampleMaze.h"
+
+using namespace MazeLib;
+
+TEST(MazeRenderer, renderMaze) {
+  const auto maze = getSampleMaze();
+  MazeRenderer renderer;
+  renderer.renderMaze(maze, 9);
+  /* 装飾なしの描画結果は迷路ファイルとして読み込める */
+  std::stringstream ss(renderer.getBuffer());
+  Maze parsed;
+  ss >> parsed;
+  EXPECT_EQ(parsed.getStart(), maze.getStart());
+  EXPECT_EQ(parsed.getGoals().size(), maze.getGoals().size());
+  for (int i = 0; i < WallIndex::SIZE; ++i) {
+    const auto wi = WallIndex(i);
+    if (wi.x < 9 && wi.y < 9) EXPECT_EQ(parsed.isWall(wi), maze.isWall(wi));
+  }
+  /* Maze::print と同じ結果 */
+  std::stringstream os;
+  maze.print(os, 9);
+  EXPECT_EQ(os.str(), renderer.getBuffer());
+}
+
+TEST(MazeRenderer, path) {
+  const auto maze = getSampleMaze();
+  StepMap stepMap;
+  const auto dirs = stepMap.calcShortestDirections(maze, true, true);
+  MazeRenderer renderer;
+  renderer.setPath(dirs, maze.getStart());
+  renderer.renderMazeColored(maze, 9);
+  std::stringstream os;
+  maze.print(dirs, maze.getStart(), os, 9);
+  EXPECT_EQ(os.str(), renderer.getBuffer());
+  /* 経路の方向が描画される */
+  EXPECT_NE(renderer.getBuffer().find(C_YE " ^ " C_NO), std::string::npos);
+  /* ハイライトのみ */
+  renderer.clear();
+  renderer.setHighlights({Position(1, 1)});
+  renderer.renderMazeColored(maze, 9);
+  os.str("");
+  maze.print({Position(1, 1)}, os, 9);
+  EXPECT_EQ(os.str(), renderer.getBuffer());
+}
+
+TEST(MazeRenderer, writeChanged) {
+  auto maze = getSampleMaze();
+  StepMap stepMap;
+  stepMap.update(maze, maze.getGoals(), false, true);
+  MazeRenderer renderer;
+  std::stringstream os;
+  renderer.renderStepMap(maze, stepMap);
+  /* 初回はすべての行を出力する */
+  EXPECT_EQ(renderer.writeChanged(os), 2 * MAZE_SIZE + 1);
+  /* 同じ描画なら出力しない */
+  const auto data = renderer.getBuffer().data();
+  renderer.renderStepMap(maze, stepMap);
+  EXPECT_EQ(renderer.writeChanged(os), 0);
+  /* 描画バッファは再利用される */
+  EXPECT_EQ(renderer.getBuffer().data(), data);
+  /* 変化した行のみ出力する */
+  renderer.setPath({Direction::North}, maze.getStart());
+  renderer.renderStepMap(maze, stepMap);
+  EXPECT_EQ(renderer.writeChanged(os), 1);
+  /* StepMap::print と同じ結果 */
+  os.str("");
+  stepMap.print(maze, {Direction::North}, maze.getStart(), os);
+  EXPECT_EQ(os.str(), renderer.getBuffer());
+  renderer.renderStepMap(maze, stepMap, true);
+  os.str("");
+  stepMap.printFull(maze, {Direction::North}, maze.getStart(), os);
+  EXPECT_EQ(os.str(), renderer.getBuffer());
+}
+
+TEST(MazeRenderer, printReuse) {
+  auto maze = getSampleMaze();
+  StepMap stepMap;
+  stepMap.update(maze, maze.getGoals(), false, true);
+  MazeRenderer renderer;
+  const auto data = renderer.getBuffer().data();
+  const Directions dirs = {Direction::North, Direction::North};
+  std::stringstream expected, actual;
+  /* 使い回しても、毎回確保する版と同じ結果 */
+  maze.print({Position(1, 1)}, expected, 9);
+  maze.print(renderer, {Position(1, 1)}, actual, 9);
+  EXPECT_EQ(actual.str(), expected.str());
+  /* 前回のハイライトは残らない */
+  expected.str(""), actual.str("");
+  maze.print(dirs, maze.getStart(), expected, 9);
+  maze.print(renderer, dirs, maze.getStart(), actual, 9);
+  EXPECT_EQ(actual.str(), expected.str());
+  expected.str(""), actual.str("");
+  maze.print(expected, 9);
+  maze.print(renderer, actual, 9);
+  EXPECT_EQ(actual.str(), expected.str());
+  expected.str(""), actual.str("");
+  stepMap.print(maze, dirs, maze.getStart(), expected);
+  stepMap.print(renderer, maze, dirs, maze.getStart(), actual);
+  EXPECT_EQ(actual.str(), expected.str());
+  expected.str(""), actual.str("");
+  stepMap.printFull(maze, dirs, maze.getStart(), expected);
+  stepMap.printFull(renderer, maze, dirs, maze.getStart(), actual);
+  EXPECT_EQ(actual.str(), expected.str());
+  /* 描画バッファは再利用される */
+  EXPECT_EQ(renderer.getBuffer().data(), data);
+}
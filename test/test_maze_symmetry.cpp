@@ -0,0 +1,122 @@
+/**
+ * @file test_maze_symmetry.cpp
+ * @brief Unit Test for MazeLib::MazeTransform, CanonicalMaze and MazeCorpus
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-17
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include "MazeLib/MazeCorpus.h"
+#include "MazeLib/StepMap.h"
+#include "SampleMaze.h"
+
+using namespace MazeLib;
+
+TEST(MazeTransform, apply) {
+  const int n = 9;
+  for (uint8_t i = 0; i < MazeTransform::SIZE; ++i) {
+    const MazeTransform t(i);
+    const auto inv = t.inverse();
+    for (int8_t x = 0; x < n; ++x)
+      for (int8_t y = 0; y < n; ++y) {
+        const Position p(x, y);
+        EXPECT_EQ(inv.apply(t.apply(p, n), n), p);
+        /* 隣接区画の関係は方向の変換と整合する */
+        for (const auto d : Direction::Along4())
+          EXPECT_EQ(t.apply(p.next(d), n), t.apply(p, n).next(t.apply(d)));
+      }
+  }
+  /* 転置と x 反転で 90度回転 */
+  const auto rot = MazeTransform(true, true, false);
+  EXPECT_EQ(rot.apply(Position(1, 0), n), Position(8, 1));
+  EXPECT_EQ(rot.apply(Direction(Direction::East)), Direction::North);
+}
+
+TEST(MazeBitPlanes, transpose) {
+  MazeBitPlanes::Plane plane{}, expected{};
+  for (int i = 0; i < MAZE_SIZE_MAX; ++i)
+    for (int j = 0; j < MAZE_SIZE_MAX; ++j)
+      if ((i * 7 + j * 3) % 5 == 0) {
+        plane[i] |= MazeBitPlanes::Row(1) << j;
+        expected[j] |= MazeBitPlanes::Row(1) << i;
+      }
+  MazeBitPlanes::transpose(plane);
+  EXPECT_EQ(plane, expected);
+  EXPECT_EQ(MazeBitPlanes::reverse(0b0011, 5), 0b11000u);
+}
+
+TEST(MazeTransform, applyMaze) {
+  const auto maze = getSampleMaze();
+  const int n = CanonicalMaze::estimateMazeSize(maze);
+  EXPECT_EQ(n, 9);
+  for (uint8_t i = 0; i < MazeTransform::SIZE; ++i) {
+    const MazeTransform t(i);
+    const auto transformed = t.apply(maze, n);
+    /* 壁の有無と既知未知がすべて対応する */
+    for (int8_t x = 0; x < n; ++x)
+      for (int8_t y = 0; y < n; ++y)
+        for (const auto d : Direction::Along4()) {
+          const Position p(x, y);
+          const auto q = t.apply(p, n);
+          const auto e = t.apply(d);
+          EXPECT_EQ(maze.isWall(p, d), transformed.isWall(q, e));
+          EXPECT_EQ(maze.isKnown(p, d), transformed.isKnown(q, e));
+        }
+    EXPECT_EQ(transformed.getStart(), t.apply(maze.getStart(), n));
+    /* 元に戻すと壁情報のハッシュ値も一致する */
+    EXPECT_EQ(t.inverse().apply(transformed, n).getHash(), maze.getHash());
+    /* 最短経路のコストは変わらない */
+    StepMap a, b;
+    a.update(maze, maze.getGoals(), true, false);
+    b.update(transformed, transformed.getGoals(), true, false);
+    EXPECT_EQ(a.getStep(maze.getStart()), b.getStep(transformed.getStart()));
+  }
+}
+
+TEST(CanonicalMaze, fromMaze) {
+  const auto maze = getSampleMaze();
+  const int n = 9;
+  const auto canonical = CanonicalMaze::fromMaze(maze, n);
+  for (uint8_t i = 0; i < MazeTransform::SIZE; ++i) {
+    const auto c = CanonicalMaze::fromMaze(MazeTransform(i).apply(maze, n), n);
+    EXPECT_EQ(c, canonical);
+    EXPECT_EQ(c.hash(), canonical.hash());
+  }
+  /* 壁1枚でも違えば別の迷路 */
+  auto changed = maze;
+  changed.setWall(Position(4, 4), Direction::North, true);
+  EXPECT_NE(CanonicalMaze::fromMaze(changed, n), canonical);
+  /* 正準形を元に戻すと元の迷路 */
+  const auto restored = canonical.transform.inverse().apply(
+      canonical.toMaze(), canonical.mazeSize);
+  EXPECT_EQ(restored.getHash(), maze.getHash());
+}
+
+TEST(MazeCorpus, add) {
+  const auto maze = getSampleMaze();
+  const int n = 9;
+  MazeCorpus corpus;
+  for (uint8_t i = 0; i < MazeTransform::SIZE; ++i) {
+    const auto transformed = MazeTransform(i).apply(maze, n);
+    const auto r = corpus.add(std::to_string(i), transformed, n);
+    EXPECT_EQ(r.first, 0u);
+    EXPECT_EQ(r.second, i == 0);
+  }
+  auto changed = maze;
+  changed.setWall(Position(4, 4), Direction::North, true);
+  EXPECT_EQ(corpus.find(changed, n), corpus.size());
+  EXPECT_TRUE(corpus.add("changed", changed, n).second);
+  EXPECT_EQ(corpus.size(), 2u);
+  EXPECT_EQ(corpus.getMemberCount(), 9u);
+  /* 元の迷路を復元できる */
+  for (uint8_t i = 0; i < MazeTransform::SIZE; ++i) {
+    const auto restored = corpus.restore(0, i);
+    const auto expected = MazeTransform(i).apply(maze, n);
+    EXPECT_EQ(restored.getHash(), expected.getHash());
+    EXPECT_EQ(restored.getStart(), expected.getStart());
+  }
+  EXPECT_EQ(corpus.find(MazeTransform(5).apply(maze, n), n), 0u);
+  corpus.clear();
+  EXPECT_EQ(corpus.size(), 0u);
+}
@@ -0,0 +1,101 @@
+/**
+ * @file test_motion_primitive.cpp
+ * @brief Unit Test for MazeLib::MotionCompiler
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-15
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include "MazeLib/MotionPrimitive.h"
+#include "MazeLib/StepMap.h"
+
+using namespace MazeLib;
+
+static std::string compile(const Directions& dirs, const bool diagEnabled) {
+  std::stringstream ss;
+  ss << MotionCompiler().compile(dirs, diagEnabled);
+  return ss.str();
+}
+
+TEST(MotionCompiler, compile) {
+  const auto N = Direction::North;
+  const auto E = Direction::East;
+  const auto S = Direction::South;
+  const auto W = Direction::West;
+  /* 直線 */
+  EXPECT_EQ(compile({N, N, N, N}, false), "S8");
+  EXPECT_EQ(compile({N, N, N, N}, true), "S8");
+  EXPECT_EQ(compile({}, true), "");
+  /* 90度ターン */
+  EXPECT_EQ(compile({N, N, E, E}, false), "S3 S90R S3");
+  EXPECT_EQ(compile({N, N, E, E}, true), "S3 F90R S3");
+  EXPECT_EQ(compile({N, W}, true), "S1 F90L S1");
+  /* 180度ターン */
+  EXPECT_EQ(compile({N, E, S}, false), "S1 S90R S90R S1");
+  EXPECT_EQ(compile({N, E, S}, true), "S1 F180R S1");
+  /* 45度ターンで斜めに入って抜ける */
+  EXPECT_EQ(compile({N, E, N, E, N, E, E}, true), "S1 F45R D5 F45R S3");
+  EXPECT_EQ(compile({N, E, N, E, N, E, E}, false),
+            "S1 S90R S90L S90R S90L S90R S3");
+  /* 135度ターンで斜めに入って抜ける */
+  EXPECT_EQ(compile({N, E, S, E, S, W}, true), "S1 F135R D3 F135R S1");
+  /* V90 ターン */
+  EXPECT_EQ(compile({N, N, E, N, E, S, E, S, S}, true),
+            "S3 F45R D3 FV90R D3 F45R S3");
+  /* 180度向きを変える移動は変換できない */
+  EXPECT_TRUE(MotionCompiler().compile({N, S}, true).empty());
+}
+
+TEST(MotionCompiler, time) {
+  const MotionCompiler compiler;
+  const auto& parameter = compiler.getParameter();
+  /* 直線は長いほど時間がかかり、平均速度は飽和速度を超えない */
+  float prev = 0;
+  for (int i = 1; i < 32; ++i) {
+    const auto t = compiler.calcStraightTime(parameter.seg * i);
+    EXPECT_GT(t, prev);
+    EXPECT_GT(t, parameter.seg * i / parameter.vm * 1000);
+    prev = t;
+  }
+  /* 既定値は StepMap のコストテーブルと同じ走行パラメータ */
+  using Profile = StepMap::TrapezoidProfile;
+  EXPECT_EQ(parameter.vs, Profile::vs);
+  EXPECT_EQ(parameter.am, Profile::am);
+  EXPECT_EQ(parameter.vm, Profile::vm);
+  EXPECT_EQ(parameter.seg, Profile::seg);
+  EXPECT_EQ(parameter.turnTime[MotionPrimitive::S90], Profile::t_turn);
+  /* 直線の時間は StepMap のコストテーブルと一致する */
+  StepMap stepMap;
+  for (int i = 2; i < MAZE_SIZE; ++i)
+    EXPECT_NEAR(stepMap.getStepTable()[i] * stepMap.getScalingFactor(),
+                parameter.turnTime[MotionPrimitive::S90] +
+                    compiler.calcStraightTime(parameter.seg * (i - 1)),
+                stepMap.getScalingFactor());
+  /* 斜めを使うと速くなる */
+  const Directions zigzag = {Direction::North, Direction::East,
+                             Direction::North, Direction::East,
+                             Direction::North, Direction::East,
+                             Direction::North, Direction::East};
+  const auto diag = compiler.compile(zigzag, true);
+  const auto along = compiler.compile(zigzag, false);
+  EXPECT_LT(MotionCompiler::calcTotalTime(diag),
+            MotionCompiler::calcTotalTime(along));
+  float sum = 0;
+  for (const auto& m : diag) sum += m.time;
+  EXPECT_FLOAT_EQ(MotionCompiler::calcTotalTime(diag), sum);
+}
+
+TEST(MotionCompiler, appendStraightDirections) {
+  /* ゴール区画内で斜めに延長した方向列も変換できる */
+  Maze maze;
+  maze.setGoals({Position(1, 1), Position(1, 2), Position(2, 1),
+                 Position(2, 2)});
+  Directions dirs = {Direction::North, Direction::East};
+  StepMap::appendStraightDirections(maze, dirs, false, true);
+  EXPECT_GT(dirs.size(), 2u);
+  const auto motions = MotionCompiler().compile(dirs, true);
+  EXPECT_FALSE(motions.empty());
+  EXPECT_EQ(motions.front().type, MotionPrimitive::Straight);
+  EXPECT_EQ(motions.back().type, MotionPrimitive::Straight);
+}
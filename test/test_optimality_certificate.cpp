@@ -0,0 +1,99 @@
+/**
+ * @file test_optimality_certificate.cpp
+ * @brief Unit Test for MazeLib::OptimalityCertificate
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-09
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include "MazeLib/ExplorationPlanner.h"
+#include "MazeLib/OptimalityCertificate.h"
+#include "SampleMaze.h"
+
+using namespace MazeLib;
+
+/* 全区画の下限と上限が一致するか */
+static void expectSameSteps(const OptimalityCertificate& c1,
+                            const OptimalityCertificate& c2) {
+  for (int i = 0; i < Position::SIZE; ++i) {
+    const auto p = Position::getPositionFromIndex(i);
+    ASSERT_EQ(c1.getLowerStep(p), c2.getLowerStep(p)) << p;
+    ASSERT_EQ(c1.getUpperStep(p), c2.getUpperStep(p)) << p;
+  }
+}
+
+TEST(OptimalityCertificate, certify) {
+  const auto mazeTarget = getSampleMaze();
+  StepMap stepMap;
+  for (const auto simple : {true, false}) {
+    OptimalityCertificate certificate(simple);
+    /* 既知の迷路では最短 */
+    const auto result = certificate.certify(mazeTarget);
+    EXPECT_EQ(result.status, OptimalityCertificate::Optimal);
+    EXPECT_EQ(result.lower, result.upper);
+    stepMap.update(mazeTarget, mazeTarget.getGoals(), true, simple);
+    EXPECT_LE(result.upper, stepMap.getStep(mazeTarget.getStart()));
+    /* 未知の迷路では上限なし */
+    Maze maze;
+    maze.setGoals(mazeTarget.getGoals());
+    certificate.reset();
+    const auto unknown = certificate.certify(maze, 1e3f);
+    EXPECT_EQ(unknown.status, OptimalityCertificate::Unproven);
+    EXPECT_EQ(unknown.upper, StepMap::STEP_MAX);
+    EXPECT_LT(unknown.lower, unknown.upper);
+    /* 経路がない場合 */
+    Maze mazeBlocked = mazeTarget;
+    mazeBlocked.setGoals({Position(-1, -1)});
+    EXPECT_EQ(certificate.certify(mazeBlocked).status,
+              OptimalityCertificate::NoPath);
+  }
+}
+
+TEST(OptimalityCertificate, incremental) {
+  const auto mazeTarget = getSampleMaze();
+  for (const auto simple : {true, false}) {
+    Maze maze;
+    maze.setGoals(mazeTarget.getGoals());
+    OptimalityCertificate certificate(simple);
+    ExplorationPlanner planner;
+    StepMap stepMap;
+    Pose pose(maze.getStart(), Direction::North);
+    Position target = maze.getGoals().front();
+    bool withinTolerance = false;
+    for (int count = 0;; ++count) {
+      ASSERT_LT(count, 9 * 9);
+      /* 壁を確認 */
+      for (const auto d : {Direction::Front, Direction::Left, Direction::Right})
+        maze.updateWall(pose.p, pose.d + d,
+                        mazeTarget.isWall(pose.p, pose.d + d));
+      /* 差分の取り込みと全体の再計算の結果が一致する */
+      const auto result = certificate.certify(maze, 0.5f);
+      OptimalityCertificate fresh(simple);
+      fresh.certify(maze);
+      expectSameSteps(certificate, fresh);
+      ASSERT_LE(result.lower, result.upper);
+      if (result.status == OptimalityCertificate::WithinTolerance)
+        withinTolerance = true;
+      if (result.status == OptimalityCertificate::Optimal) break;
+      /* 次の目的地へ未知壁を含む区画に当たるまで進む */
+      if (maze.unknownCount(target) == 0 &&
+          !planner.selectTarget(maze, pose.p, target))
+        target = maze.getGoals().front();
+      const auto dirs =
+          stepMap.calcShortestDirections(maze, pose.p, {target}, false, true);
+      ASSERT_FALSE(dirs.empty());
+      for (const auto d : dirs) {
+        pose = pose.next(d);
+        if (maze.unknownCount(pose.p)) break;
+      }
+    }
+    EXPECT_TRUE(withinTolerance);
+    /* 壁ログの削除後も全体の再計算の結果と一致する */
+    maze.resetLastWalls(10);
+    certificate.certify(maze);
+    OptimalityCertificate fresh(simple);
+    fresh.certify(maze);
+    expectSameSteps(certificate, fresh);
+  }
+}
@@ -0,0 +1,87 @@
+/**
+ * @file test_search_simulator.cpp
+ * @brief Unit Test for MazeLib::SearchSimulator
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-12
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include "MazeLib/SearchSimulator.h"
+
+using namespace MazeLib;
+
+TEST(SearchSimulator, run) {
+  std::stringstream maze_stream;
+  maze_stream << R"(
++---+---+---+---+---+---+---+---+---+
+|               |                   |
++   +---+   +   +   +---+---+---+   +
+|       |   |   |   |               |
++---+   +   +   +   +   +---+---+---+
+|       |   |       |               |
++   +---+   +---+---+---+---+---+   +
+|       |   | G   G   G |           |
++---+   +   +   +   +   +   +---+---+
+|       |   | G   G   G |           |
++   +---+   +   +   +   +---+---+   +
+|       |   | G   G   G |       |   |
++---+   +   +   +---+---+   +   +   +
+|       |   |   |       |   |   |   |
++   +   +   +   +   +   +   +   +   +
+|       |   |   |   |   |   |   |   |
++   +   +   +   +   +   +   +   +   +
+| S |       |       |       |       |
++---+---+---+---+---+---+---+---+---+
+)";
+  Maze mazeTarget;
+  maze_stream >> mazeTarget;
+  /* 正解の迷路の最短経路 */
+  StepMap stepMap;
+  const auto expected = stepMap.calcShortestDirections(mazeTarget, true, false);
+  ASSERT_FALSE(expected.empty());
+  /* 探索後の最短経路は正解の迷路の最短経路と同じコストとなる */
+  SearchSimulator simulator;
+  for (int i = 0; i < 2; ++i) {
+    const auto result = simulator.run(mazeTarget);
+    EXPECT_TRUE(result.success);
+    EXPECT_GT(result.moves, 0);
+    EXPECT_EQ(result.shortestCost,
+              stepMap.calcDirectionsCost(expected, false));
+    EXPECT_EQ(simulator.getMaze().getStart(), mazeTarget.getStart());
+  }
+  /* どの方針でも最短経路が得られる */
+  for (const auto order :
+       {StepMap::CostOnly, StepMap::UnknownFirst, StepMap::StraightFirst})
+    for (const bool simple : {true, false})
+      for (const bool knownOnly : {true, false}) {
+        SearchSimulator::Strategy strategy;
+        strategy.candidateOrder = order;
+        strategy.simple = simple;
+        strategy.knownOnly = knownOnly;
+        simulator.setStrategy(strategy);
+        const auto result = simulator.run(mazeTarget);
+        EXPECT_TRUE(result.success);
+        EXPECT_EQ(result.shortestCost,
+                  stepMap.calcDirectionsCost(expected, false));
+      }
+  /* 雑音を加えても同じ種なら同じ結果となり、多くの試行で復帰できる */
+  simulator.setStrategy(SearchSimulator::Strategy());
+  SearchSimulator::Noise noise;
+  noise.misread = 0.01f;
+  noise.slip = 0.01f;
+  int successes = 0, misreads = 0;
+  for (uint32_t seed = 0; seed < 20; ++seed) {
+    noise.seed = seed;
+    simulator.setNoise(noise);
+    const auto result = simulator.run(mazeTarget);
+    const auto again = simulator.run(mazeTarget);
+    EXPECT_EQ(result.moves, again.moves);
+    EXPECT_EQ(result.recomputes, again.recomputes);
+    EXPECT_EQ(result.shortestDirections, again.shortestDirections);
+    successes += result.success;
+    misreads += result.misreads;
+  }
+  EXPECT_GT(misreads, 0);
+  EXPECT_GE(successes, 15);
+}
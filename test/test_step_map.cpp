@@ -0,0 +1,392 @@
+/**
+ * @file test_step_map.cpp
+ * @brief Unit Test for MazeLib::StepMap
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-01
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <queue>
+
+#include "MazeLib/MazeGenerator.h"
+#include "MazeLib/StepMap.h"
+#include "MazeLib/StepMapCache.h"
+#include "SampleMaze.h"
+
+using namespace MazeLib;
+
+/* 方向列が壁を通過せずに目的地に到達するか */
+static bool isValidPath(const Maze& maze, Position p, const Directions& dirs,
+                        const Positions& dest) {
+  for (const auto d : dirs) {
+    if (!maze.canGo(p, d)) return false;
+    p = p.next(d);
+  }
+  return std::find(dest.cbegin(), dest.cend(), p) != dest.cend();
+}
+
+/**
+ * @brief StepMap と同じコストの模型による全区画のステップの参照実装
+ * @details 直線で行ける区画すべてに辺を張った素朴なダイクストラ法
+ */
+static std::vector<int> calcReferenceSteps(const Maze& maze,
+                                           const StepMap& stepMap,
+                                           const bool knownOnly,
+                                           const bool simple) {
+  const auto& goals = maze.getGoals();
+  const auto isGoal = [&](const Position p) {
+    return std::find(goals.cbegin(), goals.cend(), p) != goals.cend();
+  };
+  /* ゴール区画 g に向き d で進入する i 区画の直線のコスト */
+  const auto calcEntryStep = [&](const Position g, const Direction d,
+                                 const int i) {
+    int room = 0;
+    auto p = g;
+    while (room < 3 && maze.canGo(WallIndex(p, d), knownOnly) &&
+           isGoal(p.next(d)))
+      p = p.next(d), ++room;
+    return stepMap.calcDirectionsCost(Directions(i + room, d), false, room);
+  };
+  const bool braking = stepMap.isGoalBraking() && !simple;
+  std::vector<int> steps(Position::SIZE, StepMap::STEP_MAX);
+  using Element = std::pair<int, uint16_t>;
+  std::priority_queue<Element, std::vector<Element>, std::greater<Element>> q;
+  for (const auto p : maze.getGoals())
+    steps[p.getIndex()] = 0, q.push({0, p.getIndex()});
+  while (!q.empty()) {
+    const auto [step, index] = q.top();
+    q.pop();
+    if (step > steps[index]) continue;
+    const auto p = Position::getPositionFromIndex(index);
+    for (const auto d : Direction::Along4()) {
+      auto next = p;
+      for (int i = 1; maze.canGo(WallIndex(next, d), knownOnly); ++i) {
+        next = next.next(d);
+        int edge = simple ? i : stepMap.getStepTable()[i];
+        if (braking && step == 0)
+          edge = calcEntryStep(p, d + Direction::Back, i);
+        const int s = step + edge;
+        if (s < steps[next.getIndex()])
+          steps[next.getIndex()] = s, q.push({s, next.getIndex()});
+      }
+    }
+  }
+  return steps;
+}
+
+TEST(StepMap, optimality) {
+  /* 生成した迷路の一部の壁を未知にして、参照実装と全区画で比較する */
+  MazeGenerator generator(2023);
+  StepMap stepMap;
+  for (int t = 0; t < 40; ++t) {
+    MazeGenerator::Option option;
+    option.algorithm =
+        t % 2 ? MazeGenerator::Kruskal : MazeGenerator::DepthFirst;
+    option.braid = (t % 4) / 3.0f;
+    option.loops = (t % 3) * 0.1f;
+    auto maze = generator.generate(option);
+    for (int i = t * 7 % 13; i < WallIndex::SIZE; i += 13) {
+      const WallIndex wi(static_cast<uint16_t>(i));
+      if (wi.getPosition() == Position(0, 0)) continue;
+      maze.setWall(wi, false), maze.setKnown(wi, false);
+    }
+    for (const bool knownOnly : {true, false}) {
+      for (const bool simple : {true, false}) {
+        stepMap.update(maze, maze.getGoals(), knownOnly, simple);
+        const auto expected =
+            calcReferenceSteps(maze, stepMap, knownOnly, simple);
+        for (int8_t x = 0; x < MAZE_SIZE; ++x)
+          for (int8_t y = 0; y < MAZE_SIZE; ++y) {
+            const auto p = Position(x, y);
+            EXPECT_EQ(stepMap.getStep(p), expected[p.getIndex()])
+                << p << " knownOnly: " << knownOnly << " simple: " << simple;
+          }
+        /* 導出した経路のコストは始点のステップに等しい */
+        const auto dirs =
+            stepMap.calcShortestDirections(maze, knownOnly, simple);
+        if (dirs.empty()) continue;
+        EXPECT_EQ(stepMap.calcDirectionsCost(dirs, simple),
+                  expected[maze.getStart().getIndex()]);
+      }
+    }
+  }
+}
+
+TEST(StepMap, calcShortestDirections) {
+  const auto maze = getSampleMaze();
+  StepMap stepMap;
+  for (const auto simple : {true, false}) {
+    const auto dirs = stepMap.calcShortestDirections(maze, true, simple);
+    EXPECT_FALSE(dirs.empty());
+    EXPECT_TRUE(isValidPath(maze, maze.getStart(), dirs, maze.getGoals()));
+    EXPECT_EQ(stepMap.getStep(maze.getStart()),
+              stepMap.calcDirectionsCost(dirs, simple));
+  }
+}
+
+TEST(StepMap, calcKShortestDirections) {
+  const auto maze = getSampleMaze();
+  StepMap stepMap;
+  for (const auto simple : {true, false}) {
+    const auto shortest = stepMap.calcShortestDirections(maze, true, simple);
+    const auto routes = stepMap.calcKShortestDirections(
+        maze, maze.getStart(), maze.getGoals(), 8, true, simple);
+    ASSERT_FALSE(routes.empty());
+    EXPECT_LE(routes.size(), 8u);
+    EXPECT_EQ(routes.front().directions, shortest);
+    for (size_t i = 0; i < routes.size(); ++i) {
+      const auto& route = routes[i];
+      EXPECT_TRUE(isValidPath(maze, maze.getStart(), route.directions,
+                              maze.getGoals()));
+      EXPECT_EQ(route.cost,
+                stepMap.calcDirectionsCost(route.directions, simple));
+      for (size_t j = 0; j < i; ++j) {
+        EXPECT_LE(routes[j].cost, route.cost);
+        EXPECT_NE(routes[j].directions, route.directions);
+      }
+    }
+    /* 最短経路のステップマップが残っている */
+    EXPECT_EQ(stepMap.getStep(maze.getStart()), routes.front().cost);
+  }
+  /* 経路がない場合 */
+  EXPECT_TRUE(stepMap
+                  .calcKShortestDirections(maze, maze.getStart(),
+                                           {Position(-1, -1)}, 3, true, true)
+                  .empty());
+}
+
+TEST(StepMap, calcShortestDirectionsAstar) {
+  const auto maze = getSampleMaze();
+  StepMap stepMap, stepMapAstar;
+  /* 直線コストの劣加法性 (ヒューリスティックの許容性の前提) */
+  for (int a = 1; a < MAZE_SIZE; ++a)
+    for (int b = 1; a + b < MAZE_SIZE; ++b)
+      EXPECT_GE(stepMap.calcDirectionsCost(Directions(a), false) +
+                    stepMap.calcDirectionsCost(Directions(b), false),
+                stepMap.calcDirectionsCost(Directions(a + b), false));
+  for (const auto simple : {true, false}) {
+    for (int8_t x = 0; x < 9; ++x) {
+      for (int8_t y = 0; y < 9; ++y) {
+        const auto start = Position(x, y);
+        const auto dest = Positions{maze.getStart()};
+        stepMap.update(maze, dest, true, simple);
+        const auto dirs = stepMapAstar.calcShortestDirectionsAstar(
+            maze, start, dest, true, simple);
+        const auto step = stepMapAstar.getStep(start);
+        EXPECT_TRUE(isValidPath(maze, start, dirs, dest));
+        EXPECT_EQ(step, stepMapAstar.calcDirectionsCost(dirs, simple));
+        /* 全展開の結果と一致する */
+        EXPECT_EQ(step, stepMap.getStep(start));
+      }
+    }
+  }
+  EXPECT_TRUE(stepMapAstar
+                  .calcShortestDirectionsAstar(maze, Position(-1, 0),
+                                               maze.getGoals(), true, true)
+                  .empty());
+}
+
+TEST(StepMap, earlyExit) {
+  const auto maze = getSampleMaze();
+  StepMap stepMap, stepMapFull;
+  /* 既定では打ち切らない */
+  EXPECT_EQ(stepMapFull.getEarlyExitMargin(), StepMap::STEP_MAX);
+  stepMap.setEarlyExitMargin(0);
+  for (const auto simple : {true, false}) {
+    for (int8_t x = 0; x < 9; ++x) {
+      for (int8_t y = 0; y < 9; ++y) {
+        const auto start = Position(x, y);
+        const auto dirs = stepMap.calcShortestDirections(
+            maze, start, maze.getGoals(), false, simple);
+        const auto dirsFull = stepMapFull.calcShortestDirections(
+            maze, start, maze.getGoals(), false, simple);
+        EXPECT_TRUE(stepMapFull.isComplete());
+        /* 打ち切っても同じ経路が得られる */
+        EXPECT_EQ(dirs, dirsFull);
+        EXPECT_TRUE(stepMap.isSettled(start));
+        /* 確定済みの区画のステップは全展開の結果と一致する */
+        for (int i = 0; i < Position::SIZE; ++i) {
+          const auto p = Position::getPositionFromIndex(i);
+          if (stepMap.isSettled(p))
+            EXPECT_EQ(stepMap.getStep(p), stepMapFull.getStep(p));
+          else
+            EXPECT_FALSE(stepMap.isComplete());
+        }
+      }
+    }
+  }
+  /* ゴールから離れた区画からの導出では、始点より先で打ち切りが起こる */
+  for (const auto simple : {true, false}) {
+    stepMapFull.update(maze, maze.getGoals(), false, simple);
+    /* 始点はステップが最大値の半分に最も近い区画とする */
+    int maxStep = 0;
+    for (const auto step : stepMapFull.getMapArray())
+      if (step != StepMap::STEP_MAX) maxStep = std::max<int>(maxStep, step);
+    auto start = maze.getStart();
+    for (int i = 0; i < Position::SIZE; ++i) {
+      const auto p = Position::getPositionFromIndex(i);
+      if (std::abs(stepMapFull.getStep(p) - maxStep / 2) <
+          std::abs(stepMapFull.getStep(start) - maxStep / 2))
+        start = p;
+    }
+    const int startStep = stepMapFull.getStep(start);
+    ASSERT_GT(startStep, 0);
+    const auto dirsFull = stepMapFull.calcShortestDirections(
+        maze, start, maze.getGoals(), false, simple);
+    for (const int margin : {0, maxStep / 4}) {
+      stepMap.setEarlyExitMargin(margin);
+      const auto dirs = stepMap.calcShortestDirections(
+          maze, start, maze.getGoals(), false, simple);
+      EXPECT_FALSE(stepMap.isComplete());
+      EXPECT_GE(stepMap.getSettledStep(), startStep + margin);
+      EXPECT_EQ(stepMap.calcDirectionsCost(dirs, simple),
+                stepMapFull.calcDirectionsCost(dirsFull, simple));
+    }
+  }
+  stepMap.setEarlyExitMargin(0);
+  /* 以降は始点 (3, 3) で打ち切ったステップマップで候補を確認する */
+  stepMap.calcShortestDirections(maze, Position(3, 3), maze.getGoals(), false,
+                                 true);
+  /* 部分的なステップマップでも未確定の隣接区画を候補とする */
+  const auto candidates = stepMap.getNextDirectionCandidates(
+      maze, {Position(3, 3), Direction::North});
+  EXPECT_FALSE(candidates.empty());
+  /* コストのみの並べ替えではステップの昇順、既定では直進が先頭 */
+  const Pose focus(Position(3, 3), Direction::North);
+  const auto costOnly =
+      stepMap.getNextDirectionCandidates(maze, focus, StepMap::CostOnly);
+  for (size_t i = 1; i < costOnly.size(); ++i)
+    EXPECT_LE(stepMap.getStep(focus.p.next(costOnly[i - 1])),
+              stepMap.getStep(focus.p.next(costOnly[i])));
+  if (!maze.isWall(focus.p, focus.d)) EXPECT_EQ(candidates[0], focus.d);
+  /* 並べ替えの方針によらず候補の集合は同じ */
+  for (const auto order : {StepMap::CostOnly, StepMap::UnknownFirst}) {
+    const auto c = stepMap.getNextDirectionCandidates(
+        maze, {Position(3, 3), Direction::North}, order);
+    Directions others(c.begin(), c.end());
+    Directions sorted(candidates.begin(), candidates.end());
+    std::sort(others.begin(), others.end());
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(others, sorted);
+  }
+  ::testing::internal::CaptureStdout();
+  stepMap.print(maze, Position(3, 3), Direction::North);
+  stepMap.printFull(maze, Position(3, 3), Direction::North);
+  ::testing::internal::GetCapturedStdout();
+}
+
+TEST(StepMap, goalBraking) {
+  /* ゴール領域に進入するまでの時間を最小化し、末尾で減速して停止する */
+  MazeGenerator generator(2024);
+  StepMap stepMap, braking, astar;
+  EXPECT_FALSE(stepMap.isGoalBraking());
+  braking.setGoalBraking(true);
+  astar.setGoalBraking(true);
+  StepMapCache cache;
+  int improved = 0;
+  for (int t = 0; t < 20; ++t) {
+    MazeGenerator::Option option;
+    option.goalSize = 3;
+    option.braid = (t % 3) / 2.0f;
+    option.loops = (t % 4) * 0.05f;
+    const auto maze = generator.generate(option);
+    const auto start = maze.getStart();
+    const auto& goals = maze.getGoals();
+    /* 最初に進入したゴール区画より後の区画の数 */
+    const auto countBrakeCells = [&](const Directions& dirs) {
+      size_t entry = 0;
+      auto p = start;
+      while (entry < dirs.size() &&
+             std::find(goals.cbegin(), goals.cend(), p) == goals.cend())
+        p = p.next(dirs[entry++]);
+      for (size_t i = entry; i < dirs.size(); ++i)
+        EXPECT_EQ(dirs[i], dirs[entry - 1]);  //< 進入した向きのまま停止
+      return static_cast<int>(dirs.size() - entry);
+    };
+    /* 全区画のステップが参照実装と一致する */
+    braking.update(maze, goals, true, false);
+    const auto expected = calcReferenceSteps(maze, braking, true, false);
+    for (int i = 0; i < Position::SIZE; ++i)
+      EXPECT_EQ(braking.getStep(Position::getPositionFromIndex(i)),
+                expected[i]);
+    /* 経路のコストは始点のステップに等しく、減速を考慮しない場合以下 */
+    const auto dirs = braking.calcShortestDirections(maze, true, false);
+    const auto plain = stepMap.calcShortestDirections(maze, true, false);
+    ASSERT_FALSE(dirs.empty());
+    EXPECT_TRUE(isValidPath(maze, start, dirs, goals));
+    const int brake = countBrakeCells(dirs);
+    EXPECT_LT(brake, 4);
+    const auto step = braking.getStep(start);
+    EXPECT_EQ(step, braking.calcDirectionsCost(dirs, false, brake));
+    EXPECT_LE(step, stepMap.getStep(start));
+    improved += step < stepMap.getStep(start);
+    /* A* とキャッシュでも同じコストの経路となる */
+    const auto astarDirs =
+        astar.calcShortestDirectionsAstar(maze, start, goals, true, false);
+    EXPECT_EQ(astar.calcDirectionsCost(astarDirs, false,
+                                       countBrakeCells(astarDirs)),
+              step);
+    EXPECT_EQ(cache.calcShortestDirections(braking, maze, true, false), dirs);
+    EXPECT_EQ(cache.calcShortestDirections(stepMap, maze, true, false), plain);
+    /* simple と k 最短経路では考慮しない */
+    EXPECT_EQ(braking.calcShortestDirections(maze, true, true),
+              stepMap.calcShortestDirections(maze, true, true));
+    const auto routes =
+        braking.calcKShortestDirections(maze, start, goals, 1, true, false);
+    ASSERT_EQ(routes.size(), 1u);
+    EXPECT_EQ(routes[0].directions, plain);
+    EXPECT_TRUE(braking.isGoalBraking());
+  }
+  EXPECT_GT(improved, 0);
+}
+
+TEST(StepMap, tieBreak) {
+  /* 壁のない既知の迷路では、同じステップの経路が多数ある */
+  Maze maze;
+  for (int i = 0; i < Position::SIZE; ++i)
+    for (const auto d : Direction::Along4()) {
+      const auto p = Position::getPositionFromIndex(i);
+      maze.updateWall(p, d, !WallIndex(p, d).isInsideOfField());
+    }
+  const auto E = Direction::East;
+  const auto N = Direction::North;
+  const auto calc = [&](const StepMap::TieBreak tieBreak) {
+    StepMap stepMap;
+    stepMap.setTieBreak(tieBreak);
+    EXPECT_EQ(stepMap.getTieBreak(), tieBreak);
+    stepMap.update(maze, {Position(3, 3)}, false, true);
+    Pose end;
+    const auto dirs = stepMap.getStepDownDirections(
+        maze, {Position(0, 0), N}, end, false, true, false);
+    EXPECT_EQ(end.p, Position(3, 3));
+    return dirs;
+  };
+  EXPECT_EQ(StepMap().getTieBreak(), StepMap::FirstFound);
+  EXPECT_EQ(calc(StepMap::FirstFound), Directions({E, E, E, N, N, N}));
+  EXPECT_EQ(calc(StepMap::PreferStraight), Directions({N, N, N, E, E, E}));
+  EXPECT_EQ(calc(StepMap::FewerTurns), Directions({N, N, N, E, E, E}));
+  EXPECT_EQ(calc(StepMap::PreferZigzag), Directions({E, N, E, N, E, N}));
+  /* 未知壁を含む区画を避ける */
+  maze.setKnown(Position(0, 1), E, false);
+  EXPECT_EQ(calc(StepMap::PreferKnown), Directions({E, E, E, N, N, N}));
+  /* 生成した迷路でも、どの方針でも経路のコストは変わらない */
+  MazeGenerator generator(2025);
+  for (int t = 0; t < 10; ++t) {
+    MazeGenerator::Option option;
+    option.loops = 0.3f;
+    const auto mazeTarget = generator.generate(option);
+    const bool simple = t % 2;
+    for (int k = StepMap::FirstFound; k <= StepMap::PreferZigzag; ++k) {
+      StepMap stepMap;
+      stepMap.setTieBreak(static_cast<StepMap::TieBreak>(k));
+      const auto dirs =
+          stepMap.calcShortestDirections(mazeTarget, true, simple);
+      EXPECT_TRUE(isValidPath(mazeTarget, mazeTarget.getStart(), dirs,
+                              mazeTarget.getGoals()));
+      EXPECT_EQ(stepMap.calcDirectionsCost(dirs, simple),
+                stepMap.getStep(mazeTarget.getStart()));
+    }
+  }
+}
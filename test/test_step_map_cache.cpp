@@ -0,0 +1,84 @@
+/**
+ * @file test_step_map_cache.cpp
+ * @brief Unit Test for MazeLib::StepMapCache and Maze::getHash
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-16
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#include <gtest/gtest.h>
+
+#include "MazeLib/StepMapCache.h"
+#include "SampleMaze.h"
+
+using namespace MazeLib;
+
+TEST(Maze, getHash) {
+  const auto mazeTarget = getSampleMaze();
+  EXPECT_EQ(mazeTarget.getHash(), mazeTarget.calcHash());
+  Maze maze;
+  maze.reset(false);
+  EXPECT_EQ(maze.getHash(), 0u);
+  /* 差分更新したハッシュは全体から計算したものと一致する */
+  for (const auto wr : mazeTarget.getWallRecords()) {
+    maze.updateWall(wr.getPosition(), wr.getDirection(), wr.b);
+    EXPECT_EQ(maze.getHash(), maze.calcHash());
+  }
+  /* 同じ壁情報なら更新の順序によらず同じ値となる */
+  Maze reversed;
+  reversed.reset(false);
+  const auto& records = mazeTarget.getWallRecords();
+  for (auto it = records.rbegin(); it != records.rend(); ++it)
+    reversed.updateWall(it->getPosition(), it->getDirection(), it->b);
+  EXPECT_EQ(reversed.getHash(), maze.getHash());
+  /* 壁を変えると値が変わり、戻すと元に戻る */
+  const auto hash = maze.getHash();
+  const WallIndex i(Position(1, 1), Direction::North);
+  maze.setWall(i, !maze.isWall(i));
+  EXPECT_NE(maze.getHash(), hash);
+  maze.setWall(i, !maze.isWall(i));
+  EXPECT_EQ(maze.getHash(), hash);
+  /* 矛盾による未知壁への戻しも反映される */
+  maze.updateWall(i.getPosition(), i.getDirection(), !maze.isWall(i));
+  EXPECT_NE(maze.getHash(), hash);
+  EXPECT_EQ(maze.getHash(), maze.calcHash());
+}
+
+TEST(StepMapCache, update) {
+  const auto maze = getSampleMaze();
+  StepMapCache cache;
+  StepMap stepMap, expected;
+  for (const bool knownOnly : {true, false})
+    for (const bool simple : {true, false}) {
+      /* 初回はキャッシュになく、2回目はキャッシュから復元する */
+      EXPECT_FALSE(cache.update(stepMap, maze, maze.getGoals(), knownOnly,
+                                simple));
+      stepMap.reset();
+      EXPECT_TRUE(
+          cache.update(stepMap, maze, maze.getGoals(), knownOnly, simple));
+      expected.update(maze, maze.getGoals(), knownOnly, simple);
+      EXPECT_EQ(stepMap.getMapArray(), expected.getMapArray());
+      EXPECT_TRUE(stepMap.isComplete());
+      /* 最短経路は StepMap と同じ */
+      EXPECT_EQ(cache.calcShortestDirections(stepMap, maze, knownOnly, simple),
+                expected.calcShortestDirections(maze, knownOnly, simple));
+    }
+  EXPECT_EQ(cache.getMisses(), 4);
+  EXPECT_EQ(cache.size(), 4u);
+  /* 目的地の順序によらず同じキーとなる */
+  auto goals = maze.getGoals();
+  std::reverse(goals.begin(), goals.end());
+  EXPECT_TRUE(cache.update(stepMap, maze, goals, true, false));
+  /* 壁が変われば別のキーとなる */
+  auto changed = maze;
+  changed.updateWall(Position(8, 8), Direction::West, true);
+  EXPECT_FALSE(cache.update(stepMap, changed, goals, true, false));
+  /* 予算を超えると最も長く使われていないものから捨てる */
+  StepMapCache small(0);
+  EXPECT_EQ(small.getCapacity(), 1u);
+  EXPECT_FALSE(small.update(stepMap, maze, goals, true, false));
+  EXPECT_FALSE(small.update(stepMap, maze, goals, false, false));
+  EXPECT_FALSE(small.update(stepMap, maze, goals, true, false));
+  EXPECT_EQ(small.size(), 1u);
+  small.clear();
+  EXPECT_EQ(small.size(), 0u);
+}
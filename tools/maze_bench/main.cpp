@@ -0,0 +1,107 @@
+/**
+ * @file main.cpp
+ * @brief 壁情報の保持形式ごとに迷路の基本操作の速度を測るツール
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-21
+ * @details
+ * MazeGenerator で生成した迷路の一部の壁を未知にして、
+ * 壁の参照、区画ごとの壁と未知壁の数え上げ、StepMap::update() の1回あたりの時間を表示する。
+ * maze_bench はライブラリと同じ保持形式 (CMake の MAZE_CELL_STORAGE)、
+ * maze_bench_cell は常に区画ごとの保持形式でビルドされるので、両者を比べる。
+ * チェックサムは保持形式によらず一致する。
+ *
+ * 使い方: maze_bench [-n count] [-s seed]
+ */
+#include <chrono>
+#include <cstring>  //< for std::strcmp
+
+#include "MazeLib/MazeGenerator.h"
+#include "MazeLib/StepMap.h"
+
+using namespace MazeLib;
+
+/** @brief 関数を count 回呼んだときの1回あたりの時間 [ns] */
+template <typename F>
+static double measure(const int count, F&& f) {
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; ++i) f(i);
+  const auto t1 = std::chrono::steady_clock::now();
+  const auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+  return static_cast<double>(ns) / count;
+}
+
+int main(int argc, char* argv[]) {
+  /* 引数の解析 */
+  int count = 256;
+  uint64_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "-n") && i + 1 < argc)
+      count = std::max(1, std::atoi(argv[++i]));
+    else if (!std::strcmp(argv[i], "-s") && i + 1 < argc)
+      seed = std::strtoull(argv[++i], nullptr, 0);
+    else {
+      std::cerr << "usage: " << argv[0] << " [-n count] [-s seed]"
+                << std::endl;
+      return -1;
+    }
+  }
+  /* 迷路の生成。探索途中を模して、区画の半分ほどの壁を未知にする */
+  MazeGenerator generator(seed);
+  MazeGenerator::Option option;
+  option.loops = 0.1f;
+  std::vector<Maze> mazes(count);
+  for (int n = 0; n < count; ++n) {
+    auto& maze = mazes[n];
+    generator.generate(maze, option);
+    for (int i = n % 2; i < WallIndex::SIZE; i += 2) {
+      const WallIndex wi(static_cast<uint16_t>(i));
+      if (wi.getPosition() == Position(0, 0)) continue;
+      if (wi.getPosition().x + wi.getPosition().y < MAZE_SIZE) continue;
+      maze.setWall(wi, false), maze.setKnown(wi, false);
+    }
+  }
+  /* 計測 */
+  uint64_t checksum = 0;
+  const int repeat = 16;
+  const double isWallNs = measure(count * repeat, [&](const int i) {
+    const auto& maze = mazes[i % count];
+    int n = 0;
+    for (int8_t x = 0; x < MAZE_SIZE; ++x)
+      for (int8_t y = 0; y < MAZE_SIZE; ++y)
+        for (const auto d : Direction::Along4())
+          n += maze.isWall(x, y, d) + maze.isKnown(x, y, d);
+    checksum += n;
+  });
+  const double countNs = measure(count * repeat, [&](const int i) {
+    const auto& maze = mazes[i % count];
+    int n = 0;
+    for (int8_t x = 0; x < MAZE_SIZE; ++x)
+      for (int8_t y = 0; y < MAZE_SIZE; ++y)
+        n += maze.wallCount(Position(x, y)) + maze.unknownCount(Position(x, y));
+    checksum += n;
+  });
+  StepMap stepMap;
+  double updateNs[2];
+  for (const bool knownOnly : {false, true}) {
+    updateNs[knownOnly] = measure(count, [&](const int i) {
+      const auto& maze = mazes[i];
+      stepMap.update(maze, maze.getGoals(), knownOnly, false);
+      checksum += stepMap.getStep(maze.getStart());
+    });
+  }
+  /* 結果の表示 */
+  const int queries = Position::SIZE * 4 * 2;
+  std::cout << "# storage: " << (MAZE_CELL_STORAGE ? "cell" : "edge")
+            << ", " << count << " mazes" << std::endl;
+  std::cout << "isWall+isKnown:     " << isWallNs / queries << " ns/query"
+            << std::endl;
+  std::cout << "wall/unknownCount:  " << countNs / Position::SIZE / 2
+            << " ns/call" << std::endl;
+  std::cout << "update(all):        " << updateNs[false] << " ns/call"
+            << std::endl;
+  std::cout << "update(knownOnly):  " << updateNs[true] << " ns/call"
+            << std::endl;
+  std::cout << "checksum: " << std::hex << checksum << std::endl;
+  return 0;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file main.cpp
+ * @brief 迷路データから回転や鏡映による重複を除くツール
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-17
+ * @details
+ * 指定ディレクトリの *.maze をすべて読み込んで正準形ごとにまとめ、
+ * 重複している迷路と正準形への変換を表示する。-o を指定すると、
+ * 正準形ごとに最初の迷路のファイルだけを出力先のディレクトリに複製する。
+ *
+ * 使い方: maze_dedup [-o outdir] [mazedata/data]
+ */
+#include <algorithm>  //< for std::sort
+#include <cstring>    //< for std::strcmp
+#include <filesystem>
+
+#include "MazeLib/MazeCorpus.h"
+
+using namespace MazeLib;
+
+int main(int argc, char* argv[]) {
+  /* 引数の解析 */
+  std::string dir = "../mazedata/data";
+  std::string outdir;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "-o") && i + 1 < argc)
+      outdir = argv[++i];
+    else if (argv[i][0] != '-')
+      dir = argv[i];
+    else {
+      std::cerr << "usage: " << argv[0] << " [-o outdir] [mazedata/data]"
+                << std::endl;
+      return -1;
+    }
+  }
+  /* 迷路ファイルの列挙 */
+  std::vector<std::filesystem::path> paths;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+    if (entry.path().extension() == ".maze") paths.push_back(entry.path());
+  if (ec || paths.empty()) {
+    std::cerr << "No maze files found in " << dir << std::endl;
+    return -1;
+  }
+  std::sort(paths.begin(), paths.end());
+  /* 正準形ごとにまとめる */
+  MazeCorpus corpus;
+  for (const auto& path : paths) {
+    Maze maze;
+    if (!maze.parse(path.string())) {
+      std::cerr << "failed to parse " << path << std::endl;
+      continue;
+    }
+    const auto mazeSize = CanonicalMaze::estimateMazeSize(maze);
+    corpus.add(path.filename().string(), maze, mazeSize);
+  }
+  /* 重複の表示。括弧内は正準形への変換 */
+  for (const auto& entry : corpus.getEntries()) {
+    if (entry.members.size() < 2) continue;
+    for (size_t i = 0; i < entry.members.size(); ++i)
+      std::cout << (i ? " " : "") << entry.members[i].name << "("
+                << entry.members[i].transform << ")";
+    std::cout << std::endl;
+  }
+  std::cout << "# " << corpus.getMemberCount() << " mazes, " << corpus.size()
+            << " unique" << std::endl;
+  /* 重複を除いた迷路の複製 */
+  if (outdir.empty()) return 0;
+  std::filesystem::create_directories(outdir, ec);
+  for (const auto& entry : corpus.getEntries()) {
+    const auto& name = entry.members.front().name;
+    std::filesystem::copy_file(
+        std::filesystem::path(dir) / name, std::filesystem::path(outdir) / name,
+        std::filesystem::copy_options::overwrite_existing, ec);
+    if (ec) {
+      std::cerr << "failed to copy " << name << ": " << ec.message()
+                << std::endl;
+      return -1;
+    }
+  }
+  return 0;
+}
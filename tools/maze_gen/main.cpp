@@ -0,0 +1,90 @@
+/**
+ * @file main.cpp
+ * @brief 乱数により迷路を生成するツール
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-18
+ * @details
+ * MazeGenerator で迷路を生成し、生成速度を表示する。
+ * -o を指定すると、迷路を *.maze 形式で出力先のディレクトリに書き出す。
+ * -o - では迷路を連結して標準出力に書き出し、生成速度は標準エラー出力に表示する。
+ * 同じ種と設定なら同じ迷路の列を生成するので、回帰試験の入力にも使える。
+ *
+ * 使い方: maze_gen [-n count] [-s seed] [-a dfs|kruskal] [-b braid]
+ *                  [-l loops] [-z size] [-g goal_size] [-o outdir]
+ */
+#include <chrono>
+#include <cstdio>   //< for std::snprintf
+#include <cstring>  //< for std::strcmp
+#include <filesystem>
+#include <fstream>
+
+#include "MazeLib/MazeGenerator.h"
+
+using namespace MazeLib;
+
+int main(int argc, char* argv[]) {
+  /* 引数の解析 */
+  int count = 10000;
+  uint64_t seed = 1;
+  MazeGenerator::Option option;
+  std::string outdir;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "-n") && i + 1 < argc)
+      count = std::max(1, std::atoi(argv[++i]));
+    else if (!std::strcmp(argv[i], "-s") && i + 1 < argc)
+      seed = std::strtoull(argv[++i], nullptr, 0);
+    else if (!std::strcmp(argv[i], "-a") && i + 1 < argc)
+      option.algorithm = std::strcmp(argv[++i], "kruskal")
+                             ? MazeGenerator::DepthFirst
+                             : MazeGenerator::Kruskal;
+    else if (!std::strcmp(argv[i], "-b") && i + 1 < argc)
+      option.braid = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "-l") && i + 1 < argc)
+      option.loops = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "-z") && i + 1 < argc)
+      option.mazeSize = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "-g") && i + 1 < argc)
+      option.goalSize = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "-o") && i + 1 < argc)
+      outdir = argv[++i];
+    else {
+      std::cerr << "usage: " << argv[0]
+                << " [-n count] [-s seed] [-a dfs|kruskal] [-b braid]"
+                   " [-l loops] [-z size] [-g goal_size] [-o outdir]"
+                << std::endl;
+      return -1;
+    }
+  }
+  const bool toStdout = outdir == "-";
+  if (!outdir.empty() && !toStdout)
+    std::filesystem::create_directories(outdir);
+  /* 生成 */
+  MazeGenerator generator(seed);
+  Maze maze;
+  uint64_t checksum = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; ++i) {
+    if (!generator.generate(maze, option)) {
+      std::cerr << "invalid option" << std::endl;
+      return -1;
+    }
+    checksum ^= maze.getHash() + i;
+    if (outdir.empty()) continue;
+    if (toStdout) {
+      maze.print(std::cout, option.mazeSize);
+      continue;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "gen_%06d.maze", i);
+    std::ofstream ofs(std::filesystem::path(outdir) / name);
+    maze.print(ofs, option.mazeSize);
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  const auto us =
+      std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+  auto& os = toStdout ? std::cerr : std::cout;
+  os << "# " << count << " mazes, " << us / 1000 << " ms, "
+     << static_cast<int64_t>(count * 1e6 / std::max<int64_t>(1, us))
+     << " mazes/s, checksum " << std::hex << checksum << std::endl;
+  return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file main.cpp
+ * @brief 壁の読み違いと位置ずれに対する探索走行の頑健性を評価するツール
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-14
+ * @details
+ * 指定ディレクトリの *.maze それぞれについて、雑音なしの探索走行を基準とし、
+ * 壁の読み違いと位置ずれを加えた探索走行をモンテカルロ法で繰り返す。
+ * 基準からの移動区画数と経路導出回数の増加 (復帰のコスト) と成功率を表示する。
+ * 試行ごとに (種, 迷路番号, 試行番号) から乱数列を決めるので、
+ * スレッド数や実行順によらず結果は再現する。
+ *
+ * 使い方: maze_noise [-j threads] [-n trials] [-m misread] [-p slip]
+ *                    [-s seed] [mazedata/data]
+ */
+#include <algorithm>  //< for std::sort
+#include <atomic>
+#include <cstdio>   //< for std::printf
+#include <cstring>  //< for std::strcmp
+#include <filesystem>
+#include <thread>
+
+#include "MazeLib/SearchSimulator.h"
+
+using namespace MazeLib;
+
+/**
+ * @brief 1回の試行の結果
+ */
+struct Trial {
+  bool success = false; /**< @brief 最短経路を導出して走行できたか */
+  int moves = 0;        /**< @brief 移動区画数 */
+  int recomputes = 0;   /**< @brief 経路導出の回数 */
+  int misreads = 0;     /**< @brief 壁を読み違えた回数 */
+  int collisions = 0;   /**< @brief 壁に当たった回数 */
+  int resets = 0;       /**< @brief 直近の壁情報を捨てた回数 */
+};
+
+/**
+ * @brief 試行ごとの乱数の種を決める
+ */
+static uint32_t makeSeed(const uint32_t seed, const int maze, const int trial) {
+  std::seed_seq seq{seed, static_cast<uint32_t>(maze),
+                    static_cast<uint32_t>(trial)};
+  uint32_t result;
+  seq.generate(&result, &result + 1);
+  return result;
+}
+
+int main(int argc, char* argv[]) {
+  /* 引数の解析 */
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  int trials = 100;
+  SearchSimulator::Noise noise;
+  noise.misread = 0.01f;
+  noise.slip = 0.01f;
+  uint32_t seed = 1;
+  std::string dir = "../mazedata/data";
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "-j") && i + 1 < argc)
+      threads = std::max(1, std::atoi(argv[++i]));
+    else if (!std::strcmp(argv[i], "-n") && i + 1 < argc)
+      trials = std::max(1, std::atoi(argv[++i]));
+    else if (!std::strcmp(argv[i], "-m") && i + 1 < argc)
+      noise.misread = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "-p") && i + 1 < argc)
+      noise.slip = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "-s") && i + 1 < argc)
+      seed = std::strtoul(argv[++i], nullptr, 0);
+    else if (argv[i][0] != '-')
+      dir = argv[i];
+    else {
+      std::cerr << "usage: " << argv[0]
+                << " [-j threads] [-n trials] [-m misread] [-p slip]"
+                   " [-s seed] [mazedata/data]"
+                << std::endl;
+      return -1;
+    }
+  }
+  /* 迷路の読み込み */
+  std::vector<std::filesystem::path> paths;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+    if (entry.path().extension() == ".maze") paths.push_back(entry.path());
+  std::sort(paths.begin(), paths.end());
+  std::vector<std::string> names;
+  std::vector<Maze> mazes;
+  for (const auto& path : paths) {
+    Maze maze;
+    if (!maze.parse(path.string())) continue;
+    names.push_back(path.filename().string());
+    mazes.push_back(maze);
+  }
+  if (ec || mazes.empty()) {
+    std::cerr << "No maze files found in " << dir << std::endl;
+    return -1;
+  }
+  /* 迷路ごとに 1 + trials 回の試行。試行 0 は雑音なしの基準 */
+  const int jobsPerMaze = 1 + trials;
+  const int jobs = mazes.size() * jobsPerMaze;
+  std::vector<Trial> results(jobs);
+  std::atomic<int> next{0};
+  std::vector<std::thread> workers;
+  threads = std::min(threads, jobs);
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&] {
+      SearchSimulator simulator;
+      for (int i; (i = next.fetch_add(1)) < jobs;) {
+        const int m = i / jobsPerMaze;
+        const int trial = i % jobsPerMaze;
+        auto trialNoise = noise;
+        if (trial == 0) trialNoise.misread = trialNoise.slip = 0;
+        trialNoise.seed = makeSeed(seed, m, trial);
+        simulator.setNoise(trialNoise);
+        const auto result = simulator.run(mazes[m]);
+        results[i] = {result.success, result.moves, result.recomputes,
+                      result.misreads, result.collisions, result.resets};
+      }
+    });
+  }
+  for (auto& worker : workers) worker.join();
+  /* 集計と表示 */
+  std::printf(
+      "| %-24s | %5s | %5s | %8s | %11s | %8s | %10s | %6s | %7s |\n",
+      "maze", "moves", "recmp", "success", "extra_moves", "extra_rc",
+      "collisions", "resets", "misread");
+  double totalExtraMoves = 0, totalExtraRecomputes = 0;
+  int totalSuccesses = 0, totalRuns = 0;
+  for (size_t m = 0; m < mazes.size(); ++m) {
+    const auto* r = &results[m * jobsPerMaze];
+    const auto& base = r[0];
+    int successes = 0, collisions = 0, resets = 0, misreads = 0;
+    double extraMoves = 0, extraRecomputes = 0;
+    for (int t = 1; t < jobsPerMaze; ++t) {
+      collisions += r[t].collisions;
+      resets += r[t].resets;
+      misreads += r[t].misreads;
+      if (!r[t].success) continue;
+      ++successes;
+      extraMoves += r[t].moves - base.moves;
+      extraRecomputes += r[t].recomputes - base.recomputes;
+    }
+    totalSuccesses += successes, totalRuns += trials;
+    totalExtraMoves += extraMoves, totalExtraRecomputes += extraRecomputes;
+    const int n = std::max(1, successes);
+    std::printf(
+        "| %-24s | %5d | %5d | %3d/%-4d | %11.1f | %8.1f | %10.2f | %6.2f | "
+        "%7.2f |%s\n",
+        names[m].c_str(), base.moves, base.recomputes, successes, trials,
+        extraMoves / n, extraRecomputes / n,
+        static_cast<double>(collisions) / trials,
+        static_cast<double>(resets) / trials,
+        static_cast<double>(misreads) / trials,
+        base.success ? "" : " (baseline failed)");
+  }
+  const int n = std::max(1, totalSuccesses);
+  std::printf("# %zu mazes, %d trials, misread %.4f, slip %.4f, seed %u\n",
+              mazes.size(), trials, static_cast<double>(noise.misread),
+              static_cast<double>(noise.slip), seed);
+  std::printf("# success %d/%d, extra moves %.1f, extra recomputes %.1f\n",
+              totalSuccesses, totalRuns, totalExtraMoves / n,
+              totalExtraRecomputes / n);
+  return 0;
+}
@@ -0,0 +1,225 @@
+/**
+ * @file main.cpp
+ * @brief 迷路データ全体に対する探索と最短経路の回帰試験ツール
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-12
+ * @details
+ * 指定ディレクトリの *.maze をすべて読み込み、固定数のワーカースレッドで
+ * 探索走行の模擬と最短経路の導出を行う。迷路ごとに最短経路の区画数、
+ * 推定時間、探索走行の移動区画数、ステップマップのチェックサムを記録し、
+ * ゴールデンファイルと比較する。
+ * ディレクトリに - を指定すると、標準入力から連結された迷路を順に読み込み、
+ * 読み込んだ順に stdin_000000 のような名前を付ける。
+ *
+ * 使い方: maze_regress [-j threads] [-g golden.txt] [-u] [mazedata/data | -]
+ * - -j: ワーカースレッド数 (省略時はハードウェアのスレッド数)
+ * - -g: 比較するゴールデンファイル
+ * - -u: 比較せずにゴールデンファイルを更新する
+ *
+ * ゴールデンファイルがなければ、比較せずに失敗する (先に -u で作ること)。
+ */
+#include <algorithm>  //< for std::sort
+#include <atomic>
+#include <chrono>
+#include <cstdio>   //< for std::snprintf
+#include <cstring>  //< for std::strcmp
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include "MazeLib/SearchSimulator.h"
+
+using namespace MazeLib;
+
+/**
+ * @brief 迷路ごとの評価結果
+ */
+struct Record {
+  std::string name;      /**< @brief 迷路ファイル名 */
+  bool parsed = false;   /**< @brief 迷路の読み込みに成功したか */
+  bool success = false;  /**< @brief 探索と最短経路の導出に成功したか */
+  bool optimal = false;  /**< @brief 探索後の最短経路が正解の最短経路と同じか */
+  int length = 0;        /**< @brief 最短経路の区画数 */
+  int time = 0;          /**< @brief 最短経路の推定時間 [ms] */
+  int moves = 0;         /**< @brief 探索走行の移動区画数 */
+  uint32_t checksum = 0; /**< @brief 正解の迷路のステップマップのチェックサム */
+
+  /**
+   * @brief ゴールデンファイルの1行の形式に変換する
+   */
+  std::string toString() const {
+    if (!parsed) return name + " parse_error";
+    std::ostringstream os;
+    os << name << (success ? "" : " search_error")
+       << (optimal ? "" : " not_optimal") << " length=" << length
+       << " time=" << time << " moves=" << moves << " checksum=" << std::hex
+       << checksum;
+    return os.str();
+  }
+};
+
+/**
+ * @brief ステップマップの FNV-1a チェックサム
+ */
+static uint32_t calcChecksum(const StepMap& stepMap) {
+  uint32_t hash = 2166136261u;
+  for (const auto step : stepMap.getMapArray())
+    for (const auto byte : {step & 0xff, step >> 8})
+      hash = (hash ^ static_cast<uint32_t>(byte)) * 16777619u;
+  return hash;
+}
+
+/**
+ * @brief 1つの迷路を評価する
+ * @details スレッドごとにシミュレータとステップマップを用意して呼ぶ
+ */
+static void evaluate(const Maze& mazeTarget, Record& record,
+                     SearchSimulator& simulator, StepMap& stepMap) {
+  /* 正解の迷路の最短経路 */
+  stepMap.update(mazeTarget, mazeTarget.getGoals(), true, false);
+  record.checksum = calcChecksum(stepMap);
+  const auto expected = stepMap.calcShortestDirections(mazeTarget, true, false);
+  const auto expectedCost = stepMap.calcDirectionsCost(expected, false);
+  /* 探索走行の模擬 */
+  const auto result = simulator.run(mazeTarget);
+  record.success = result.success;
+  record.optimal = result.success && result.shortestCost == expectedCost;
+  record.length = result.shortestDirections.size();
+  record.time = result.shortestCost * stepMap.getScalingFactor();
+  record.moves = result.moves;
+}
+
+/**
+ * @brief 標準入力から連結された迷路をすべて読み込む
+ * @details 途中の壊れた迷路は parse_error として記録し、続きを読む
+ */
+static void loadStream(std::istream& is, std::vector<Record>& records,
+                       std::vector<Maze>& mazes) {
+  while (is) {
+    Maze maze;
+    const bool parsed = maze.parse(is);
+    if (!parsed && is.eof()) break;
+    char name[32];
+    std::snprintf(name, sizeof(name), "stdin_%06zu", records.size());
+    records.emplace_back().name = name;
+    records.back().parsed = parsed;
+    mazes.push_back(parsed ? maze : Maze());
+  }
+}
+
+/**
+ * @brief ゴールデンファイルを読み込む
+ * @return 迷路ファイル名から行への写像
+ */
+static std::map<std::string, std::string> loadGolden(const std::string& path) {
+  std::map<std::string, std::string> golden;
+  std::ifstream ifs(path);
+  for (std::string line; std::getline(ifs, line);)
+    if (!line.empty() && line[0] != '#')
+      golden[line.substr(0, line.find(' '))] = line;
+  return golden;
+}
+
+int main(int argc, char* argv[]) {
+  /* 引数の解析 */
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  std::string goldenPath;
+  std::string dir = "../mazedata/data";
+  bool update = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "-j") && i + 1 < argc)
+      threads = std::max(1, std::atoi(argv[++i]));
+    else if (!std::strcmp(argv[i], "-g") && i + 1 < argc)
+      goldenPath = argv[++i];
+    else if (!std::strcmp(argv[i], "-u"))
+      update = true;
+    else if (argv[i][0] != '-' || !std::strcmp(argv[i], "-"))
+      dir = argv[i];
+    else {
+      std::cerr << "usage: " << argv[0]
+                << " [-j threads] [-g golden.txt] [-u] [mazedata/data | -]"
+                << std::endl;
+      return -1;
+    }
+  }
+  /* 迷路ファイルの列挙、または標準入力からの読み込み */
+  const auto t0 = std::chrono::steady_clock::now();
+  std::vector<std::filesystem::path> paths;
+  std::vector<Record> records;
+  std::vector<Maze> mazes;
+  if (dir == "-") {
+    loadStream(std::cin, records, mazes);
+  } else {
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+      if (entry.path().extension() == ".maze") paths.push_back(entry.path());
+    std::sort(paths.begin(), paths.end());
+    records.resize(paths.size());
+  }
+  if (records.empty()) {
+    std::cerr << "No maze files found in " << dir << std::endl;
+    return -1;
+  }
+  /* 固定数のワーカースレッドで評価。結果は迷路ごとの領域に書き込む */
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> workers;
+  threads = std::min<int>(threads, records.size());
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&] {
+      SearchSimulator simulator;
+      StepMap stepMap;
+      for (size_t i; (i = next.fetch_add(1)) < records.size();) {
+        auto& record = records[i];
+        Maze maze;
+        if (!paths.empty()) {
+          record.name = paths[i].filename().string();
+          record.parsed = maze.parse(paths[i].string());
+        }
+        if (record.parsed)
+          evaluate(paths.empty() ? mazes[i] : maze, record, simulator, stepMap);
+      }
+    });
+  }
+  for (auto& worker : workers) worker.join();
+  const auto t1 = std::chrono::steady_clock::now();
+  /* 結果の出力 */
+  std::ostringstream output;
+  for (const auto& record : records) output << record.toString() << '\n';
+  std::cout << output.str();
+  std::cout << "# " << records.size() << " mazes, " << threads << " threads, "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0)
+                   .count()
+            << " ms" << std::endl;
+  if (goldenPath.empty()) return 0;
+  /* ゴールデンファイルの更新 */
+  if (update) {
+    std::ofstream ofs(goldenPath);
+    ofs << "# maze_regress golden file\n" << output.str();
+    return ofs ? 0 : -1;
+  }
+  /* ゴールデンファイルとの比較 */
+  if (!std::filesystem::exists(goldenPath)) {
+    std::cerr << "Golden file not found: " << goldenPath
+              << " (run with -u first to create it)" << std::endl;
+    return -1;
+  }
+  auto golden = loadGolden(goldenPath);
+  int diffs = 0;
+  for (const auto& record : records) {
+    const auto line = record.toString();
+    const auto it = golden.find(record.name);
+    if (it == golden.end()) {
+      std::cout << "+ " << line << std::endl, ++diffs;
+      continue;
+    }
+    if (it->second != line)
+      std::cout << "- " << it->second << "\n+ " << line << std::endl, ++diffs;
+    golden.erase(it);
+  }
+  for (const auto& [name, line] : golden)
+    std::cout << "- " << line << std::endl, ++diffs;
+  std::cout << "# " << diffs << " differences" << std::endl;
+  return diffs ? 1 : 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file WorkStealingScheduler.h
+ * @brief ワークスティーリングによるタスクの並列実行器を定義
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-13
+ * @copyright Copyright 2023 Ryotaro Onuki <kerikun11+github@gmail.com>
+ */
+#pragma once
+
+#include <algorithm>  //< for std::max
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief ワークスティーリングによるタスクの並列実行器
+ * @details
+ * ワーカーごとに両端キューをもち、自分のキューからは後ろ (LIFO) から、
+ * 他のワーカーのキューからは前 (FIFO) から取り出して実行する。
+ * タスクの中から新たなタスクを追加できるので、依存関係のあるタスクを
+ * 親から子へ展開するタスクグラフとして扱える。
+ */
+class WorkStealingScheduler {
+ public:
+  /** @brief タスクの型。引数は実行するワーカーの番号 */
+  using Task = std::function<void(int worker)>;
+
+ public:
+  /**
+   * @brief コンストラクタ
+   * @param[in] threads ワーカースレッド数
+   */
+  explicit WorkStealingScheduler(const int threads)
+      : queues(std::max(1, threads)) {}
+  /**
+   * @brief ワーカースレッド数を取得する
+   */
+  int getThreads() const { return queues.size(); }
+  /**
+   * @brief タスクを追加する
+   * @details 実行中のタスクから呼ぶ場合は自身のワーカー番号を指定する
+   * @param[in] worker 追加先のワーカーの番号
+   * @param[in] task 追加するタスク
+   */
+  void push(const int worker, Task task) {
+    pending.fetch_add(1);
+    auto& queue = queues[worker % queues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  /**
+   * @brief すべてのタスクが完了するまで実行する
+   */
+  void run() {
+    std::vector<std::thread> workers;
+    for (int i = 0; i < getThreads(); ++i)
+      workers.emplace_back([this, i] { work(i); });
+    for (auto& worker : workers) worker.join();
+  }
+
+ protected:
+  /**
+   * @brief ワーカーごとのタスクキュー
+   */
+  struct Queue {
+    std::mutex mutex;       /**< @brief キューの排他制御 */
+    std::deque<Task> tasks; /**< @brief タスクの両端キュー */
+  };
+  std::vector<Queue> queues;   /**< @brief ワーカーごとのタスクキュー */
+  std::atomic<int> pending{0}; /**< @brief 未完了のタスク数 */
+
+  /**
+   * @brief ワーカースレッドの処理
+   * @details 未完了のタスクがなくなるまで取り出して実行する。
+   * 子タスクは親タスクの完了前に追加されるので、途中で 0 にはならない。
+   */
+  void work(const int worker) {
+    while (pending.load() > 0) {
+      Task task;
+      if (!pop(worker, task) && !steal(worker, task)) {
+        std::this_thread::yield();
+        continue;
+      }
+      task(worker);
+      pending.fetch_sub(1);
+    }
+  }
+  /**
+   * @brief 自分のキューの後ろからタスクを取り出す
+   */
+  bool pop(const int worker, Task& task) {
+    auto& queue = queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+  }
+  /**
+   * @brief 他のワーカーのキューの前からタスクを盗む
+   */
+  bool steal(const int worker, Task& task) {
+    const int n = queues.size();
+    for (int i = 1; i < n; ++i) {
+      auto& queue = queues[(worker + i) % n];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (queue.tasks.empty()) continue;
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      return true;
+    }
+    return false;
+  }
+};
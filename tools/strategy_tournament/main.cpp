@@ -0,0 +1,171 @@
+/**
+ * @file main.cpp
+ * @brief 探索走行の方針どうしを多数の迷路で比較するツール
+ * @author Ryotaro Onuki <kerikun11+github@gmail.com>
+ * @date 2023-07-13
+ * @details
+ * 進行方向の候補の並べ替え、台形加速の考慮の有無、帰還時の既知壁のみの
+ * 使用の有無を組み合わせた方針について、指定ディレクトリの *.maze すべてで
+ * 探索走行を模擬し、方針ごとの統計を表示する。
+ * 迷路の読み込みを親タスク、方針ごとの探索走行の模擬を子タスクとして、
+ * ワークスティーリングで並列に実行する。統計は方針ごとのアトミック変数に
+ * ロックなしで集計する。
+ *
+ * 使い方: strategy_tournament [-j threads] [mazedata/data]
+ */
+#include <algorithm>  //< for std::sort
+#include <chrono>
+#include <cstdio>   //< for std::printf
+#include <cstring>  //< for std::strcmp
+#include <filesystem>
+#include <memory>  //< for std::shared_ptr
+
+#include "MazeLib/SearchSimulator.h"
+#include "WorkStealingScheduler.h"
+
+using namespace MazeLib;
+
+/**
+ * @brief 方針ごとの統計
+ * @details 複数のワーカーからロックなしで加算される
+ */
+struct Stats {
+  std::atomic<int> runs{0};            /**< @brief 模擬した迷路の数 */
+  std::atomic<int> successes{0};       /**< @brief 成功した迷路の数 */
+  std::atomic<int> optimal{0};         /**< @brief 最短経路を得た迷路の数 */
+  std::atomic<int64_t> moves{0};       /**< @brief 成功時の移動区画数の和 */
+  std::atomic<int64_t> recomputes{0};  /**< @brief 成功時の経路導出回数の和 */
+  std::atomic<int64_t> excessCost{0};  /**< @brief 成功時の最短との差の和 */
+};
+
+/**
+ * @brief 対戦する方針
+ */
+struct Entry {
+  std::string name;                   /**< @brief 表示名 */
+  SearchSimulator::Strategy strategy; /**< @brief 方針 */
+  Stats stats;                        /**< @brief 統計 */
+};
+
+/**
+ * @brief すべての方針の組み合わせを列挙する
+ */
+static std::vector<std::unique_ptr<Entry>> makeEntries() {
+  std::vector<std::unique_ptr<Entry>> entries;
+  const std::pair<StepMap::CandidateOrder, const char*> orders[] = {
+      {StepMap::CostOnly, "cost"},
+      {StepMap::UnknownFirst, "unknown"},
+      {StepMap::StraightFirst, "straight"},
+  };
+  for (const auto& [order, orderName] : orders)
+    for (const bool simple : {true, false})
+      for (const bool knownOnly : {true, false}) {
+        auto entry = std::make_unique<Entry>();
+        entry->name = std::string(orderName) +
+                      (simple ? "/simple" : "/weighted") +
+                      (knownOnly ? "/known" : "/unknown");
+        entry->strategy.candidateOrder = order;
+        entry->strategy.simple = simple;
+        entry->strategy.knownOnly = knownOnly;
+        entries.push_back(std::move(entry));
+      }
+  return entries;
+}
+
+int main(int argc, char* argv[]) {
+  /* 引数の解析 */
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  std::string dir = "../mazedata/data";
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "-j") && i + 1 < argc)
+      threads = std::max(1, std::atoi(argv[++i]));
+    else if (argv[i][0] != '-')
+      dir = argv[i];
+    else {
+      std::cerr << "usage: " << argv[0] << " [-j threads] [mazedata/data]"
+                << std::endl;
+      return -1;
+    }
+  }
+  /* 迷路ファイルの列挙 */
+  std::vector<std::filesystem::path> paths;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+    if (entry.path().extension() == ".maze") paths.push_back(entry.path());
+  if (ec || paths.empty()) {
+    std::cerr << "No maze files found in " << dir << std::endl;
+    return -1;
+  }
+  std::sort(paths.begin(), paths.end());
+  /* タスクグラフの構築: 迷路の読み込み -> 方針ごとの模擬 */
+  const auto entries = makeEntries();
+  WorkStealingScheduler scheduler(threads);
+  std::vector<SearchSimulator> simulators(scheduler.getThreads());
+  std::atomic<int> parseErrors{0};
+  for (size_t i = 0; i < paths.size(); ++i) {
+    scheduler.push(i, [&, path = paths[i]](const int worker) {
+      auto mazeTarget = std::make_shared<Maze>();
+      if (!mazeTarget->parse(path.string())) {
+        parseErrors.fetch_add(1);
+        return;
+      }
+      /* 正解の最短経路のコスト */
+      StepMap stepMap;
+      const auto expected =
+          stepMap.calcShortestDirections(*mazeTarget, true, false);
+      const auto expectedCost = stepMap.calcDirectionsCost(expected, false);
+      for (const auto& entry : entries) {
+        scheduler.push(worker, [&, mazeTarget, expectedCost,
+                                e = entry.get()](const int childWorker) {
+          auto& simulator = simulators[childWorker];
+          simulator.setStrategy(e->strategy);
+          const auto result = simulator.run(*mazeTarget);
+          e->stats.runs.fetch_add(1, std::memory_order_relaxed);
+          if (!result.success) return;
+          e->stats.successes.fetch_add(1, std::memory_order_relaxed);
+          if (result.shortestCost == expectedCost)
+            e->stats.optimal.fetch_add(1, std::memory_order_relaxed);
+          e->stats.moves.fetch_add(result.moves, std::memory_order_relaxed);
+          e->stats.recomputes.fetch_add(result.recomputes,
+                                        std::memory_order_relaxed);
+          e->stats.excessCost.fetch_add(result.shortestCost - expectedCost,
+                                        std::memory_order_relaxed);
+        });
+      }
+    });
+  }
+  const auto t0 = std::chrono::steady_clock::now();
+  scheduler.run();
+  const auto t1 = std::chrono::steady_clock::now();
+  /* 平均移動区画数の少ない順に表示 */
+  std::vector<const Entry*> ranking;
+  for (const auto& entry : entries) ranking.push_back(entry.get());
+  const auto mean = [](const std::atomic<int64_t>& sum, const Stats& s) {
+    return s.successes ? static_cast<double>(sum) / s.successes : 0.0;
+  };
+  std::stable_sort(ranking.begin(), ranking.end(),
+                   [&](const Entry* e1, const Entry* e2) {
+                     if (e1->stats.successes != e2->stats.successes)
+                       return e1->stats.successes > e2->stats.successes;
+                     return mean(e1->stats.moves, e1->stats) <
+                            mean(e2->stats.moves, e2->stats);
+                   });
+  std::printf("| %-26s | %7s | %7s | %8s | %10s | %8s |\n", "strategy",
+              "success", "optimal", "moves", "recomputes", "excess");
+  for (const auto* e : ranking) {
+    const auto& s = e->stats;
+    std::printf("| %-26s | %3d/%-3d | %7d | %8.1f | %10.1f | %8.1f |\n",
+                e->name.c_str(), s.successes.load(), s.runs.load(),
+                s.optimal.load(), mean(s.moves, s), mean(s.recomputes, s),
+                mean(s.excessCost, s));
+  }
+  std::printf("# %zu mazes (%d parse errors), %zu strategies, %d threads, "
+              "%d ms\n",
+              paths.size(), parseErrors.load(), entries.size(),
+              scheduler.getThreads(),
+              static_cast<int>(
+                  std::chrono::duration_cast<std::chrono::milliseconds>(t1 -
+                                                                        t0)
+                      .count()));
+  return 0;
+}